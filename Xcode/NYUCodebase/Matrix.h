@@ -1,19 +1,92 @@
 
 #pragma once
 
+#include <stddef.h>
+
 class Matrix {
     public:
     
-        Matrix();
+        constexpr Matrix()
+        : m{{1.0f, 0.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 0.0f, 1.0f}} {}
+    
+        // Column by column, the same order as ml
+        constexpr Matrix(float m00, float m01, float m02, float m03,
+                         float m10, float m11, float m12, float m13,
+                         float m20, float m21, float m22, float m23,
+                         float m30, float m31, float m32, float m33)
+        : m{{m00, m01, m02, m03}, {m10, m11, m12, m13}, {m20, m21, m22, m23}, {m30, m31, m32, m33}} {}
     
         union {
             float m[4][4];
             float ml[16];
         };
     
+        // Whole matrices built at compile time, for cameras and projections that never change
+        static constexpr Matrix translation(float x, float y, float z) {
+            return Matrix(1.0f, 0.0f, 0.0f, 0.0f,
+                          0.0f, 1.0f, 0.0f, 0.0f,
+                          0.0f, 0.0f, 1.0f, 0.0f,
+                          x, y, z, 1.0f);
+        }
+        static constexpr Matrix scaling(float x, float y, float z) {
+            return Matrix(x, 0.0f, 0.0f, 0.0f,
+                          0.0f, y, 0.0f, 0.0f,
+                          0.0f, 0.0f, z, 0.0f,
+                          0.0f, 0.0f, 0.0f, 1.0f);
+        }
+        static constexpr Matrix orthoProjection(float left, float right, float bottom, float top, float zNear, float zFar) {
+            return Matrix(orthoScale(left, right), 0.0f, 0.0f, 0.0f,
+                          0.0f, orthoScale(bottom, top), 0.0f, 0.0f,
+                          0.0f, 0.0f, -orthoScale(zNear, zFar), 0.0f,
+                          orthoOffset(left, right), orthoOffset(bottom, top), orthoOffset(zNear, zFar), 1.0f);
+        }
+        static constexpr Matrix perspectiveProjection(float fov, float aspect, float zNear, float zFar) {
+            return Matrix(1.0f / tangent(fov / 2.0f) / aspect, 0.0f, 0.0f, 0.0f,
+                          0.0f, 1.0f / tangent(fov / 2.0f), 0.0f, 0.0f,
+                          0.0f, 0.0f, (zFar + zNear) / (zNear - zFar), -1.0f,
+                          0.0f, 0.0f, (2.0f * zFar * zNear) / (zNear - zFar), 0.0f);
+        }
+    
+        // The pieces of an orthographic projection, setOrthoProjection uses these too so both always agree
+        static constexpr float orthoScale(float low, float high) {
+            return 2.0f / (high - low);
+        }
+        static constexpr float orthoOffset(float low, float high) {
+            return -((high + low) / (high - low));
+        }
+    
+        // tanf isn't constexpr, so a Taylor series instead, good to float precision for angles under about pi/2
+        static constexpr float tangent(float angle) {
+            return (float)(sineSeries((double)angle * angle, angle, 1) / cosineSeries((double)angle * angle, 1.0, 1));
+        }
+    
+        // What kind of transform this is, inverse() uses it to skip the full 4x4 inverse when it can
+        enum Structure {
+            TRANSLATION,        // identity plus a translation
+            SCALE_TRANSLATION,  // scale on the diagonal plus a translation
+            RIGID,              // rotation plus a translation
+            AFFINE,             // any 3x3 plus a translation (rotate and scale mixed together)
+            GENERAL             // projections and anything else
+        };
+    
+        // inverse() calls by the kind of shortcut they took, GENERAL being the full inverse. Only counted when
+        // Matrix.cpp is built with MATRIX_COUNT_INVERSES, for benches that need to see which path ran
+        static int inverseCounts[GENERAL + 1];
+    
         void identity();
         Matrix operator * (const Matrix &m2) const;
         Matrix inverse() const;
+        // Always does the full inverse, for matrices where the structure check isn't worth it
+        Matrix generalInverse() const;
+        Structure structure() const;
+    
+        // out = matrix * in, in and out are (x, y, z, w) and can be the same array
+        void transform(const float *in, float *out) const;
+    
+        // Transform count (x, y) points as if z = 0 and w = 1, in and out can be the same array
+        void transformPoints(const float *in, float *out, size_t count) const;
+        // Same but the points are inStride / outStride floats apart, for interleaved vertex data
+        void transformPoints(const float *in, size_t inStride, float *out, size_t outStride, size_t count) const;
     
         void Translate(float x, float y, float z);
         void Scale(float x, float y, float z);
@@ -28,7 +101,15 @@ class Matrix {
         void setRoll(float roll);
         void setPitch(float pitch);
         void setYaw(float yaw);
-
+    
         void setOrthoProjection(float left, float right, float bottom, float top, float zNear, float zFar);
         void setPerspectiveProjection(float fov, float aspect, float zNear, float zFar);
+    
+    private:
+        static constexpr double sineSeries(double angleSquared, double term, int n) {
+            return n > 12 ? term : term + sineSeries(angleSquared, -term * angleSquared / ((2 * n) * (2 * n + 1)), n + 1);
+        }
+        static constexpr double cosineSeries(double angleSquared, double term, int n) {
+            return n > 12 ? term : term + cosineSeries(angleSquared, -term * angleSquared / ((2 * n - 1) * (2 * n)), n + 1);
+        }
 };
\ No newline at end of file
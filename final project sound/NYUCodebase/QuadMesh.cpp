@@ -0,0 +1,194 @@
+#include "QuadMesh.h"
+#include <math.h>
+#include <algorithm>
+
+// 16 bit indices only reach 65536 vertices, bigger meshes get drawn in pieces this size
+#define MAX_QUADS_PER_DRAW 16384
+
+std::vector<GLushort> QuadMesh::indices;
+GLuint QuadMesh::indexBuffer = 0;
+int QuadMesh::indexBufferUsers = 0;
+
+static GLushort packUV(float t) {
+    t = std::min(std::max(t, 0.0f), 1.0f);
+    return (GLushort)(t * 65535.0f + 0.5f);
+}
+
+static GLshort packPosition(float p) {
+    p = std::min(std::max(floorf(p + 0.5f), -32768.0f), 32767.0f);
+    return (GLshort)p;
+}
+
+QuadMesh::QuadMesh(QuadFormat format) : vertexFormat(format), quads(0), buffer(0), uploaded(false) {}
+
+void QuadMesh::reset() {
+    vertices.clear();
+    quads = 0;
+    uploaded = false;
+}
+
+void QuadMesh::addQuad(const float *positions, const float *texCoords) {
+    int size = vertexSize(vertexFormat);
+    vertices.resize(vertices.size() + size * 4);
+    unsigned char *out = &vertices[vertices.size() - size * 4];
+    for (int i = 0; i < 4; i++) {
+        float x = positions[i * 2], y = positions[i * 2 + 1];
+        float u = texCoords[i * 2], v = texCoords[i * 2 + 1];
+        if (vertexFormat == QUAD_FLOAT) {
+            FloatVertex *vertex = (FloatVertex *)out + i;
+            vertex->x = x;
+            vertex->y = y;
+            vertex->u = u;
+            vertex->v = v;
+        } else if (vertexFormat == QUAD_PACKED_UV) {
+            PackedUVVertex *vertex = (PackedUVVertex *)out + i;
+            vertex->x = x;
+            vertex->y = y;
+            vertex->u = packUV(u);
+            vertex->v = packUV(v);
+        } else {
+            PackedVertex *vertex = (PackedVertex *)out + i;
+            vertex->x = packPosition(x);
+            vertex->y = packPosition(y);
+            vertex->u = packUV(u);
+            vertex->v = packUV(v);
+        }
+    }
+    quads++;
+}
+
+void QuadMesh::addRect(float left, float top, float right, float bottom, float u, float v, float uvWidth, float uvHeight) {
+    float positions[8] = {
+        left, bottom,
+        right, bottom,
+        right, top,
+        left, top
+    };
+    float texCoords[8] = {
+        u, v+uvHeight,
+        u+uvWidth, v+uvHeight,
+        u+uvWidth, v,
+        u, v
+    };
+    addQuad(positions, texCoords);
+}
+
+void QuadMesh::upload() {
+    if (buffer == 0) {
+        glGenBuffers(1, &buffer);
+        indexBufferUsers++;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size(), vertices.data(), GL_STATIC_DRAW);
+    // everything else draws from client side arrays
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    uploaded = true;
+    // the buffer has them now, no need to keep a second copy around
+    std::vector<unsigned char>().swap(vertices);
+}
+
+void QuadMesh::pointAttributes(ShaderProgram *program, const char *base) {
+    GLsizei stride = vertexSize(vertexFormat);
+    if (vertexFormat == QUAD_FLOAT) {
+        glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, stride, base);
+        glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, stride, base + 2 * sizeof(GLfloat));
+    } else if (vertexFormat == QUAD_PACKED_UV) {
+        glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, stride, base);
+        glVertexAttribPointer(program->texCoordAttribute, 2, GL_UNSIGNED_SHORT, true, stride, base + 2 * sizeof(GLfloat));
+    } else {
+        glVertexAttribPointer(program->positionAttribute, 2, GL_SHORT, false, stride, base);
+        glVertexAttribPointer(program->texCoordAttribute, 2, GL_UNSIGNED_SHORT, true, stride, base + 2 * sizeof(GLshort));
+    }
+}
+
+void QuadMesh::draw(ShaderProgram *program, int firstQuad, int count) {
+    count = std::min(count, quads - firstQuad);
+    if (count <= 0) {
+        return;
+    }
+    // 0 1 2, 0 2 3 for every quad, it's the same for every mesh so there's only ever one
+    if (indices.empty()) {
+        indices.resize(MAX_QUADS_PER_DRAW * 6);
+        for (int i = 0; i < MAX_QUADS_PER_DRAW; i++) {
+            GLushort corner = (GLushort)(i * 4);
+            GLushort quad[6] = {corner, (GLushort)(corner + 1), (GLushort)(corner + 2), corner, (GLushort)(corner + 2), (GLushort)(corner + 3)};
+            std::copy(quad, quad + 6, &indices[i * 6]);
+        }
+    }
+    
+    program->use();
+    const char *base = (const char *)vertices.data();
+    const GLvoid *indexData = indices.data();
+    if (uploaded) {
+        if (indexBuffer == 0) {
+            glGenBuffers(1, &indexBuffer);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLushort), indices.data(), GL_STATIC_DRAW);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+        base = NULL;
+        indexData = NULL;
+    }
+    glEnableVertexAttribArray(program->positionAttribute);
+    glEnableVertexAttribArray(program->texCoordAttribute);
+    
+    int stride = vertexSize(vertexFormat);
+    while (count > 0) {
+        int batch = std::min(count, MAX_QUADS_PER_DRAW);
+        // each piece starts back at index 0, so the attributes move to where it starts instead
+        pointAttributes(program, base + firstQuad * 4 * stride);
+        glDrawElements(GL_TRIANGLES, batch * 6, GL_UNSIGNED_SHORT, indexData);
+        firstQuad += batch;
+        count -= batch;
+    }
+    
+    glDisableVertexAttribArray(program->positionAttribute);
+    glDisableVertexAttribArray(program->texCoordAttribute);
+    if (uploaded) {
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+}
+
+void QuadMesh::draw(ShaderProgram *program) {
+    draw(program, 0, quads);
+}
+
+void QuadMesh::clear() {
+    if (buffer) {
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+        uploaded = false;
+        // the last mesh with a buffer takes the shared indices with it
+        if (--indexBufferUsers == 0 && indexBuffer) {
+            glDeleteBuffers(1, &indexBuffer);
+            indexBuffer = 0;
+        }
+    }
+}
+
+int QuadMesh::quadCount() const {
+    return quads;
+}
+
+QuadFormat QuadMesh::format() const {
+    return vertexFormat;
+}
+
+int QuadMesh::vertexBytes() const {
+    return quads * 4 * vertexSize(vertexFormat);
+}
+
+int QuadMesh::vertexSize(QuadFormat format) {
+    if (format == QUAD_FLOAT) {
+        return sizeof(FloatVertex);
+    } else if (format == QUAD_PACKED_UV) {
+        return sizeof(PackedUVVertex);
+    }
+    return sizeof(PackedVertex);
+}
+
+int QuadMesh::bytesPerQuad(QuadFormat format) {
+    return 4 * vertexSize(format) + 6 * sizeof(GLushort);
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#ifdef _WINDOWS
+	#include <GL/glew.h>
+#endif
+#include <SDL_opengl.h>
+#include <string>
+#include <vector>
+#include <map>
+#include "Matrix.h"
+#include "ShaderProgram.h"
+#include "QuadMesh.h"
+
+// The quads for one string laid out at the origin, 4 corners per letter in QuadMesh's order
+struct GlyphRun {
+    std::vector<float> vertices;
+    std::vector<float> texCoords;
+};
+
+// Keeps laid out strings around between frames and draws every string queued in a frame with one call
+class TextRenderer {
+    public:
+        TextRenderer();
+    
+        // Where the 16x16 grid of letters sits inside the font texture, the whole texture by default.
+        // Safe mid frame, strings already queued are drawn with the new region too
+        void setFontRegion(float u, float v, float width, float height);
+    
+        // The glyphs for this string, only built the first time it's asked for (no GL needed)
+        const GlyphRun &layout(const std::string &text, float size, float spacing);
+    
+        // Queue a string for this frame with its first letter centered on x, y
+        void draw(const std::string &text, float size, float spacing, float x, float y);
+    
+        // Draw everything queued since the last flush
+        void flush(ShaderProgram *program, GLuint fontTexture);
+    
+        int cachedRuns() const;
+    
+        // How many runs had to be laid out from scratch
+        int rebuilds;
+        // What the last flush sent to GL
+        int bytesUploaded;
+    
+    private:
+        // The letters' corners in the font texture, appended after whatever run already has
+        void addTexCoords(const std::string &text, GlyphRun &run) const;
+    
+        struct RunKey {
+            std::string text;
+            float size;
+            float spacing;
+            bool operator < (const RunKey &other) const;
+        };
+    
+        struct CachedRun {
+            GlyphRun run;
+            int lastUsedFrame;
+        };
+    
+        struct QueuedText {
+            const GlyphRun *run;
+            float x;
+            float y;
+        };
+    
+        float fontU;
+        float fontV;
+        float fontWidth;
+        float fontHeight;
+    
+        int frame;
+        std::map<RunKey, CachedRun> runs;
+        std::vector<QueuedText> queued;
+        QuadMesh mesh;
+        std::vector<float> corners;
+};
@@ -6,6 +6,7 @@
 #include <SDL_image.h>
 #include "Matrix.h"
 #include "ShaderProgram.h"
+#include "TextRenderer.h"
 #include <vector>
 #include <SDL_mixer.h>
 
@@ -28,6 +29,9 @@ enum GameState {menu, game, endScreen};
 
 SDL_Window* displayWindow;
 
+// The camera always shows the same slice of the world, so its projection is worked out at compile time
+constexpr Matrix screenProjection = Matrix::orthoProjection(-3.55f, 3.55f, -2.0f, 2.0f, -1.0f, 1.0f);
+
 // Convert from degrees to radians
 float radianConverter(float degree){
     return (degree * (3.1415926 / 180.0));
@@ -52,49 +56,8 @@ GLuint LoadTexture(const char *image_path) {
     return textureID;
 }
 
-void DrawText(ShaderProgram *program, GLuint &fontTexture, std::string text, float size, float spacing, float xCord, float yCord, Matrix &matrix) {
-    float texture_size = 1.0/16.0f;
-    std::vector<float> vertexData;
-    std::vector<float> texCoordData;
-    
-    for(int i=0; i < text.size(); i++) {
-        float texture_x = (float)(((int)text[i]) % 16) / 16.0f;
-        float texture_y = (float)(((int)text[i]) / 16) / 16.0f;
-        vertexData.insert(vertexData.end(), {
-            ((size+spacing) * i) + (-0.5f * size), 0.5f * size,
-            ((size+spacing) * i) + (-0.5f * size), -0.5f * size,
-            ((size+spacing) * i) + (0.5f * size), 0.5f * size,
-            ((size+spacing) * i) + (0.5f * size), -0.5f * size,
-            ((size+spacing) * i) + (0.5f * size), 0.5f * size,
-            ((size+spacing) * i) + (-0.5f * size), -0.5f * size,
-        });
-        texCoordData.insert(texCoordData.end(), {
-            texture_x, texture_y,
-            texture_x, texture_y + texture_size,
-            texture_x + texture_size, texture_y,
-            texture_x + texture_size, texture_y + texture_size,
-            texture_x + texture_size, texture_y,
-            texture_x, texture_y + texture_size,
-        }); }
-    matrix.identity();
-    matrix.Translate(xCord, yCord, 0.0f);
-    program->setModelMatrix(matrix);
-    
-    
-    glUseProgram(program->programID);
-    glBindTexture(GL_TEXTURE_2D, fontTexture);
-    
-    glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, 0, vertexData.data());
-    glEnableVertexAttribArray(program->positionAttribute);
-    
-    glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, 0, texCoordData.data());
-    glEnableVertexAttribArray(program->texCoordAttribute);
-    
-    glDrawArrays(GL_TRIANGLES, 0, (float)(text.size() * 6));
-    
-    glDisableVertexAttribArray(program->positionAttribute);
-    glDisableVertexAttribArray(program->texCoordAttribute);
-}
+// Menu text is laid out once and then drawn straight from the cache every frame
+TextRenderer textRenderer;
 
 // use enums to determine entity types
 
@@ -482,7 +445,6 @@ public:
     }
     std::vector<std::vector<RoomTrail>> path;
     std::vector<std::vector<int>> grid;
-    Matrix projectionMatrix;
     GLuint textureID;
     // for testing purpose
     float x = 0;
@@ -573,9 +535,8 @@ public:
         std::vector<float> tileTexts;
         Matrix model;
     
-        projectionMatrix.setOrthoProjection(-3.55, 3.55, -2.0f, 2.0f, -1.0f, 1.0f);
-        glUseProgram(program->programID);
-        program->setProjectionMatrix(projectionMatrix);
+        program->use();
+        program->setProjectionMatrix(screenProjection);
         // don't forget you need to bind the texture
         glBindTexture(GL_TEXTURE_2D, textureID);
         
@@ -693,22 +654,21 @@ void render(GameState& state, Map& gameGrid, Entity& player, ShaderProgram* prog
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     
-        Matrix projectionMatrix;
         Matrix viewMatrix;
-        projectionMatrix.setOrthoProjection(-3.55, 3.55, -2.0f, 2.0f, -1.0f, 1.0f);
         
-        glUseProgram(program->programID);
+        program->use();
         program->setViewMatrix(viewMatrix);
-        program->setProjectionMatrix(projectionMatrix);
+        program->setProjectionMatrix(screenProjection);
     
         if (state == game){
             gameGrid.drawTiles(program, player);
         }
         else if (state == menu){
-            DrawText(program, fontTexture, "Welcome to the Maze", 0.3f, 0.001f, -3.25f, 1.0f, words);
-            DrawText(program, fontTexture, "To Continue Press P", 0.3f, 0.001f, -3.25f, 0.5f, words);
-            DrawText(program, fontTexture, "To Quit Press B", 0.3f, 0.001f, -3.25f, 0.0f, words);
+            textRenderer.draw("Welcome to the Maze", 0.3f, 0.001f, -3.25f, 1.0f);
+            textRenderer.draw("To Continue Press P", 0.3f, 0.001f, -3.25f, 0.5f);
+            textRenderer.draw("To Quit Press B", 0.3f, 0.001f, -3.25f, 0.0f);
         }
+        textRenderer.flush(program, fontTexture);
 
         glDisable(GL_BLEND);
         SDL_GL_SwapWindow(displayWindow);
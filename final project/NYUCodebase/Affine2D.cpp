@@ -0,0 +1,68 @@
+#include "Affine2D.h"
+#include <math.h>
+
+Affine2D::Affine2D() {
+    identity();
+}
+
+void Affine2D::identity() {
+    a = 1.0f;
+    b = 0.0f;
+    c = 0.0f;
+    d = 1.0f;
+    tx = 0.0f;
+    ty = 0.0f;
+}
+
+void Affine2D::Translate(float x, float y) {
+    tx += a * x + c * y;
+    ty += b * x + d * y;
+}
+
+void Affine2D::Scale(float x, float y) {
+    a *= x;
+    b *= x;
+    c *= y;
+    d *= y;
+}
+
+void Affine2D::Rotate(float rotation) {
+    float cosine = cosf(rotation);
+    float sine = sinf(rotation);
+    float newA = a * cosine + c * sine;
+    float newB = b * cosine + d * sine;
+    c = c * cosine - a * sine;
+    d = d * cosine - b * sine;
+    a = newA;
+    b = newB;
+}
+
+void Affine2D::toMatrix(Matrix &matrix) const {
+    matrix.identity();
+    matrix.m[0][0] = a;
+    matrix.m[0][1] = b;
+    matrix.m[1][0] = c;
+    matrix.m[1][1] = d;
+    matrix.m[3][0] = tx;
+    matrix.m[3][1] = ty;
+}
+
+Matrix Affine2D::toMatrix() const {
+    Matrix matrix;
+    toMatrix(matrix);
+    return matrix;
+}
+
+void Affine2D::transformPoint(float x, float y, float &outX, float &outY) const {
+    outX = a * x + c * y + tx;
+    outY = b * x + d * y + ty;
+}
+
+void Affine2D::transformPoints(const float *in, float *out, int count) const {
+    for(int i = 0; i < count; i++) {
+        float x = in[i * 2];
+        float y = in[i * 2 + 1];
+        out[i * 2] = a * x + c * y + tx;
+        out[i * 2 + 1] = b * x + d * y + ty;
+    }
+}
@@ -0,0 +1,405 @@
+#include "ChunkedTileMap.h"
+#include <math.h>
+#include <algorithm>
+#include <string.h>
+
+// glew declares the framebuffer calls itself, everywhere else glext.h only does with GL_GLEXT_PROTOTYPES,
+// which the Xcode projects define. Without either the cache is compiled out and setCached() won't turn it on
+#if defined(GL_ARB_framebuffer_object) && (defined(_WINDOWS) || defined(GL_GLEXT_PROTOTYPES))
+#define TILE_CACHE
+#endif
+
+ChunkedTileMap::ChunkedTileMap(float tileSize, int spriteCountX, int spriteCountY)
+: width(0), height(0), chunksDrawn(0), chunksBuilt(0), tilesDrawn(0), chunksBaked(0), chunksEvicted(0), tileSize(tileSize),
+  spriteCountX(spriteCountX), spriteCountY(spriteCountY), chunksWide(0), chunksHigh(0), externalTiles(NULL),
+  useCache(false), cacheTexelsPerTile(32), cacheMaxTextures(CHUNK_CACHE_TEXTURES), cacheFrame(0), cacheQuads(QUAD_PACKED) {}
+
+void ChunkedTileMap::resize(int width, int height) {
+    clear();
+    this->width = width;
+    this->height = height;
+    chunksWide = (width + CHUNK_TILES - 1) / CHUNK_TILES;
+    chunksHigh = (height + CHUNK_TILES - 1) / CHUNK_TILES;
+    tiles.assign(width * height, -1);
+    externalTiles = NULL;
+    chunks.assign(chunksWide * chunksHigh, Chunk());
+}
+
+void ChunkedTileMap::useTiles(const int *tiles, int width, int height) {
+    clear();
+    std::vector<int>().swap(this->tiles);
+    this->width = width;
+    this->height = height;
+    chunksWide = (width + CHUNK_TILES - 1) / CHUNK_TILES;
+    chunksHigh = (height + CHUNK_TILES - 1) / CHUNK_TILES;
+    externalTiles = tiles;
+    chunks.assign(chunksWide * chunksHigh, Chunk());
+}
+
+const int *ChunkedTileMap::tileData() const {
+    return externalTiles ? externalTiles : tiles.data();
+}
+
+void ChunkedTileMap::setTile(int x, int y, int sprite) {
+    if (x < 0 || y < 0 || x >= width || y >= height) {
+        return;
+    }
+    if (tileData()[y * width + x] == sprite) {
+        return;
+    }
+    // the first change to someone else's tiles makes our own copy of them
+    if (externalTiles) {
+        tiles.assign(externalTiles, externalTiles + width * height);
+        externalTiles = NULL;
+    }
+    tiles[y * width + x] = sprite;
+    chunks[(y / CHUNK_TILES) * chunksWide + x / CHUNK_TILES].dirty = true;
+}
+
+int ChunkedTileMap::getTile(int x, int y) const {
+    if (x < 0 || y < 0 || x >= width || y >= height) {
+        return -1;
+    }
+    return tileData()[y * width + x];
+}
+
+void ChunkedTileMap::buildChunk(int chunkX, int chunkY) {
+    Chunk &chunk = chunks[chunkY * chunksWide + chunkX];
+    chunk.mesh.reset();
+    
+    float spriteWidth = 1.0f / (float) spriteCountX;
+    float spriteHeight = 1.0f / (float) spriteCountY;
+    
+    const int *tiles = tileData();
+    int lastX = std::min((chunkX + 1) * CHUNK_TILES, width);
+    int lastY = std::min((chunkY + 1) * CHUNK_TILES, height);
+    for (int y = chunkY * CHUNK_TILES; y < lastY; y++) {
+        for (int x = chunkX * CHUNK_TILES; x < lastX; x++) {
+            int sprite = tiles[y * width + x];
+            if (sprite < 0) {
+                continue;
+            }
+            float u = (float)(sprite % spriteCountX) / (float) spriteCountX;
+            float v = (float)(sprite / spriteCountX) / (float) spriteCountY;
+            // in tiles, draw() scales them up to tileSize
+            chunk.mesh.addRect((float)x, (float)-y, (float)(x + 1), (float)(-y - 1), u, v, spriteWidth, spriteHeight);
+        }
+    }
+    
+    chunk.dirty = false;
+    chunk.cacheDirty = true;
+    chunksBuilt++;
+    if (chunk.mesh.quadCount() > 0) {
+        chunk.mesh.upload();
+    }
+}
+
+void ChunkedTileMap::draw(ShaderProgram *program, GLuint textureID, const Matrix &modelMatrix, const Matrix &viewMatrix, const Matrix &projectionMatrix) {
+    chunksDrawn = 0;
+    chunksBuilt = 0;
+    tilesDrawn = 0;
+    chunksBaked = 0;
+    chunksEvicted = 0;
+    if (chunks.empty()) {
+        return;
+    }
+    
+    // Take the corners of the screen back into map space to find the rectangle the camera sees
+    Matrix screenToWorld = (modelMatrix * viewMatrix * projectionMatrix).inverse();
+    float minX = 0.0f, maxX = 0.0f, minY = 0.0f, maxY = 0.0f;
+    for (int corner = 0; corner < 4; corner++) {
+        float screen[4] = {(corner & 1) ? 1.0f : -1.0f, (corner & 2) ? 1.0f : -1.0f, 0.0f, 1.0f};
+        float world[4];
+        screenToWorld.transform(screen, world);
+        float x = world[0] / world[3];
+        float y = world[1] / world[3];
+        if (corner == 0 || x < minX) minX = x;
+        if (corner == 0 || x > maxX) maxX = x;
+        if (corner == 0 || y < minY) minY = y;
+        if (corner == 0 || y > maxY) maxY = y;
+    }
+    
+    // Tiles to chunks, clamped as floats first so a camera far off the map can't overflow an int
+    float chunkSize = tileSize * CHUNK_TILES;
+    int firstChunkX = (int)std::max(floorf(minX / chunkSize), 0.0f);
+    int lastChunkX = (int)std::min(floorf(maxX / chunkSize), (float)(chunksWide - 1));
+    int firstChunkY = (int)std::max(floorf(-maxY / chunkSize), 0.0f);
+    int lastChunkY = (int)std::min(floorf(-minY / chunkSize), (float)(chunksHigh - 1));
+    
+    if (useCache && cacheQuads.quadCount() != (int)chunks.size()) {
+        buildCacheQuads();
+    }
+    
+    // Everything on screen gets marked first, so baking one chunk can't take the texture of another one still in view
+    if (useCache) {
+        cacheFrame++;
+        for (int chunkY = firstChunkY; chunkY <= lastChunkY; chunkY++) {
+            for (int chunkX = firstChunkX; chunkX <= lastChunkX; chunkX++) {
+                int slot = chunks[chunkY * chunksWide + chunkX].cacheSlot;
+                if (slot >= 0) {
+                    cacheSlots[slot].lastDrawn = cacheFrame;
+                }
+            }
+        }
+    }
+    
+    // Meshes and cached textures for the chunks coming on screen, before anything gets drawn
+    // since baking borrows the program's matrices
+    bool baking = false;
+#ifdef TILE_CACHE
+    GLint framebuffer = 0;
+#endif
+    GLint viewport[4];
+    GLfloat clearColor[4];
+    GLboolean blend = GL_FALSE;
+    for (int chunkY = firstChunkY; chunkY <= lastChunkY; chunkY++) {
+        for (int chunkX = firstChunkX; chunkX <= lastChunkX; chunkX++) {
+            Chunk &chunk = chunks[chunkY * chunksWide + chunkX];
+            if (chunk.dirty) {
+                buildChunk(chunkX, chunkY);
+            }
+            if (!useCache || !chunk.cacheDirty || chunk.mesh.quadCount() == 0) {
+                continue;
+            }
+            if (!baking) {
+                // whatever we were drawing into gets put back afterwards, it isn't always the window
+#ifdef TILE_CACHE
+                glGetIntegerv(GL_FRAMEBUFFER_BINDING, &framebuffer);
+#endif
+                glGetIntegerv(GL_VIEWPORT, viewport);
+                glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+                blend = glIsEnabled(GL_BLEND);
+                // the tiles' own alpha goes into the texture, it gets blended when the chunk is drawn
+                glDisable(GL_BLEND);
+                baking = true;
+            }
+            bakeChunk(program, textureID, chunkX, chunkY);
+        }
+    }
+    if (baking) {
+#ifdef TILE_CACHE
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+#endif
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+        if (blend) {
+            glEnable(GL_BLEND);
+        }
+        program->setViewMatrix(viewMatrix);
+        program->setProjectionMatrix(projectionMatrix);
+    }
+    if (useCache) {
+        trimCache();
+    }
+    
+    // the meshes count in whole tiles
+    Matrix tileMatrix = modelMatrix;
+    tileMatrix.Scale(tileSize, tileSize, 1.0f);
+    program->use();
+    program->setModelMatrix(tileMatrix);
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    
+    for (int chunkY = firstChunkY; chunkY <= lastChunkY; chunkY++) {
+        for (int chunkX = firstChunkX; chunkX <= lastChunkX; chunkX++) {
+            Chunk &chunk = chunks[chunkY * chunksWide + chunkX];
+            if (chunk.mesh.quadCount() == 0) {
+                continue;
+            }
+            if (useCache) {
+                glBindTexture(GL_TEXTURE_2D, cacheSlots[chunk.cacheSlot].texture);
+                cacheQuads.draw(program, chunkY * chunksWide + chunkX, 1);
+            } else {
+                chunk.mesh.draw(program);
+            }
+            chunksDrawn++;
+            tilesDrawn += chunk.mesh.quadCount();
+        }
+    }
+}
+
+#ifdef TILE_CACHE
+void ChunkedTileMap::bakeChunk(ShaderProgram *program, GLuint textureID, int chunkX, int chunkY) {
+    Chunk &chunk = chunks[chunkY * chunksWide + chunkX];
+    int size = CHUNK_TILES * cacheTexelsPerTile;
+    if (chunk.cacheSlot < 0) {
+        chunk.cacheSlot = takeCacheSlot(chunkY * chunksWide + chunkX);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, cacheSlots[chunk.cacheSlot].framebuffer);
+    glViewport(0, 0, size, size);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    
+    // exactly this chunk's tiles fill the texture
+    float left = (float)(chunkX * CHUNK_TILES);
+    float top = (float)(-chunkY * CHUNK_TILES);
+    Matrix identity;
+    program->setModelMatrix(identity);
+    program->setViewMatrix(identity);
+    program->setProjectionMatrix(Matrix::orthoProjection(left, left + CHUNK_TILES, top - CHUNK_TILES, top, -1.0f, 1.0f));
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    chunk.mesh.draw(program);
+    
+    chunk.cacheDirty = false;
+    chunksBaked++;
+}
+
+// A texture for the chunk to be baked into: a new one while the pool has room, after that the one that's been
+// off screen the longest. Only when every texture is on screen does the pool go past cacheMaxTextures
+int ChunkedTileMap::takeCacheSlot(int chunkIndex) {
+    if ((int)cacheSlots.size() >= cacheMaxTextures) {
+        int oldest = -1;
+        for (size_t i = 0; i < cacheSlots.size(); i++) {
+            if (cacheSlots[i].lastDrawn != cacheFrame && (oldest < 0 || cacheSlots[i].lastDrawn < cacheSlots[oldest].lastDrawn)) {
+                oldest = (int)i;
+            }
+        }
+        if (oldest >= 0) {
+            // the chunk that had it gets baked again if it comes back
+            Chunk &previous = chunks[cacheSlots[oldest].chunk];
+            previous.cacheSlot = -1;
+            previous.cacheDirty = true;
+            cacheSlots[oldest].chunk = chunkIndex;
+            cacheSlots[oldest].lastDrawn = cacheFrame;
+            chunksEvicted++;
+            return oldest;
+        }
+    }
+    
+    int size = CHUNK_TILES * cacheTexelsPerTile;
+    CacheSlot slot = {0, 0, chunkIndex, cacheFrame};
+    glGenTextures(1, &slot.texture);
+    glBindTexture(GL_TEXTURE_2D, slot.texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // so the edge of one chunk doesn't pick up the far edge of the same texture
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glGenFramebuffers(1, &slot.framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, slot.framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, slot.texture, 0);
+    cacheSlots.push_back(slot);
+    return (int)cacheSlots.size() - 1;
+}
+#else
+// useCache never gets set without the framebuffer calls, so nothing gets baked
+void ChunkedTileMap::bakeChunk(ShaderProgram *, GLuint, int, int) {
+}
+#endif
+
+void ChunkedTileMap::setCached(bool enabled, int texelsPerTile, int maxTextures) {
+    enabled = enabled && cacheSupported();
+    if (!enabled || texelsPerTile != cacheTexelsPerTile) {
+        clearCache();
+    }
+    cacheTexelsPerTile = texelsPerTile;
+    // a smaller pool gets trimmed down to size by the next draw()
+    cacheMaxTextures = std::max(maxTextures, 1);
+    useCache = enabled;
+}
+
+void ChunkedTileMap::buildCacheQuads() {
+    cacheQuads.reset();
+    for (int chunkY = 0; chunkY < chunksHigh; chunkY++) {
+        for (int chunkX = 0; chunkX < chunksWide; chunkX++) {
+            float left = (float)(chunkX * CHUNK_TILES);
+            float top = (float)(-chunkY * CHUNK_TILES);
+            // the texture's bottom row is the bottom of the chunk
+            cacheQuads.addRect(left, top, left + CHUNK_TILES, top - CHUNK_TILES, 0.0f, 1.0f, 1.0f, -1.0f);
+        }
+    }
+    cacheQuads.upload();
+}
+
+bool ChunkedTileMap::cached() const {
+    return useCache;
+}
+
+bool ChunkedTileMap::cacheSupported() {
+#ifdef TILE_CACHE
+#ifdef _WINDOWS
+    if (!glGenFramebuffers || !glFramebufferTexture2D) {
+        return false;
+    }
+#endif
+    const char *extensions = (const char *)glGetString(GL_EXTENSIONS);
+    return extensions && strstr(extensions, "GL_ARB_framebuffer_object");
+#else
+    return false;
+#endif
+}
+
+void ChunkedTileMap::clearCache() {
+#ifdef TILE_CACHE
+    for (size_t i = 0; i < cacheSlots.size(); i++) {
+        glDeleteFramebuffers(1, &cacheSlots[i].framebuffer);
+        glDeleteTextures(1, &cacheSlots[i].texture);
+    }
+#endif
+    cacheSlots.clear();
+    for (size_t i = 0; i < chunks.size(); i++) {
+        chunks[i].cacheSlot = -1;
+        chunks[i].cacheDirty = true;
+    }
+}
+
+// Frees the textures past cacheMaxTextures that weren't on screen this draw(), the last slot moves into each freed one
+void ChunkedTileMap::trimCache() {
+    for (size_t i = 0; i < cacheSlots.size() && (int)cacheSlots.size() > cacheMaxTextures; ) {
+        if (cacheSlots[i].lastDrawn == cacheFrame) {
+            i++;
+            continue;
+        }
+        Chunk &previous = chunks[cacheSlots[i].chunk];
+        previous.cacheSlot = -1;
+        previous.cacheDirty = true;
+#ifdef TILE_CACHE
+        glDeleteFramebuffers(1, &cacheSlots[i].framebuffer);
+        glDeleteTextures(1, &cacheSlots[i].texture);
+#endif
+        cacheSlots[i] = cacheSlots.back();
+        cacheSlots.pop_back();
+        if (i < cacheSlots.size()) {
+            chunks[cacheSlots[i].chunk].cacheSlot = (int)i;
+        }
+    }
+}
+
+void ChunkedTileMap::clear() {
+    clearCache();
+    for (size_t i = 0; i < chunks.size(); i++) {
+        chunks[i].mesh.clear();
+        chunks[i].dirty = true;
+    }
+    cacheQuads.clear();
+    cacheQuads.reset();
+}
+
+int ChunkedTileMap::meshBytes() const {
+    int bytes = 0;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        if (!chunks[i].dirty) {
+            bytes += chunks[i].mesh.vertexBytes();
+        }
+    }
+    return bytes;
+}
+
+int ChunkedTileMap::unindexedMeshBytes() const {
+    int quads = 0;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        if (!chunks[i].dirty) {
+            quads += chunks[i].mesh.quadCount();
+        }
+    }
+    return quads * UNINDEXED_BYTES_PER_QUAD;
+}
+
+int ChunkedTileMap::cacheTextures() const {
+    return (int)cacheSlots.size();
+}
+
+int ChunkedTileMap::cacheBytes() const {
+    int size = CHUNK_TILES * cacheTexelsPerTile;
+    return (int)cacheSlots.size() * size * size * 4;
+}
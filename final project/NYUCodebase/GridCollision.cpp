@@ -0,0 +1,48 @@
+#include "GridCollision.h"
+#include <algorithm>
+#include <math.h>
+
+GridContacts gridContacts(const std::vector<std::vector<int>> &grid, float tileSize, float x, float y, float width, float height) {
+    GridContacts contacts;
+    contacts.bottom = false;
+    contacts.top = false;
+    contacts.left = false;
+    contacts.right = false;
+    
+    float playerTop = y + height / 2.0f;
+    float playerBot = y - height / 2.0f;
+    float playerLeft = x - width / 2.0f;
+    float playerRight = x + width / 2.0f;
+    
+    // these are the only tiles that can touch the box
+    int levelWidth = (int)grid.size();
+    int levelHeight = levelWidth > 0 ? (int)grid[0].size() : 0;
+    int minX = std::max((int)ceilf(playerLeft / tileSize - 1.0f), 0);
+    int maxX = std::min((int)floorf(playerRight / tileSize), levelWidth - 1);
+    int minY = std::max((int)ceilf(-playerTop / tileSize), 0);
+    int maxY = std::min((int)floorf(1.0f - playerBot / tileSize), levelHeight - 1);
+    
+    for(int gridX = minX; gridX <= maxX; gridX++){
+        for(int gridY = minY; gridY <= maxY; gridY++){
+            if (grid[gridX][gridY] != 1)
+                continue;
+            float tileRight = gridX * tileSize + tileSize;
+            float tileLeft = gridX * tileSize;
+            float tileTop = gridY * -1.0 * tileSize + tileSize;
+            float tileBot = gridY * -1.0 * tileSize;
+            // Check Bottom of player
+            if (playerBot < tileTop && playerBot > tileBot && playerRight <= tileRight && playerLeft >= tileLeft)
+                contacts.bottom = true;
+            // Check Top of player
+            if (playerTop > tileBot && playerTop < tileTop && playerRight <= tileRight && playerLeft >= tileLeft)
+                contacts.top = true;
+            // Check left of player
+            if (playerLeft < tileRight && playerRight > tileRight && playerTop <= tileTop && playerBot >= tileBot)
+                contacts.left = true;
+            // Check right of player
+            if (playerRight > tileLeft && playerLeft < tileLeft && playerTop <= tileTop && playerBot >= tileBot)
+                contacts.right = true;
+        }
+    }
+    return contacts;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <vector>
+
+// Which sides of a box are up against a solid tile
+struct GridContacts {
+    bool bottom;
+    bool top;
+    bool left;
+    bool right;
+};
+
+// Tiles set to 1 in grid[x][y] are solid. Tile x,y covers x*tileSize to (x+1)*tileSize across and
+// -y*tileSize to (1-y)*tileSize up, the same as the level is drawn.
+// Only the tiles under the box get looked at, so it costs the same however big the grid is
+GridContacts gridContacts(const std::vector<std::vector<int>> &grid, float tileSize, float x, float y, float width, float height);
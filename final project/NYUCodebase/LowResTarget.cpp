@@ -0,0 +1,118 @@
+#include "LowResTarget.h"
+#include <string.h>
+#include <stdio.h>
+#include <algorithm>
+
+// glew declares the framebuffer calls itself, everywhere else glext.h only does with GL_GLEXT_PROTOTYPES,
+// which the Xcode projects define. Without either there's no target and everything draws straight to the window
+#if defined(GL_ARB_framebuffer_object) && (defined(_WINDOWS) || defined(GL_GLEXT_PROTOTYPES))
+#define LOW_RES_TARGET
+#endif
+
+LowResTarget::LowResTarget() : width(0), height(0), scale(1), framebuffer(0), colorBuffer(0) {}
+
+bool LowResTarget::supported() {
+#ifdef LOW_RES_TARGET
+#ifdef _WINDOWS
+    if (!glGenFramebuffers || !glBlitFramebuffer) {
+        return false;
+    }
+#endif
+    const char *extensions = (const char *)glGetString(GL_EXTENSIONS);
+    return extensions && strstr(extensions, "GL_ARB_framebuffer_object");
+#else
+    return false;
+#endif
+}
+
+void LowResTarget::setResolution(int width, int height) {
+    clear();
+    if (width <= 0 || height <= 0 || !supported()) {
+        return;
+    }
+#ifdef LOW_RES_TARGET
+    this->width = width;
+    this->height = height;
+    // a renderbuffer is enough, the target only ever gets blitted
+    glGenRenderbuffers(1, &colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        printf("Low res target %dx%d isn't usable, drawing straight to the window\n", width, height);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        clear();
+        return;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+#endif
+}
+
+bool LowResTarget::active() const {
+    return framebuffer != 0;
+}
+
+void LowResTarget::begin(int windowWidth, int windowHeight) {
+    if (!active()) {
+        glViewport(0, 0, windowWidth, windowHeight);
+        return;
+    }
+#ifdef LOW_RES_TARGET
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, width, height);
+#endif
+}
+
+#ifdef LOW_RES_TARGET
+void LowResTarget::present(int windowWidth, int windowHeight) {
+    if (!active()) {
+        return;
+    }
+    // Whole number scale centered in the window, or the biggest fit keeping the shape if even 1x doesn't fit
+    scale = std::min(windowWidth / width, windowHeight / height);
+    int outWidth, outHeight;
+    if (scale >= 1) {
+        outWidth = width * scale;
+        outHeight = height * scale;
+    } else {
+        float fit = std::min((float)windowWidth / width, (float)windowHeight / height);
+        outWidth = (int)(width * fit);
+        outHeight = (int)(height * fit);
+    }
+    int x = (windowWidth - outWidth) / 2;
+    int y = (windowHeight - outHeight) / 2;
+    
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, windowWidth, windowHeight);
+    // only the bars need clearing, the blit covers the rest, but one clear is cheaper than four scissored ones
+    if (outWidth != windowWidth || outHeight != windowHeight) {
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glBlitFramebuffer(0, 0, width, height, x, y, x + outWidth, y + outHeight, GL_COLOR_BUFFER_BIT, scale >= 1 ? GL_NEAREST : GL_LINEAR);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+}
+#else
+// never active() without the framebuffer calls, what was drawn is already in the window
+void LowResTarget::present(int, int) {
+}
+#endif
+
+void LowResTarget::clear() {
+#ifdef LOW_RES_TARGET
+    if (framebuffer) {
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteRenderbuffers(1, &colorBuffer);
+    }
+#endif
+    framebuffer = 0;
+    colorBuffer = 0;
+    width = 0;
+    height = 0;
+    scale = 1;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#ifdef _WINDOWS
+	#include <GL/glew.h>
+#endif
+#include <SDL_opengl.h>
+
+/*
+    Renders a frame at a fixed internal resolution and scales it up to the window in one blit.
+    The scale is the biggest whole number that fits, nearest filtered so pixel art stays sharp,
+    with black bars around whatever is left over. A window smaller than the target gets it shrunk to fit instead.
+    What a frame costs to fill only depends on the internal resolution, not on the window size or DPI.
+*/
+class LowResTarget {
+    public:
+        LowResTarget();
+    
+        // Needs a GL context. 0 x 0 draws straight to the window like before, so does a driver without framebuffer objects
+        void setResolution(int width, int height);
+    
+        // Everything drawn after this goes into the target, with the viewport set to cover it
+        void begin(int windowWidth, int windowHeight);
+        // Scales the target up onto the window, call it right before swapping
+        void present(int windowWidth, int windowHeight);
+    
+        // Frees the framebuffer, call it while the GL context is still around
+        void clear();
+    
+        bool active() const;
+        static bool supported();
+    
+        int width;
+        int height;
+        // What the last present() scaled by, 0 when it wasn't a whole number
+        int scale;
+    
+    private:
+        LowResTarget(const LowResTarget &);
+        LowResTarget &operator=(const LowResTarget &);
+    
+        GLuint framebuffer;
+        GLuint colorBuffer;
+};
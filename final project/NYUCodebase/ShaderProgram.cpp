@@ -1,17 +1,55 @@
 
 #include "ShaderProgram.h"
+#include <SDL.h>
+#include <string.h>
+#include <stdio.h>
+
+// The program binary calls only get declared by glew or by glext.h with GL_GLEXT_PROTOTYPES, the Xcode
+// projects define that so SDL's headers declare them on the mac too. Without either the cache is compiled out
+#if defined(GL_PROGRAM_BINARY_LENGTH) && (defined(_WINDOWS) || defined(GL_GLEXT_PROTOTYPES))
+#define SHADER_BINARY_CACHE
+#endif
+
+GLuint ShaderProgram::boundProgram = 0;
+int ShaderProgram::useProgramIssued = 0;
+int ShaderProgram::useProgramElided = 0;
+int ShaderProgram::uniformUploadsIssued = 0;
+int ShaderProgram::uniformUploadsElided = 0;
+std::string ShaderProgram::binaryCacheFolder = "";
+int ShaderProgram::binaryCacheHits = 0;
+int ShaderProgram::binaryCacheMisses = 0;
+
+// first thing in a cache file, bump the number if the layout below changes
+static const char binaryCacheMagic[8] = {'N', 'Y', 'U', 'B', 'I', 'N', '0', '1'};
 
 ShaderProgram::ShaderProgram(const char *vertexShaderFile, const char *fragmentShaderFile) {
     
-    // create the vertex shader
-    vertexShader = loadShaderFromFile(vertexShaderFile, GL_VERTEX_SHADER);
-    // create the fragment shader
-    fragmentShader = loadShaderFromFile(fragmentShaderFile, GL_FRAGMENT_SHADER);
+    // Create the final shader program from our vertex and fragment shaders, or pull it out of the binary cache
+    programID = buildProgram(vertexShaderFile, fragmentShaderFile, vertexShader, fragmentShader);
+    
+    modelMatrixUniform = glGetUniformLocation(programID, "modelMatrix");
+    projectionMatrixUniform = glGetUniformLocation(programID, "projectionMatrix");
+    viewMatrixUniform = glGetUniformLocation(programID, "viewMatrix");
+    
+    positionAttribute = glGetAttribLocation(programID, "position");
+    texCoordAttribute = glGetAttribLocation(programID, "texCoord");
     
-    // Create the final shader program from our vertex and fragment shaders
-    programID = glCreateProgram();
+}
+
+ShaderProgram::~ShaderProgram() {
+    release(programID, vertexShader, fragmentShader);
+}
+
+GLuint ShaderProgram::linkProgram(GLuint vertexShader, GLuint fragmentShader) {
+    GLuint programID = glCreateProgram();
     glAttachShader(programID, vertexShader);
     glAttachShader(programID, fragmentShader);
+#ifdef SHADER_BINARY_CACHE
+    // some drivers only keep the binary around if they're told up front we'll ask for it
+    if (binaryCacheSupported()) {
+        glProgramParameteri(programID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+#endif
     glLinkProgram(programID);
     
     GLint linkSuccess;
@@ -19,36 +57,191 @@ ShaderProgram::ShaderProgram(const char *vertexShaderFile, const char *fragmentS
     if(linkSuccess == GL_FALSE) {
         printf("Error linking shader program!\n");
     }
-    
-    modelMatrixUniform = glGetUniformLocation(programID, "modelMatrix");
-    projectionMatrixUniform = glGetUniformLocation(programID, "projectionMatrix");
-    viewMatrixUniform = glGetUniformLocation(programID, "viewMatrix");
-    
-    positionAttribute = glGetAttribLocation(programID, "position");
-    texCoordAttribute = glGetAttribLocation(programID, "texCoord");
-    
+    return programID;
 }
 
-ShaderProgram::~ShaderProgram() {
+void ShaderProgram::release(GLuint programID, GLuint vertexShader, GLuint fragmentShader) {
+    if (boundProgram == programID) {
+        boundProgram = 0;
+    }
     glDeleteProgram(programID);
     glDeleteShader(vertexShader);
     glDeleteShader(fragmentShader);
 }
 
-GLuint ShaderProgram::loadShaderFromFile(const std::string &shaderFile, GLenum type) {
-    //Open a file stream with the file name
-    std::ifstream infile(shaderFile);
+GLuint ShaderProgram::buildProgram(const char *vertexShaderFile, const char *fragmentShaderFile, GLuint &vertexShader, GLuint &fragmentShader) {
+    std::string vertexSource = readShaderFile(vertexShaderFile);
+    std::string fragmentSource = readShaderFile(fragmentShaderFile);
     
-    if(infile.fail()) {
-        std::cout << "Error opening shader file:" << shaderFile << std::endl;
+    std::string cachePath;
+    unsigned long long key = 0;
+    if (binaryCacheSupported()) {
+        // 64 bit FNV-1a over both sources and the driver strings, so a driver update or a shader edit misses
+        std::string driver[3];
+        const GLenum driverStrings[3] = {GL_VENDOR, GL_RENDERER, GL_VERSION};
+        for (int i = 0; i < 3; i++) {
+            const GLubyte *value = glGetString(driverStrings[i]);
+            driver[i] = value ? (const char *)value : "";
+        }
+        const std::string *parts[5] = {&vertexSource, &fragmentSource, &driver[0], &driver[1], &driver[2]};
+        key = 14695981039346656037ULL;
+        for (int i = 0; i < 5; i++) {
+            // the terminator goes in too so "ab" + "c" and "a" + "bc" don't collide
+            const unsigned char *bytes = (const unsigned char *)parts[i]->c_str();
+            for (size_t j = 0; j <= parts[i]->size(); j++) {
+                key = (key ^ bytes[j]) * 1099511628211ULL;
+            }
+        }
+        cachePath = binaryCachePath(key);
+        GLuint programID = loadProgramBinary(cachePath, key);
+        if (programID) {
+            binaryCacheHits++;
+            vertexShader = 0;
+            fragmentShader = 0;
+            return programID;
+        }
+        binaryCacheMisses++;
     }
     
-    //Create a string buffer and stream the file to it
-    std::stringstream buffer;
-    buffer << infile.rdbuf();
+    vertexShader = loadShaderFromString(vertexSource, GL_VERTEX_SHADER);
+    fragmentShader = loadShaderFromString(fragmentSource, GL_FRAGMENT_SHADER);
+    GLuint programID = linkProgram(vertexShader, fragmentShader);
+    if (!cachePath.empty()) {
+        saveProgramBinary(programID, cachePath, key);
+    }
+    return programID;
+}
+
+bool ShaderProgram::binaryCacheSupported() {
+#ifdef SHADER_BINARY_CACHE
+#ifdef _WINDOWS
+    // glew leaves these null when the driver doesn't have them
+    if (!glGetProgramBinary || !glProgramBinary || !glProgramParameteri) {
+        return false;
+    }
+#endif
+    // a driver can have the calls but no formats it's willing to save
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+#else
+    return false;
+#endif
+}
+
+std::string ShaderProgram::binaryCachePath(unsigned long long key) {
+    // nobody picked a folder, so use the one SDL gives us to write to (the app bundle usually isn't writable)
+    if (binaryCacheFolder.empty()) {
+        char *prefPath = SDL_GetPrefPath("NYU", "NYUCodebase");
+        if (prefPath) {
+            binaryCacheFolder = prefPath;
+            SDL_free(prefPath);
+        }
+    }
+    char name[64];
+    snprintf(name, sizeof(name), "shader_%016llx.bin", key);
+    return binaryCacheFolder + name;
+}
+
+#ifdef SHADER_BINARY_CACHE
+GLuint ShaderProgram::loadProgramBinary(const std::string &path, unsigned long long key) {
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return 0;
+    }
+    fseek(file, 0, SEEK_END);
+    long fileSize = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char magic[8];
+    unsigned long long fileKey;
+    GLenum format;
+    GLint length;
+    std::string binary;
+    bool ok = fread(magic, sizeof(magic), 1, file) == 1 && memcmp(magic, binaryCacheMagic, sizeof(magic)) == 0 &&
+        fread(&fileKey, sizeof(fileKey), 1, file) == 1 && fileKey == key &&
+        fread(&format, sizeof(format), 1, file) == 1 &&
+        fread(&length, sizeof(length), 1, file) == 1 && length > 0 &&
+        // a truncated or damaged file can claim any length, don't allocate more than is actually left
+        length <= fileSize - ftell(file);
+    if (ok) {
+        binary.resize(length);
+        ok = fread(&binary[0], length, 1, file) == 1;
+    }
+    fclose(file);
+    if (!ok) {
+        return 0;
+    }
+    
+    GLuint programID = glCreateProgram();
+    glProgramBinary(programID, format, binary.data(), length);
+    // the driver is allowed to refuse a binary it made itself, then we compile like normal
+    GLint linkSuccess;
+    glGetProgramiv(programID, GL_LINK_STATUS, &linkSuccess);
+    if (linkSuccess == GL_FALSE) {
+        glDeleteProgram(programID);
+        return 0;
+    }
+    return programID;
+}
+
+void ShaderProgram::saveProgramBinary(GLuint programID, const std::string &path, unsigned long long key) {
+    GLint linkSuccess;
+    glGetProgramiv(programID, GL_LINK_STATUS, &linkSuccess);
+    GLint length = 0;
+    glGetProgramiv(programID, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (linkSuccess == GL_FALSE || length <= 0) {
+        return;
+    }
+    std::string binary(length, '\0');
+    GLenum format;
+    glGetProgramBinary(programID, length, &length, &format, &binary[0]);
     
+    FILE *file = fopen(path.c_str(), "wb");
+    if (!file) {
+        printf("Couldn't write shader cache %s\n", path.c_str());
+        return;
+    }
+    fwrite(binaryCacheMagic, sizeof(binaryCacheMagic), 1, file);
+    fwrite(&key, sizeof(key), 1, file);
+    fwrite(&format, sizeof(format), 1, file);
+    fwrite(&length, sizeof(length), 1, file);
+    fwrite(binary.data(), length, 1, file);
+    fclose(file);
+}
+#else
+// binaryCacheSupported() is always false without the calls, so these never run
+GLuint ShaderProgram::loadProgramBinary(const std::string &, unsigned long long) {
+    return 0;
+}
+
+void ShaderProgram::saveProgramBinary(GLuint, const std::string &, unsigned long long) {
+}
+#endif
+
+std::string ShaderProgram::readShaderFile(const std::string &shaderFile) {
+    // one fread into a string sized from the file, instead of going through a stringstream
+    std::string contents;
+    FILE *file = fopen(shaderFile.c_str(), "rb");
+    if (!file) {
+        std::cout << "Error opening shader file:" << shaderFile << std::endl;
+        return contents;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size > 0) {
+        contents.resize(size);
+        if (fread(&contents[0], size, 1, file) != 1) {
+            contents.clear();
+        }
+    }
+    fclose(file);
+    return contents;
+}
+
+GLuint ShaderProgram::loadShaderFromFile(const std::string &shaderFile, GLenum type) {
     // Load the shader from the contents of the file
-    return loadShaderFromString(buffer.str(), type);
+    return loadShaderFromString(readShaderFile(shaderFile), type);
 }
 
 GLuint ShaderProgram::loadShaderFromString(const std::string &shaderContents, GLenum type) {
@@ -80,17 +273,55 @@ GLuint ShaderProgram::loadShaderFromString(const std::string &shaderContents, GL
     return shaderID;
 }
 
-void ShaderProgram::setViewMatrix(const Matrix &matrix) {
+void ShaderProgram::invalidateState() {
+    boundProgram = 0;
+}
+
+void ShaderProgram::resetCounters() {
+    binaryCacheHits = 0;
+    binaryCacheMisses = 0;
+    useProgramIssued = 0;
+    useProgramElided = 0;
+    uniformUploadsIssued = 0;
+    uniformUploadsElided = 0;
+}
+
+// uniforms belong to the program object, so the remembered values stay good
+// even while some other program is bound
+void ShaderProgram::use() {
+    bind(programID);
+}
+
+void ShaderProgram::bind(GLuint programID) {
+    if (boundProgram == programID) {
+        useProgramElided++;
+        return;
+    }
     glUseProgram(programID);
-    glUniformMatrix4fv(viewMatrixUniform, 1, GL_FALSE, matrix.ml);
+    boundProgram = programID;
+    useProgramIssued++;
+}
+
+void ShaderProgram::setMatrixUniform(GLuint uniform, UniformCache &cache, const Matrix &matrix) {
+    use();
+    if (cache.valid && memcmp(cache.value, matrix.ml, sizeof(cache.value)) == 0) {
+        uniformUploadsElided++;
+        return;
+    }
+    glUniformMatrix4fv(uniform, 1, GL_FALSE, matrix.ml);
+    memcpy(cache.value, matrix.ml, sizeof(cache.value));
+    cache.valid = true;
+    uniformUploadsIssued++;
+}
+
+void ShaderProgram::setViewMatrix(const Matrix &matrix) {
+    setMatrixUniform(viewMatrixUniform, viewMatrixCache, matrix);
 }
 
 void ShaderProgram::setModelMatrix(const Matrix &matrix) {
-    glUseProgram(programID);
-    glUniformMatrix4fv(modelMatrixUniform, 1, GL_FALSE, matrix.ml);
+    setMatrixUniform(modelMatrixUniform, modelMatrixCache, matrix);
 }
 
 void ShaderProgram::setProjectionMatrix(const Matrix &matrix) {
-    glUseProgram(programID);
-    glUniformMatrix4fv(projectionMatrixUniform, 1, GL_FALSE, matrix.ml);    
+    setMatrixUniform(projectionMatrixUniform, projectionMatrixCache, matrix);
 }
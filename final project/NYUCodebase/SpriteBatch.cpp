@@ -0,0 +1,89 @@
+#include "SpriteBatch.h"
+#include <algorithm>
+
+// The 4 of SpriteSheet's 6 vertices that are different corners, counter clockwise from the bottom left like QuadMesh wants
+static const int quadCorners[4] = {0, 5, 1, 2};
+
+SpriteBatch::SpriteBatch() : drawCalls(0), verticesDrawn(0), bytesUploaded(0), mesh(QUAD_PACKED_UV) {}
+
+void SpriteBatch::begin() {
+    quads.clear();
+    drawCalls = 0;
+    verticesDrawn = 0;
+    bytesUploaded = 0;
+}
+
+void SpriteBatch::addQuad(GLuint textureID, const float *corners, const float *texCoords) {
+    Quad quad;
+    quad.textureID = textureID;
+    std::copy(corners, corners + 8, quad.vertices);
+    for (int i = 0; i < 4; i++) {
+        quad.texCoords[i * 2] = texCoords[quadCorners[i] * 2];
+        quad.texCoords[i * 2 + 1] = texCoords[quadCorners[i] * 2 + 1];
+    }
+    quads.push_back(quad);
+}
+
+void SpriteBatch::draw(GLuint textureID, const Matrix &modelMatrix, const float *vertices, const float *texCoords) {
+    float corners[8];
+    for (int i = 0; i < 4; i++) {
+        corners[i * 2] = vertices[quadCorners[i] * 2];
+        corners[i * 2 + 1] = vertices[quadCorners[i] * 2 + 1];
+    }
+    // Same math the vertex shader does with modelMatrix, z is always 0 for our sprites
+    modelMatrix.transformPoints(corners, corners, 4);
+    addQuad(textureID, corners, texCoords);
+}
+
+void SpriteBatch::draw(GLuint textureID, const Affine2D &transform, const float *vertices, const float *texCoords) {
+    float corners[8];
+    for (int i = 0; i < 4; i++) {
+        corners[i * 2] = vertices[quadCorners[i] * 2];
+        corners[i * 2 + 1] = vertices[quadCorners[i] * 2 + 1];
+    }
+    transform.transformPoints(corners, corners, 4);
+    addQuad(textureID, corners, texCoords);
+}
+
+void SpriteBatch::end(ShaderProgram *program) {
+    if(quads.empty()) {
+        return;
+    }
+    // Stable so sprites sharing a texture keep the order they were drawn in
+    std::stable_sort(quads.begin(), quads.end(), [](const Quad &a, const Quad &b) {
+        return a.textureID < b.textureID;
+    });
+    
+    // Every quad is already in world space
+    Matrix identityMatrix;
+    program->setModelMatrix(identityMatrix);
+    
+    // One mesh for the whole frame, each texture draws its own stretch of it
+    mesh.reset();
+    for (size_t i = 0; i < quads.size(); i++) {
+        mesh.addQuad(quads[i].vertices, quads[i].texCoords);
+    }
+    
+    size_t start = 0;
+    while(start < quads.size()) {
+        GLuint textureID = quads[start].textureID;
+        size_t end = start;
+        while(end < quads.size() && quads[end].textureID == textureID) {
+            end++;
+        }
+        
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        int quadCount = (int)(end - start);
+        mesh.draw(program, (int)start, quadCount);
+        
+        drawCalls++;
+        verticesDrawn += quadCount * 4;
+        // client side arrays, the driver copies the vertices and indices over for the draw
+        bytesUploaded += quadCount * QuadMesh::bytesPerQuad(mesh.format());
+        start = end;
+    }
+}
+
+int SpriteBatch::quadCount() const {
+    return (int)quads.size();
+}
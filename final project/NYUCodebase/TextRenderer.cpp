@@ -0,0 +1,126 @@
+#include "TextRenderer.h"
+
+// Strings that haven't been drawn for this many frames get dropped from the cache
+#define TEXT_CACHE_FRAMES 120
+
+bool TextRenderer::RunKey::operator < (const RunKey &other) const {
+    if(size != other.size) {
+        return size < other.size;
+    }
+    if(spacing != other.spacing) {
+        return spacing < other.spacing;
+    }
+    return text < other.text;
+}
+
+TextRenderer::TextRenderer() : rebuilds(0), bytesUploaded(0), fontU(0.0f), fontV(0.0f), fontWidth(1.0f), fontHeight(1.0f), frame(0), mesh(QUAD_PACKED_UV) {}
+
+void TextRenderer::setFontRegion(float u, float v, float width, float height) {
+    fontU = u;
+    fontV = v;
+    fontWidth = width;
+    fontHeight = height;
+    // Every cached run has the old texture coordinates. They're redone in place rather than dropped, so runs already
+    // queued this frame still point at something and come out with the new region
+    for(std::map<RunKey, CachedRun>::iterator it = runs.begin(); it != runs.end(); ++it) {
+        it->second.run.texCoords.clear();
+        addTexCoords(it->first.text, it->second.run);
+    }
+}
+
+void TextRenderer::addTexCoords(const std::string &text, GlyphRun &run) const {
+    float texture_size = fontWidth / 16.0f;
+    float texture_height = fontHeight / 16.0f;
+    for(size_t i = 0; i < text.size(); i++) {
+        float texture_x = fontU + (float)(((int)text[i]) % 16) * texture_size;
+        float texture_y = fontV + (float)(((int)text[i]) / 16) * texture_height;
+        run.texCoords.insert(run.texCoords.end(), {
+            texture_x, texture_y + texture_height,
+            texture_x + texture_size, texture_y + texture_height,
+            texture_x + texture_size, texture_y,
+            texture_x, texture_y,
+        });
+    }
+}
+
+const GlyphRun &TextRenderer::layout(const std::string &text, float size, float spacing) {
+    RunKey key;
+    key.text = text;
+    key.size = size;
+    key.spacing = spacing;
+    
+    std::map<RunKey, CachedRun>::iterator found = runs.find(key);
+    if(found != runs.end()) {
+        found->second.lastUsedFrame = frame;
+        return found->second.run;
+    }
+    
+    rebuilds++;
+    CachedRun &cached = runs[key];
+    cached.lastUsedFrame = frame;
+    GlyphRun &run = cached.run;
+    run.vertices.reserve(text.size() * 8);
+    run.texCoords.reserve(text.size() * 8);
+    
+    for(size_t i = 0; i < text.size(); i++) {
+        run.vertices.insert(run.vertices.end(), {
+            ((size+spacing) * i) + (-0.5f * size), -0.5f * size,
+            ((size+spacing) * i) + (0.5f * size), -0.5f * size,
+            ((size+spacing) * i) + (0.5f * size), 0.5f * size,
+            ((size+spacing) * i) + (-0.5f * size), 0.5f * size,
+        });
+    }
+    addTexCoords(text, run);
+    return run;
+}
+
+void TextRenderer::draw(const std::string &text, float size, float spacing, float x, float y) {
+    QueuedText queuedText;
+    queuedText.run = &layout(text, size, spacing);
+    queuedText.x = x;
+    queuedText.y = y;
+    queued.push_back(queuedText);
+}
+
+void TextRenderer::flush(ShaderProgram *program, GLuint fontTexture) {
+    bytesUploaded = 0;
+    if(!queued.empty()) {
+        // Move each cached run to where it was asked for, no letters get rebuilt here
+        mesh.reset();
+        for(size_t i = 0; i < queued.size(); i++) {
+            const GlyphRun &run = *queued[i].run;
+            corners.resize(run.vertices.size());
+            for(size_t j = 0; j < run.vertices.size(); j += 2) {
+                corners[j] = run.vertices[j] + queued[i].x;
+                corners[j + 1] = run.vertices[j + 1] + queued[i].y;
+            }
+            for(size_t j = 0; j < run.vertices.size(); j += 8) {
+                mesh.addQuad(&corners[j], &run.texCoords[j]);
+            }
+        }
+        queued.clear();
+        
+        Matrix modelMatrix;
+        program->setModelMatrix(modelMatrix);
+        
+        glBindTexture(GL_TEXTURE_2D, fontTexture);
+        mesh.draw(program);
+        // client side arrays, the driver copies the vertices and indices over for the draw
+        bytesUploaded = mesh.quadCount() * QuadMesh::bytesPerQuad(mesh.format());
+    }
+    
+    // Forget strings nobody has drawn in a while, like an old score
+    frame++;
+    std::map<RunKey, CachedRun>::iterator it = runs.begin();
+    while(it != runs.end()) {
+        if(frame - it->second.lastUsedFrame > TEXT_CACHE_FRAMES) {
+            runs.erase(it++);
+        } else {
+            ++it;
+        }
+    }
+}
+
+int TextRenderer::cachedRuns() const {
+    return (int)runs.size();
+}
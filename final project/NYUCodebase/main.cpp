@@ -6,6 +6,12 @@
 #include <SDL_image.h>
 #include "Matrix.h"
 #include "ShaderProgram.h"
+#include "TextRenderer.h"
+#include "SpriteBatch.h"
+#include "Affine2D.h"
+#include "ChunkedTileMap.h"
+#include "LowResTarget.h"
+#include "GridCollision.h"
 #include <vector>
 
 #ifdef _WINDOWS
@@ -19,6 +25,9 @@
 #define TILE_SIZE 0.5f
 #define LEVEL_HEIGHT 32 // 4 rooms * 8 tiles per room
 #define LEVEL_WIDTH 32
+// The internal resolutions R cycles through, 0 x 0 draws straight to the window. The first one is what the game starts with
+#define RESOLUTION_COUNT 3
+const int internalResolutions[RESOLUTION_COUNT][2] = {{320, 180}, {640, 360}, {0, 0}};
 enum GameState {menu, game, endScreen};
 /*
     Final Project: Sonic Knock Off
@@ -27,6 +36,9 @@ enum GameState {menu, game, endScreen};
 
 SDL_Window* displayWindow;
 
+// The camera always shows the same slice of the world, so its projection is worked out at compile time
+constexpr Matrix screenProjection = Matrix::orthoProjection(-3.55f, 3.55f, -2.0f, 2.0f, -1.0f, 1.0f);
+
 // Convert from degrees to radians
 float radianConverter(float degree){
     return (degree * (3.1415926 / 180.0));
@@ -51,49 +63,12 @@ GLuint LoadTexture(const char *image_path) {
     return textureID;
 }
 
-void DrawText(ShaderProgram *program, GLuint &fontTexture, std::string text, float size, float spacing, float xCord, float yCord, Matrix &matrix) {
-    float texture_size = 1.0/16.0f;
-    std::vector<float> vertexData;
-    std::vector<float> texCoordData;
-    
-    for(int i=0; i < text.size(); i++) {
-        float texture_x = (float)(((int)text[i]) % 16) / 16.0f;
-        float texture_y = (float)(((int)text[i]) / 16) / 16.0f;
-        vertexData.insert(vertexData.end(), {
-            ((size+spacing) * i) + (-0.5f * size), 0.5f * size,
-            ((size+spacing) * i) + (-0.5f * size), -0.5f * size,
-            ((size+spacing) * i) + (0.5f * size), 0.5f * size,
-            ((size+spacing) * i) + (0.5f * size), -0.5f * size,
-            ((size+spacing) * i) + (0.5f * size), 0.5f * size,
-            ((size+spacing) * i) + (-0.5f * size), -0.5f * size,
-        });
-        texCoordData.insert(texCoordData.end(), {
-            texture_x, texture_y,
-            texture_x, texture_y + texture_size,
-            texture_x + texture_size, texture_y,
-            texture_x + texture_size, texture_y + texture_size,
-            texture_x + texture_size, texture_y,
-            texture_x, texture_y + texture_size,
-        }); }
-    matrix.identity();
-    matrix.Translate(xCord, yCord, 0.0f);
-    program->setModelMatrix(matrix);
-    
-    
-    glUseProgram(program->programID);
-    glBindTexture(GL_TEXTURE_2D, fontTexture);
-    
-    glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, 0, vertexData.data());
-    glEnableVertexAttribArray(program->positionAttribute);
-    
-    glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, 0, texCoordData.data());
-    glEnableVertexAttribArray(program->texCoordAttribute);
-    
-    glDrawArrays(GL_TRIANGLES, 0, (float)(text.size() * 6));
-    
-    glDisableVertexAttribArray(program->positionAttribute);
-    glDisableVertexAttribArray(program->texCoordAttribute);
-}
+// Menu text is laid out once and then drawn straight from the cache every frame
+TextRenderer textRenderer;
+
+// The whole frame gets drawn at a fixed size and scaled up to the window by a whole number
+LowResTarget lowResTarget;
+int resolutionIndex = 0;
 
 // use enums to determine entity types
 
@@ -102,7 +77,7 @@ enum EntityType {};
 class Entity
 {
 public:
-    Matrix matrix;
+    Affine2D transform;
     Matrix view;
     
     Entity(GLuint textureID, int spritePos, std::vector<std::vector<int>>& grid):textureID(textureID), spritePos(spritePos), grid(grid){
@@ -131,17 +106,17 @@ public:
     bool collidedLeft = false;
     bool collidedRight = false;
     
-    // Position the object
+    // Position the object, the model matrix goes to the sprite batch and the view follows the player
     void position(ShaderProgram *program){
 
-        program->setModelMatrix(matrix);
-        matrix.identity();
-        matrix.Translate(x, y, 0);
-        matrix.Scale(width, height, 1.0f);
+        transform.identity();
+        transform.Translate(x, y);
+        transform.Scale(width, height);
+        Affine2D viewTransform;
+        viewTransform.Translate(-1.0*TILE_SIZE*x, -1.0*TILE_SIZE*y);
+        viewTransform.Scale(width, height);
+        viewTransform.toMatrix(view);
         program->setViewMatrix(view);
-        view.identity();
-        view.Translate(-1.0*TILE_SIZE*x, -1.0*TILE_SIZE*y, 0.0);
-        view.Scale(width, height, 1.0f);
     }
     
     void startPlayer(std::vector<std::vector<int>>& grid){
@@ -160,53 +135,27 @@ public:
     }
     
     // One for enemies, the other for things on the grid
+    // Only looks at the tiles under the entity and sets all four collided flags in one go
+    void checkCollisions(std::vector<std::vector<int>>& grid){
+        GridContacts contacts = gridContacts(grid, TILE_SIZE, x, y, width, height);
+        collidedBottom = contacts.bottom;
+        collidedTop = contacts.top;
+        collidedLeft = contacts.left;
+        collidedRight = contacts.right;
+    }
+    
     // 0 bottom,1 top,2 left,3 right
     bool collidesWith(int area, std::vector<std::vector<int>>& grid){
-        // separate it into parts
-        // For every tile in the grid, if the area of the entity is colliding with the tile, return true
-        bool collided = false;
-        float playerTop = y + height / 2.0f;
-        float playerBot = y - height / 2.0f;
-        float playerLeft = x - width / 2.0f;
-        float playerRight = x + width / 2.0f;
-        
-        float tileTop;
-        float tileBot;
-        float tileLeft;
-        float tileRight;
-        for(int gridY = 0; gridY < LEVEL_HEIGHT; gridY++){
-            // Horizontal Now, for Checking
-            for(int gridX = 0; gridX < LEVEL_WIDTH; gridX++){
-               // Now go until you find starting point
-               if (grid[gridX][gridY] == 1){
-               tileRight = gridX * TILE_SIZE + TILE_SIZE;
-               tileLeft = gridX * TILE_SIZE;
-               tileTop = gridY * -1.0 * TILE_SIZE + TILE_SIZE;
-               tileBot = gridY * -1.0 * TILE_SIZE;
-               // Check Bottom of player
-               if(area ==0){
-                   if (playerBot < tileTop && playerBot > tileBot && playerRight <= tileRight && playerLeft >= tileLeft)
-                       collided = true;
-                }
-                // Check Top of player
-                if(area == 1){
-                    if(playerTop > tileBot && playerTop < tileTop && playerRight <= tileRight && playerLeft >= tileLeft)
-                        collided = true;
-                }
-                // Check left of player
-                if (area == 2){
-                    if(playerLeft < tileRight && playerRight > tileRight && playerTop <= tileTop && playerBot >= tileBot )
-                        collided = true;
-                }
-                // Check right of player
-                if (area == 3){
-                    if(playerRight > tileLeft && playerLeft < tileLeft && playerTop <= tileTop && playerBot >= tileBot)
-                        collided = true;
-                }
-                }
-            }
-        }
-        return collided;
+        checkCollisions(grid);
+        if (area == 0)
+            return collidedBottom;
+        if (area == 1)
+            return collidedTop;
+        if (area == 2)
+            return collidedLeft;
+        if (area == 3)
+            return collidedRight;
+        return false;
     }
    
     /*
@@ -218,10 +167,7 @@ public:
         
     }
     
-    void draw(ShaderProgram* program){
-        
-        // Bind the texture to be used
-        glBindTexture(GL_TEXTURE_2D, textureID);
+    void draw(ShaderProgram* program, SpriteBatch& batch){
     
         float u = (float)(((int) spritePos) % SPRITE_COUNT_X) / (float) SPRITE_COUNT_X;
         float v = (float)(((int) spritePos) / SPRITE_COUNT_X) / (float) SPRITE_COUNT_Y;
@@ -248,20 +194,7 @@ public:
         };
         
         position(program);
-    
-        // Map the vertex array to position attribute
-        glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, 0, vertices);
-        glEnableVertexAttribArray(program->positionAttribute);
-        
-        // Map the texture array to the texture coordinate reader
-        glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, 0, texCoords);
-        glEnableVertexAttribArray(program->texCoordAttribute);
-        
-        // Then actually draw it
-        glDrawArrays(GL_TRIANGLES, 0, ( (sizeof(vertices) / sizeof(float)) / 2));
-        
-        glDisableVertexAttribArray(program->positionAttribute);
-        glDisableVertexAttribArray(program->texCoordAttribute);
+        batch.draw(textureID, transform, vertices, texCoords);
     }
 };
 
@@ -475,18 +408,24 @@ std::vector<std::vector<int>> RoomTemplate(RoomTrail temp){
 class Map{
     // Now we need to make the map from the solution path
 public:
-    Map(GLuint textureID):textureID(textureID){
+    Map(GLuint textureID):textureID(textureID), tileMap(TILE_SIZE, SPRITE_COUNT_X, SPRITE_COUNT_Y){
         path = solutionPath();
         createMap();
     }
     std::vector<std::vector<RoomTrail>> path;
     std::vector<std::vector<int>> grid;
-    Matrix projectionMatrix;
     GLuint textureID;
     // for testing purpose
     float x = 0;
     float y = 0;
     
+    // The level doesn't move, so the tiles are kept on the GPU in chunks and only the ones on screen get drawn.
+    // With the cache on each chunk is drawn from a texture of itself, C switches it while playing
+    ChunkedTileMap tileMap;
+    
+    // Sprites that move every frame
+    SpriteBatch spriteBatch;
+    
     void resetGrid(){
         grid.clear();
         for(int xAxis = 0; xAxis < LEVEL_WIDTH; xAxis++){
@@ -546,7 +485,19 @@ public:
                }
             }
         }
-        
+        tileMap.resize(LEVEL_WIDTH, LEVEL_HEIGHT);
+        tileMap.setCached(true);
+        for(int gridX = 0; gridX < LEVEL_WIDTH; gridX++){
+            for(int gridY = 0; gridY < LEVEL_HEIGHT; gridY++){
+                tileMap.setTile(gridX, gridY, positionInSheet(grid[gridX][gridY]));
+            }
+        }
+    }
+    
+    // Change a single tile, only its chunk gets rebuilt on the next draw
+    void setTile(int gridX, int gridY, int tile){
+        grid[gridX][gridY] = tile;
+        tileMap.setTile(gridX, gridY, positionInSheet(tile));
     }
     
     int positionInSheet(int gridData){
@@ -568,68 +519,17 @@ public:
         return gridData;
     }
     void drawTiles(ShaderProgram *program, Entity& player){
-        std::vector<float> tileVerts;
-        std::vector<float> tileTexts;
-        Matrix model;
-    
-        projectionMatrix.setOrthoProjection(-3.55, 3.55, -2.0f, 2.0f, -1.0f, 1.0f);
-        glUseProgram(program->programID);
-        program->setProjectionMatrix(projectionMatrix);
-        // don't forget you need to bind the texture
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        
-        for (int y=0; y < LEVEL_HEIGHT; y++){
-            for (int x=0; x < LEVEL_WIDTH;  x++){
-                int positionInSpriteSheet = positionInSheet(grid[x][y]);
-                
-                // replace levelData call with it's position in spritesheet
-                float u = (float)(((int) positionInSpriteSheet) % SPRITE_COUNT_X) / (float) SPRITE_COUNT_X;
-                float v = (float)(((int) positionInSpriteSheet) / SPRITE_COUNT_X) / (float) SPRITE_COUNT_Y;
-                
-                float spriteWidth = 1.0f / (float) SPRITE_COUNT_X;
-                float spriteHeight = 1.0f / (float) SPRITE_COUNT_Y;
-                
-                tileVerts.insert(tileVerts.end(), {
-                    TILE_SIZE * x, -TILE_SIZE * y,
-                    TILE_SIZE * x, (-TILE_SIZE * y)-TILE_SIZE,
-                    (TILE_SIZE * x)+TILE_SIZE, (-TILE_SIZE * y)-TILE_SIZE,
-                    TILE_SIZE * x, -TILE_SIZE * y,
-                    (TILE_SIZE * x)+TILE_SIZE, (-TILE_SIZE * y)-TILE_SIZE,
-                    (TILE_SIZE * x)+TILE_SIZE, -TILE_SIZE * y
-                });
-                
-                tileTexts.insert(tileTexts.end(), {
-                    u, v,
-                    u, v+(spriteHeight),
-                    u+spriteWidth, v+(spriteHeight),
-                    u, v,
-                    u+spriteWidth, v+(spriteHeight),
-                    u+spriteWidth, v
-                });
-                
-            }
-        }
+        program->use();
+        program->setProjectionMatrix(screenProjection);
         
         // player.position(program);
-        player.draw(program);
-        program->setModelMatrix(model);
-        
-        // Map the vertex array to position attribute
-        glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, 0, tileVerts.data());
-        glEnableVertexAttribArray(program->positionAttribute);
-        
-        // Map the texture array to the texture coordinate reader
-        glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, 0, tileTexts.data());
-        glEnableVertexAttribArray(program->texCoordAttribute);
+        spriteBatch.begin();
+        player.draw(program, spriteBatch);
+        spriteBatch.end(program);
         
-        // Then actually draw it
-        glDrawArrays(GL_TRIANGLES, 0, ( (int)tileVerts.size() / 2));
-        
-        glDisableVertexAttribArray(program->positionAttribute);
-        glDisableVertexAttribArray(program->texCoordAttribute);
-        
-    
-        SDL_GL_SwapWindow(displayWindow);
+        // the player's view is the camera, only the chunks it can see get drawn
+        Matrix model;
+        tileMap.draw(program, textureID, model, player.view, screenProjection);
     }
 };
 
@@ -637,7 +537,7 @@ public:
 void setup()
 {
     SDL_Init(SDL_INIT_VIDEO);
-    displayWindow = SDL_CreateWindow("My Game", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 640, 360, SDL_WINDOW_OPENGL);
+    displayWindow = SDL_CreateWindow("My Game", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 640, 360, SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI);
     SDL_GLContext context = SDL_GL_CreateContext(displayWindow);
     SDL_GL_MakeCurrent(displayWindow, context);
     #ifdef _WINDOWS
@@ -646,13 +546,24 @@ void setup()
 }
 
 // processes the input from out program
-void processEvents(SDL_Event &event, bool &done, float &timePerFrame, Entity& player, GameState& state)
+void processEvents(SDL_Event &event, bool &done, float &timePerFrame, Entity& player, GameState& state, Map& gameGrid)
 {
     const Uint8 *keys = SDL_GetKeyboardState(NULL);
     while (SDL_PollEvent(&event)) {
         if (event.type == SDL_QUIT || event.type == SDL_WINDOWEVENT_CLOSE) {
             done = true;
         }
+        // once per press, holding it down shouldn't flicker between the two
+        if (event.type == SDL_KEYDOWN && !event.key.repeat && event.key.keysym.scancode == SDL_SCANCODE_C && state == game) {
+            gameGrid.tileMap.setCached(!gameGrid.tileMap.cached());
+            if (!ChunkedTileMap::cacheSupported()) {
+                printf("This driver can't render to a texture, the tile cache stays off\n");
+            }
+        }
+        if (event.type == SDL_KEYDOWN && !event.key.repeat && event.key.keysym.scancode == SDL_SCANCODE_R) {
+            resolutionIndex = (resolutionIndex + 1) % RESOLUTION_COUNT;
+            lowResTarget.setResolution(internalResolutions[resolutionIndex][0], internalResolutions[resolutionIndex][1]);
+        }
     }
     if (state == game){
         if (keys[SDL_SCANCODE_UP]){
@@ -686,29 +597,34 @@ void processEvents(SDL_Event &event, bool &done, float &timePerFrame, Entity& pl
 void render(GameState& state, Map& gameGrid, Entity& player, ShaderProgram* program, GLuint fontTexture){
         Matrix words;
     
+        // the window can be any size, the drawable is bigger than it on a retina screen
+        int windowWidth, windowHeight;
+        SDL_GL_GetDrawableSize(displayWindow, &windowWidth, &windowHeight);
+        lowResTarget.begin(windowWidth, windowHeight);
+    
         glClearColor(0.5f, 0.5f, 0.5f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     
-        Matrix projectionMatrix;
         Matrix viewMatrix;
-        projectionMatrix.setOrthoProjection(-3.55, 3.55, -2.0f, 2.0f, -1.0f, 1.0f);
         
-        glUseProgram(program->programID);
+        program->use();
         program->setViewMatrix(viewMatrix);
-        program->setProjectionMatrix(projectionMatrix);
+        program->setProjectionMatrix(screenProjection);
     
         if (state == game){
             gameGrid.drawTiles(program, player);
         }
         else if (state == menu){
-            DrawText(program, fontTexture, "Welcome to the Maze", 0.3f, 0.001f, -3.25f, 1.0f, words);
-            DrawText(program, fontTexture, "To Continue Press P", 0.3f, 0.001f, -3.25f, 0.5f, words);
-            DrawText(program, fontTexture, "To Quit Press B", 0.3f, 0.001f, -3.25f, 0.0f, words);
+            textRenderer.draw("Welcome to the Maze", 0.3f, 0.001f, -3.25f, 1.0f);
+            textRenderer.draw("To Continue Press P", 0.3f, 0.001f, -3.25f, 0.5f);
+            textRenderer.draw("To Quit Press B", 0.3f, 0.001f, -3.25f, 0.0f);
         }
+        textRenderer.flush(program, fontTexture);
 
         glDisable(GL_BLEND);
+        lowResTarget.present(windowWidth, windowHeight);
         SDL_GL_SwapWindow(displayWindow);
 }
 
@@ -739,6 +655,7 @@ int main(int argc, char *argv[])
     GLuint game_texture;
     game_texture = LoadTexture("spritesheet_rgba.png");
     font_texture = LoadTexture("font1.png");
+    lowResTarget.setResolution(internalResolutions[resolutionIndex][0], internalResolutions[resolutionIndex][1]);
     Map gameGrid = Map(game_texture);
     Entity player = Entity(game_texture, 19, gameGrid.grid);
     // Grand Finale!
@@ -760,11 +677,13 @@ int main(int argc, char *argv[])
                 // run update once again
                 update(currentState, &program, font_texture);
                 // Run render after updates
-                processEvents(event, done, fixedElapsed, player, currentState);
+                processEvents(event, done, fixedElapsed, player, currentState, gameGrid);
                 render(currentState, gameGrid, player, &program, font_texture);
         
     }
 
+    gameGrid.tileMap.clear();
+    lowResTarget.clear();
     cleanUp(&program);
     return 0;
 }
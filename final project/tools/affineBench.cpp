@@ -0,0 +1,155 @@
+/*
+    affineBench [entities]
+
+    Places entities the way the game does, Translate then Rotate then Scale, once with a 4x4 Matrix and once with
+    Affine2D, then times both ways, with and without the Rotate, and again with the bulk point transforms after.
+    Every Affine2D result has to come out the same as the Matrix one (to float rounding), anything that doesn't
+    is printed and the exit code is 1.
+    Builds on its own, from this folder:
+        c++ -O2 -I../NYUCodebase affineBench.cpp ../NYUCodebase/Affine2D.cpp ../NYUCodebase/Matrix.cpp -o affineBench -pthread
+*/
+
+#include "Affine2D.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+
+#define TOLERANCE 0.0001f
+#define POINTS_PER_ENTITY 4
+
+struct Placement {
+    float x, y, rotation, width, height;
+};
+
+static float randomFloat(float low, float high) {
+    return low + (high - low) * rand() / RAND_MAX;
+}
+
+// Entity::position only translates and scales, rotate adds a Rotate in between
+static void placeMatrix(const Placement &p, bool rotate, Matrix &matrix) {
+    matrix.identity();
+    matrix.Translate(p.x, p.y, 0.0f);
+    if (rotate) {
+        matrix.Rotate(p.rotation);
+    }
+    matrix.Scale(p.width, p.height, 1.0f);
+}
+
+static void placeAffine(const Placement &p, bool rotate, Affine2D &transform) {
+    transform.identity();
+    transform.Translate(p.x, p.y);
+    if (rotate) {
+        transform.Rotate(p.rotation);
+    }
+    transform.Scale(p.width, p.height);
+}
+
+static bool close(float a, float b) {
+    return fabsf(a - b) <= TOLERANCE * fmaxf(1.0f, fabsf(b));
+}
+
+static double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[]) {
+    int count = argc > 1 ? atoi(argv[1]) : 100000;
+    if (count < 1) {
+        printf("usage: affineBench [entities]\n");
+        return 1;
+    }
+    srand(1);
+    std::vector<Placement> placements(count);
+    for (int i = 0; i < count; i++) {
+        placements[i].x = randomFloat(-50.0f, 50.0f);
+        placements[i].y = randomFloat(-50.0f, 50.0f);
+        placements[i].rotation = randomFloat(-3.14159f, 3.14159f);
+        placements[i].width = randomFloat(0.1f, 4.0f);
+        placements[i].height = randomFloat(0.1f, 4.0f);
+    }
+    // a unit quad's corners for every entity
+    std::vector<float> corners(count * POINTS_PER_ENTITY * 2);
+    for (int i = 0; i < count; i++) {
+        float quad[POINTS_PER_ENTITY * 2] = {-0.5f, -0.5f, 0.5f, -0.5f, 0.5f, 0.5f, -0.5f, 0.5f};
+        for (int j = 0; j < POINTS_PER_ENTITY * 2; j++) {
+            corners[i * POINTS_PER_ENTITY * 2 + j] = quad[j];
+        }
+    }
+    
+    // same transform and the same corners out of both
+    std::vector<float> matrixCorners(corners.size()), affineCorners(corners.size());
+    for (int i = 0; i < count; i++) {
+        Matrix matrix;
+        Affine2D transform;
+        placeMatrix(placements[i], true, matrix);
+        placeAffine(placements[i], true, transform);
+        Matrix converted = transform.toMatrix();
+        for (int col = 0; col < 4; col++) {
+            for (int row = 0; row < 4; row++) {
+                if (!close(converted.m[col][row], matrix.m[col][row])) {
+                    printf("Entity %d: Affine2D gives m[%d][%d] = %g, Matrix gives %g\n", i, col, row, converted.m[col][row], matrix.m[col][row]);
+                    return 1;
+                }
+            }
+        }
+        size_t first = (size_t)i * POINTS_PER_ENTITY * 2;
+        matrix.transformPoints(&corners[first], &matrixCorners[first], POINTS_PER_ENTITY);
+        transform.transformPoints(&corners[first], &affineCorners[first], POINTS_PER_ENTITY);
+        for (int j = 0; j < POINTS_PER_ENTITY * 2; j++) {
+            if (!close(affineCorners[first + j], matrixCorners[first + j])) {
+                printf("Entity %d: Affine2D puts a corner at %g, Matrix puts it at %g\n", i, affineCorners[first + j], matrixCorners[first + j]);
+                return 1;
+            }
+        }
+    }
+    
+    // a bit of every transform gets summed, so none of them can be skipped
+    float sum = 0.0f;
+    for (int rotate = 0; rotate < 2; rotate++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int i = 0; i < count; i++) {
+            Matrix matrix;
+            placeMatrix(placements[i], rotate, matrix);
+            sum += matrix.m[3][0];
+        }
+        double matrixTime = seconds(start) / count;
+        
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < count; i++) {
+            Affine2D transform;
+            placeAffine(placements[i], rotate, transform);
+            Matrix upload;
+            transform.toMatrix(upload);
+            sum += upload.m[3][0];
+        }
+        double affineTime = seconds(start) / count;
+        
+        // the corners of every entity as well, the way SpriteBatch bakes them
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < count; i++) {
+            Matrix matrix;
+            placeMatrix(placements[i], rotate, matrix);
+            size_t first = (size_t)i * POINTS_PER_ENTITY * 2;
+            matrix.transformPoints(&corners[first], &matrixCorners[first], POINTS_PER_ENTITY);
+        }
+        double matrixCornerTime = seconds(start) / count;
+        
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < count; i++) {
+            Affine2D transform;
+            placeAffine(placements[i], rotate, transform);
+            size_t first = (size_t)i * POINTS_PER_ENTITY * 2;
+            transform.transformPoints(&corners[first], &affineCorners[first], POINTS_PER_ENTITY);
+        }
+        double affineCornerTime = seconds(start) / count;
+        sum += matrixCorners[count] + affineCorners[count];
+        
+        printf("%s, %d entities: Matrix %.1f ns, Affine2D (and its 4x4 for the shader) %.1f ns an entity\n",
+               rotate ? "translate, rotate, scale" : "translate, scale", count, matrixTime * 1e9, affineTime * 1e9);
+        printf("    with its corners transformed too: Matrix %.1f ns, Affine2D %.1f ns\n", matrixCornerTime * 1e9, affineCornerTime * 1e9);
+    }
+    printf("(%g)\n", sum);
+    return 0;
+}
@@ -0,0 +1,265 @@
+/*
+    chunkCacheCheck
+
+    Scrolls a camera over every chunk of a 1024 x 1024 tile level (4096 chunks, which used to be 4 GiB of chunk
+    textures at 32 texels a tile) with ChunkedTileMap's cache on and GL stubbed (glStubs.h plus the texture and
+    framebuffer calls here). Every frame:
+        the map holds no more than CHUNK_CACHE_TEXTURES textures, and GL no more than the map says it does
+        every chunk on screen is drawn from a texture of its own that was last baked with that chunk's tiles
+    Once the pool is full no more textures may be made, standing still may bake nothing, a changed tile
+    has to rebake its chunk into the texture it already had, and going back to the start has to bake the
+    chunks there again since their textures went to other chunks. A pool shrunk with setCached has to stay
+    at the chunks on screen while there are more of them than it holds, and get down to its size after.
+    Anything else is printed and the exit code is 1.
+    Builds on its own, from this folder (only the GL headers are needed, no context):
+        c++ -O2 -DGL_GLEXT_PROTOTYPES -I../NYUCodebase -I/Library/Frameworks/SDL2.framework/Headers chunkCacheCheck.cpp ../NYUCodebase/ChunkedTileMap.cpp ../NYUCodebase/QuadMesh.cpp ../NYUCodebase/Matrix.cpp -o chunkCacheCheck -pthread
+*/
+
+#include "glStubs.h"
+#include "ChunkedTileMap.h"
+#include <stdio.h>
+#include <math.h>
+#include <set>
+
+#define LEVEL_TILES 1024
+#define SHEET_SPRITES 30
+// about what the game's camera sees, in tiles
+#define VIEW_WIDTH 48.0f
+#define VIEW_HEIGHT 27.0f
+#define SCROLL_STEP 4.0f
+#define SMALL_POOL 8
+
+// What the cache's textures and framebuffers hold, on top of glStubs.h
+struct CacheStubs {
+    GLuint nextName;
+    GLuint framebuffer;
+    std::set<GLuint> textures;
+    std::map<GLuint, GLuint> attached;
+    // the chunk each texture was last baked with
+    std::map<GLuint, int> bakedChunk;
+    // this frame's bakes, a clear of a texture and the draw after it
+    std::vector<std::pair<size_t, GLuint> > bakes;
+    int texturesMade;
+};
+
+static CacheStubs cache = CacheStubs();
+
+extern "C" {
+    
+void glGenTextures(GLsizei n, GLuint *textures) {
+    for (GLsizei i = 0; i < n; i++) {
+        textures[i] = ++cache.nextName;
+        cache.textures.insert(textures[i]);
+        cache.texturesMade++;
+    }
+}
+    
+void glDeleteTextures(GLsizei n, const GLuint *textures) {
+    for (GLsizei i = 0; i < n; i++) {
+        cache.textures.erase(textures[i]);
+        cache.bakedChunk.erase(textures[i]);
+    }
+}
+    
+void glGenFramebuffers(GLsizei n, GLuint *framebuffers) {
+    for (GLsizei i = 0; i < n; i++) {
+        framebuffers[i] = ++cache.nextName;
+    }
+}
+    
+void glDeleteFramebuffers(GLsizei n, const GLuint *framebuffers) {
+    for (GLsizei i = 0; i < n; i++) {
+        cache.attached.erase(framebuffers[i]);
+    }
+}
+    
+void glBindFramebuffer(GLenum, GLuint framebuffer) {
+    cache.framebuffer = framebuffer;
+}
+    
+void glFramebufferTexture2D(GLenum, GLenum, GLenum, GLuint texture, GLint) {
+    cache.attached[cache.framebuffer] = texture;
+}
+    
+void glClear(GLbitfield) {
+    if (cache.framebuffer) {
+        cache.bakes.push_back(std::make_pair(gl.draws.size(), cache.attached[cache.framebuffer]));
+    }
+}
+    
+const GLubyte *glGetString(GLenum) {
+    return (const GLubyte *)"GL_ARB_framebuffer_object";
+}
+    
+void glGetIntegerv(GLenum, GLint *data) {
+    data[0] = data[1] = data[2] = data[3] = 0;
+}
+    
+void glGetFloatv(GLenum, GLfloat *data) {
+    data[0] = data[1] = data[2] = data[3] = 0.0f;
+}
+    
+GLboolean glIsEnabled(GLenum) {
+    return GL_TRUE;
+}
+    
+void glTexImage2D(GLenum, GLint, GLint, GLsizei, GLsizei, GLint, GLenum, GLenum, const void *) {}
+void glTexParameteri(GLenum, GLenum, GLint) {}
+void glViewport(GLint, GLint, GLsizei, GLsizei) {}
+void glClearColor(GLfloat, GLfloat, GLfloat, GLfloat) {}
+void glEnable(GLenum) {}
+void glDisable(GLenum) {}
+    
+}
+
+// The chunk a draw covers, from the middle of the corners its indices use. Works for a chunk's tiles and its cache quad
+static int drawnChunk(const StubDraw &draw) {
+    float x = 0.0f, y = 0.0f;
+    for (size_t i = 0; i < draw.indices.size(); i++) {
+        x += draw.vertices[draw.indices[i]].x;
+        y += draw.vertices[draw.indices[i]].y;
+    }
+    x /= draw.indices.size();
+    y /= draw.indices.size();
+    return (int)floorf(-y / CHUNK_TILES) * (LEVEL_TILES / CHUNK_TILES) + (int)floorf(x / CHUNK_TILES);
+}
+
+// Draws the map with the camera centered on x, y and checks the frame, false if anything's off
+static bool drawFrame(ChunkedTileMap &map, ShaderProgram &program, float x, float y, float zoom, int maxTextures, std::set<int> &baked) {
+    gl.reset();
+    cache.bakes.clear();
+    Matrix modelMatrix;
+    Matrix viewMatrix;
+    viewMatrix.Translate(-x, -y, 0.0f);
+    Matrix projectionMatrix = Matrix::orthoProjection(-VIEW_WIDTH * zoom / 2.0f, VIEW_WIDTH * zoom / 2.0f, -VIEW_HEIGHT * zoom / 2.0f,
+                                                      VIEW_HEIGHT * zoom / 2.0f, -1.0f, 1.0f);
+    
+    // the bakes all come before the chunks get drawn on screen
+    map.draw(&program, 1, modelMatrix, viewMatrix, projectionMatrix);
+    size_t firstOnScreen = cache.bakes.size();
+    for (size_t i = 0; i < cache.bakes.size(); i++) {
+        if (cache.bakes[i].first != i) {
+            printf("At %g,%g: bake %d wasn't a single draw\n", x, y, (int)i);
+            return false;
+        }
+        if (gl.draws[i].textureID != 1) {
+            printf("At %g,%g: bake %d drew from texture %d, not the sprite sheet\n", x, y, (int)i, gl.draws[i].textureID);
+            return false;
+        }
+        cache.bakedChunk[cache.bakes[i].second] = drawnChunk(gl.draws[i]);
+    }
+    if (map.chunksBaked != (int)cache.bakes.size()) {
+        printf("At %g,%g: chunksBaked is %d, GL saw %d bakes\n", x, y, map.chunksBaked, (int)cache.bakes.size());
+        return false;
+    }
+    
+    if (map.cacheTextures() > std::max(maxTextures, map.chunksDrawn) || (int)cache.textures.size() != map.cacheTextures()) {
+        printf("At %g,%g: the map has %d textures, GL %d, with %d chunks on screen and room for %d\n", x, y, map.cacheTextures(),
+               (int)cache.textures.size(), map.chunksDrawn, maxTextures);
+        return false;
+    }
+    std::set<GLuint> used;
+    for (size_t i = firstOnScreen; i < gl.draws.size(); i++) {
+        const StubDraw &draw = gl.draws[i];
+        int chunk = drawnChunk(draw);
+        if (!cache.textures.count(draw.textureID) || used.count(draw.textureID) || cache.bakedChunk[draw.textureID] != chunk) {
+            printf("At %g,%g: chunk %d drawn from texture %d, which %s and was baked with chunk %d\n", x, y, chunk, draw.textureID,
+                   !cache.textures.count(draw.textureID) ? "doesn't exist" : used.count(draw.textureID) ? "another chunk used too" : "is alive",
+                   cache.bakedChunk.count(draw.textureID) ? cache.bakedChunk[draw.textureID] : -1);
+            return false;
+        }
+        used.insert(draw.textureID);
+        baked.insert(chunk);
+    }
+    if ((int)(gl.draws.size() - firstOnScreen) != map.chunksDrawn) {
+        printf("At %g,%g: %d cached chunk draws for %d chunks drawn\n", x, y, (int)(gl.draws.size() - firstOnScreen), map.chunksDrawn);
+        return false;
+    }
+    return true;
+}
+
+int main() {
+    ShaderProgram program("vertex_textured.glsl", "fragment_textured.glsl");
+    std::vector<int> tiles(LEVEL_TILES * LEVEL_TILES);
+    for (size_t i = 0; i < tiles.size(); i++) {
+        tiles[i] = (int)(i * 7 % (SHEET_SPRITES * SHEET_SPRITES));
+    }
+    ChunkedTileMap map(1.0f, SHEET_SPRITES, SHEET_SPRITES);
+    map.useTiles(tiles.data(), LEVEL_TILES, LEVEL_TILES);
+    map.setCached(true);
+    if (!map.cached()) {
+        printf("The cache didn't turn on\n");
+        return 1;
+    }
+    
+    // row by row, like walking the whole level
+    std::set<int> seen;
+    int peakTextures = 0, frames = 0;
+    for (float y = -VIEW_HEIGHT / 2.0f; y > -LEVEL_TILES; y -= CHUNK_TILES) {
+        for (float x = VIEW_WIDTH / 2.0f; x < LEVEL_TILES; x += SCROLL_STEP) {
+            if (!drawFrame(map, program, x, y, 1.0f, CHUNK_CACHE_TEXTURES, seen)) {
+                return 1;
+            }
+            peakTextures = std::max(peakTextures, map.cacheTextures());
+            frames++;
+        }
+    }
+    int chunks = (LEVEL_TILES / CHUNK_TILES) * (LEVEL_TILES / CHUNK_TILES);
+    if ((int)seen.size() != chunks || cache.texturesMade != CHUNK_CACHE_TEXTURES) {
+        printf("Scrolling over the level: %d of %d chunks drawn, %d textures made for a pool of %d\n", (int)seen.size(), chunks,
+               cache.texturesMade, CHUNK_CACHE_TEXTURES);
+        return 1;
+    }
+    printf("%d frames over %d chunks: at most %d textures (%.0f MiB), %d made in all, every chunk drawn from its own\n", frames, chunks,
+           peakTextures, peakTextures * (double)map.cacheBytes() / map.cacheTextures() / (1 << 20), cache.texturesMade);
+    
+    // standing still bakes nothing, a changed tile rebakes into the texture its chunk already has
+    float x = LEVEL_TILES - VIEW_WIDTH, y = -LEVEL_TILES + VIEW_HEIGHT;
+    std::set<int> ignored;
+    if (!drawFrame(map, program, x, y, 1.0f, CHUNK_CACHE_TEXTURES, ignored) ||
+        !drawFrame(map, program, x, y, 1.0f, CHUNK_CACHE_TEXTURES, ignored) || map.chunksBaked != 0) {
+        printf("Standing still baked %d chunks\n", map.chunksBaked);
+        return 1;
+    }
+    map.setTile((int)x, (int)-y, 5);
+    if (!drawFrame(map, program, x, y, 1.0f, CHUNK_CACHE_TEXTURES, ignored) || map.chunksBaked != 1 || map.chunksEvicted != 0 ||
+        cache.texturesMade != CHUNK_CACHE_TEXTURES) {
+        printf("A changed tile baked %d chunks and took %d textures from others\n", map.chunksBaked, map.chunksEvicted);
+        return 1;
+    }
+    
+    // the start of the level went out of the pool long ago
+    if (!drawFrame(map, program, VIEW_WIDTH / 2.0f, -VIEW_HEIGHT / 2.0f, 1.0f, CHUNK_CACHE_TEXTURES, ignored) ||
+        map.chunksBaked != map.chunksDrawn || map.chunksEvicted != map.chunksDrawn) {
+        printf("Back at the start: %d chunks drawn, %d baked, %d evicted\n", map.chunksDrawn, map.chunksBaked, map.chunksEvicted);
+        return 1;
+    }
+    printf("standing still bakes nothing, a changed tile rebakes 1, going back to the start rebakes all %d on screen\n", map.chunksDrawn);
+    
+    // a pool smaller than the screen keeps what's on screen, and shrinks to size once the camera zooms in
+    map.setCached(true, 32, SMALL_POOL);
+    if (!drawFrame(map, program, VIEW_WIDTH, -VIEW_HEIGHT, 1.0f, SMALL_POOL, ignored) || map.cacheTextures() != map.chunksDrawn) {
+        printf("A pool of %d with %d chunks on screen has %d textures\n", SMALL_POOL, map.chunksDrawn, map.cacheTextures());
+        return 1;
+    }
+    int wide = map.chunksDrawn;
+    if (!drawFrame(map, program, VIEW_WIDTH, -VIEW_HEIGHT, 0.25f, SMALL_POOL, ignored) || map.cacheTextures() != SMALL_POOL) {
+        printf("A pool of %d zoomed in to %d chunks has %d textures\n", SMALL_POOL, map.chunksDrawn, map.cacheTextures());
+        return 1;
+    }
+    printf("a pool of %d holds the %d chunks on screen, and %d after zooming in to %d\n", SMALL_POOL, wide, map.cacheTextures(), map.chunksDrawn);
+    
+    // and scrolling with it can't take the texture of a chunk that's still on screen
+    for (float scrolled = VIEW_WIDTH; scrolled < VIEW_WIDTH + 4 * CHUNK_TILES; scrolled += SCROLL_STEP) {
+        if (!drawFrame(map, program, scrolled, -VIEW_HEIGHT, 1.0f, SMALL_POOL, ignored)) {
+            return 1;
+        }
+    }
+    
+    map.clear();
+    if (!cache.textures.empty()) {
+        printf("clear() left %d textures\n", (int)cache.textures.size());
+        return 1;
+    }
+    return 0;
+}
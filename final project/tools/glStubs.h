@@ -0,0 +1,155 @@
+/*
+    GL calls for the headless checks, instead of a context. Include it in exactly one file of a tool and
+    don't link ShaderProgram.cpp or the OpenGL framework, these take their place.
+    Buffers keep a copy of what glBufferData gave them, and every glDrawElements is written down as the
+    indices it used and the vertices they point at, read back through the attribute pointers the way GL
+    would. Positions are attribute 0 and texture coordinates attribute 1.
+*/
+
+#pragma once
+
+#include "ShaderProgram.h"
+#include <algorithm>
+#include <map>
+#include <vector>
+
+// One corner as GL would see it after the attribute formats are applied
+struct StubVertex {
+    float x, y, u, v;
+};
+
+struct StubDraw {
+    GLuint textureID;
+    std::vector<GLushort> indices;
+    // everything from the first attribute pointer up to the highest index
+    std::vector<StubVertex> vertices;
+};
+
+struct StubAttribute {
+    GLint size;
+    GLenum type;
+    GLboolean normalized;
+    GLsizei stride;
+    GLuint buffer;
+    const char *pointer;
+};
+
+struct GLStubs {
+    std::map<GLuint, std::vector<char> > buffers;
+    GLuint nextBuffer;
+    GLuint arrayBuffer;
+    GLuint elementBuffer;
+    GLuint texture;
+    StubAttribute attributes[2];
+    std::vector<StubDraw> draws;
+    int textureBinds;
+    int bufferUploads;
+    
+    // forgets the draws and counters, buffers stay
+    void reset() {
+        draws.clear();
+        textureBinds = 0;
+        bufferUploads = 0;
+    }
+};
+
+static GLStubs gl = GLStubs();
+
+static const char *bufferData(GLuint buffer, const char *pointer) {
+    if (!buffer) {
+        return pointer;
+    }
+    return gl.buffers[buffer].data() + (size_t)pointer;
+}
+
+static float readComponent(const StubAttribute &attribute, const char *vertex, int component) {
+    if (attribute.type == GL_FLOAT) {
+        return ((const GLfloat *)vertex)[component];
+    } else if (attribute.type == GL_SHORT) {
+        GLshort value = ((const GLshort *)vertex)[component];
+        return attribute.normalized ? value / 32767.0f : value;
+    } else if (attribute.type == GL_UNSIGNED_SHORT) {
+        GLushort value = ((const GLushort *)vertex)[component];
+        return attribute.normalized ? value / 65535.0f : value;
+    }
+    return 0.0f;
+}
+
+extern "C" {
+    
+void glGenBuffers(GLsizei n, GLuint *buffers) {
+    for (GLsizei i = 0; i < n; i++) {
+        buffers[i] = ++gl.nextBuffer;
+        gl.buffers[buffers[i]];
+    }
+}
+    
+void glDeleteBuffers(GLsizei n, const GLuint *buffers) {
+    for (GLsizei i = 0; i < n; i++) {
+        gl.buffers.erase(buffers[i]);
+    }
+}
+    
+void glBindBuffer(GLenum target, GLuint buffer) {
+    if (target == GL_ARRAY_BUFFER) {
+        gl.arrayBuffer = buffer;
+    } else if (target == GL_ELEMENT_ARRAY_BUFFER) {
+        gl.elementBuffer = buffer;
+    }
+}
+    
+void glBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum) {
+    std::vector<char> &buffer = gl.buffers[target == GL_ARRAY_BUFFER ? gl.arrayBuffer : gl.elementBuffer];
+    buffer.assign((const char *)data, (const char *)data + size);
+    gl.bufferUploads++;
+}
+    
+void glBindTexture(GLenum, GLuint texture) {
+    gl.texture = texture;
+    gl.textureBinds++;
+}
+    
+void glEnableVertexAttribArray(GLuint) {}
+void glDisableVertexAttribArray(GLuint) {}
+    
+void glVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer) {
+    if (index < 2) {
+        StubAttribute attribute = {size, type, normalized, stride, gl.arrayBuffer, (const char *)pointer};
+        gl.attributes[index] = attribute;
+    }
+}
+    
+void glDrawElements(GLenum, GLsizei count, GLenum, const void *indices) {
+    StubDraw draw;
+    draw.textureID = gl.texture;
+    const GLushort *source = (const GLushort *)bufferData(gl.elementBuffer, (const char *)indices);
+    draw.indices.assign(source, source + count);
+    int last = 0;
+    for (GLsizei i = 0; i < count; i++) {
+        last = std::max(last, (int)source[i]);
+    }
+    const StubAttribute &position = gl.attributes[0];
+    const StubAttribute &texCoord = gl.attributes[1];
+    const char *positions = bufferData(position.buffer, position.pointer);
+    const char *texCoords = bufferData(texCoord.buffer, texCoord.pointer);
+    for (int i = 0; i <= last && count > 0; i++) {
+        StubVertex vertex;
+        vertex.x = readComponent(position, positions + i * position.stride, 0);
+        vertex.y = readComponent(position, positions + i * position.stride, 1);
+        vertex.u = readComponent(texCoord, texCoords + i * texCoord.stride, 0);
+        vertex.v = readComponent(texCoord, texCoords + i * texCoord.stride, 1);
+        draw.vertices.push_back(vertex);
+    }
+    gl.draws.push_back(draw);
+}
+    
+}
+
+// Just enough of a program for the attributes and the counters, nothing gets compiled
+ShaderProgram::ShaderProgram(const char *, const char *) : programID(1), projectionMatrixUniform(0), modelMatrixUniform(1),
+    viewMatrixUniform(2), positionAttribute(0), texCoordAttribute(1), vertexShader(0), fragmentShader(0) {}
+ShaderProgram::~ShaderProgram() {}
+void ShaderProgram::use() {}
+void ShaderProgram::setModelMatrix(const Matrix &) {}
+void ShaderProgram::setProjectionMatrix(const Matrix &) {}
+void ShaderProgram::setViewMatrix(const Matrix &) {}
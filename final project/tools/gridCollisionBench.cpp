@@ -0,0 +1,130 @@
+/*
+    gridCollisionBench [entities]
+
+    Checks gridContacts against the full level scan Entity::collidesWith used to do, once per side, on random
+    32x32 (the game's own size), 64x64 and 256x256 levels, then times both. Anything that doesn't agree is printed and the exit code is 1.
+    Builds on its own, from this folder:
+        c++ -O2 -I../NYUCodebase gridCollisionBench.cpp ../NYUCodebase/GridCollision.cpp -o gridCollisionBench
+*/
+
+#include "GridCollision.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+#define TILE_SIZE 0.5f
+
+// The old collidesWith, every tile in the level for one side. 0 bottom,1 top,2 left,3 right
+static bool scanCollides(int area, const std::vector<std::vector<int>> &grid, float x, float y, float width, float height) {
+    bool collided = false;
+    float playerTop = y + height / 2.0f;
+    float playerBot = y - height / 2.0f;
+    float playerLeft = x - width / 2.0f;
+    float playerRight = x + width / 2.0f;
+    
+    for(int gridY = 0; gridY < (int)grid[0].size(); gridY++){
+        for(int gridX = 0; gridX < (int)grid.size(); gridX++){
+            if (grid[gridX][gridY] == 1){
+                float tileRight = gridX * TILE_SIZE + TILE_SIZE;
+                float tileLeft = gridX * TILE_SIZE;
+                float tileTop = gridY * -1.0 * TILE_SIZE + TILE_SIZE;
+                float tileBot = gridY * -1.0 * TILE_SIZE;
+                if(area == 0 && playerBot < tileTop && playerBot > tileBot && playerRight <= tileRight && playerLeft >= tileLeft)
+                    collided = true;
+                if(area == 1 && playerTop > tileBot && playerTop < tileTop && playerRight <= tileRight && playerLeft >= tileLeft)
+                    collided = true;
+                if(area == 2 && playerLeft < tileRight && playerRight > tileRight && playerTop <= tileTop && playerBot >= tileBot)
+                    collided = true;
+                if(area == 3 && playerRight > tileLeft && playerLeft < tileLeft && playerTop <= tileTop && playerBot >= tileBot)
+                    collided = true;
+            }
+        }
+    }
+    return collided;
+}
+
+struct Box {
+    float x, y, width, height;
+};
+
+static float randomFloat() {
+    return (float)rand() / RAND_MAX;
+}
+
+// Entities sit on a quarter tile grid with tile or half tile sides, the way they line up with the level in the game,
+// so plenty of them are touching something. A few hang off the edges of the level
+static std::vector<Box> randomBoxes(int count, int side) {
+    std::vector<Box> boxes(count);
+    for (int i = 0; i < count; i++) {
+        boxes[i].x = (rand() % (side * 4 + 8) - 4) * TILE_SIZE / 4.0f;
+        boxes[i].y = -(rand() % (side * 4 + 8) - 4) * TILE_SIZE / 4.0f;
+        boxes[i].width = rand() % 2 ? TILE_SIZE : TILE_SIZE / 2.0f;
+        boxes[i].height = rand() % 2 ? TILE_SIZE : TILE_SIZE * (0.5f + randomFloat());
+    }
+    return boxes;
+}
+
+static double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool run(int side, int entities) {
+    std::vector<std::vector<int>> grid(side, std::vector<int>(side, 0));
+    for (int x = 0; x < side; x++) {
+        for (int y = 0; y < side; y++) {
+            grid[x][y] = rand() % 3 == 0 ? 1 : 0;
+        }
+    }
+    std::vector<Box> boxes = randomBoxes(entities, side);
+    
+    // the scan is slow enough on big levels that it only gets a slice of the entities
+    int scanned = entities < 2000 ? entities : 2000;
+    std::vector<GridContacts> expected(scanned);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < scanned; i++) {
+        const Box &b = boxes[i];
+        expected[i].bottom = scanCollides(0, grid, b.x, b.y, b.width, b.height);
+        expected[i].top = scanCollides(1, grid, b.x, b.y, b.width, b.height);
+        expected[i].left = scanCollides(2, grid, b.x, b.y, b.width, b.height);
+        expected[i].right = scanCollides(3, grid, b.x, b.y, b.width, b.height);
+    }
+    double scanTime = seconds(start) / scanned;
+    
+    for (int i = 0; i < scanned; i++) {
+        const Box &b = boxes[i];
+        GridContacts found = gridContacts(grid, TILE_SIZE, b.x, b.y, b.width, b.height);
+        if (found.bottom != expected[i].bottom || found.top != expected[i].top || found.left != expected[i].left || found.right != expected[i].right) {
+            printf("%dx%d: box at %g,%g (%gx%g) touches %d%d%d%d, the scan says %d%d%d%d\n", side, side, b.x, b.y, b.width, b.height,
+                   found.bottom, found.top, found.left, found.right, expected[i].bottom, expected[i].top, expected[i].left, expected[i].right);
+            return false;
+        }
+    }
+    
+    // summed so the timed calls can't be thrown away
+    int touching = 0;
+    int repeats = 20;
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; r++) {
+        for (int i = 0; i < entities; i++) {
+            const Box &b = boxes[i];
+            GridContacts found = gridContacts(grid, TILE_SIZE, b.x, b.y, b.width, b.height);
+            touching += found.bottom + found.top + found.left + found.right;
+        }
+    }
+    double gridTime = seconds(start) / ((double)entities * repeats);
+    
+    printf("%dx%d, %d entities: full scan %.0f ns, tiles under the box %.1f ns a query (%d of %d sides touching)\n",
+           side, side, entities, scanTime * 1e9, gridTime * 1e9, touching / repeats, entities * 4);
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    int entities = argc > 1 ? atoi(argv[1]) : 100000;
+    if (entities < 1) {
+        printf("usage: gridCollisionBench [entities]\n");
+        return 1;
+    }
+    srand(1);
+    bool ok = run(32, entities) && run(64, entities) && run(256, entities);
+    return ok ? 0 : 1;
+}
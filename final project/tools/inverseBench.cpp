@@ -0,0 +1,171 @@
+/*
+    inverseBench
+
+    Property checks for Matrix::inverse() on every kind of matrix structure() tells apart: random translations,
+    translations with a scale, rotations (Roll, Pitch and Yaw) with a translation, the same with a scale mixed in,
+    and projections. Each one has to be classified as that kind, every one of its inverse() calls has to have taken
+    that kind's path (Matrix::inverseCounts, which needs MATRIX_COUNT_INVERSES), and its inverse has to give back the
+    identity when multiplied with it and agree with generalInverse(). Then times inverse() against generalInverse()
+    for each kind. Build it again with -DMATRIX_NO_SIMD added to check the plain C++ paths NEON builds use too.
+    Anything that fails is printed and the exit code is 1.
+    Builds on its own, from this folder:
+        c++ -O2 -DMATRIX_COUNT_INVERSES -I../NYUCodebase inverseBench.cpp ../NYUCodebase/Matrix.cpp -o inverseBench -pthread
+*/
+
+#include "Matrix.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+
+#if !defined(MATRIX_COUNT_INVERSES)
+#error "Build with -DMATRIX_COUNT_INVERSES so Matrix.cpp counts the path every inverse() takes"
+#endif
+
+#define TOLERANCE 0.0001f
+#define MATRICES 4096
+#define CALLS 2000000
+
+static float randomFloat(float low, float high) {
+    return low + (high - low) * rand() / RAND_MAX;
+}
+
+static float randomAngle() {
+    return randomFloat(-3.14159f, 3.14159f);
+}
+
+// Scales that can't come out as 1, which would make them a different kind
+static float randomScale() {
+    return (rand() % 2 ? 1.0f : -1.0f) * randomFloat(0.25f, 0.9f) * (rand() % 2 ? 1.0f : 4.0f);
+}
+
+static Matrix randomMatrix(Matrix::Structure kind) {
+    Matrix matrix;
+    switch (kind) {
+        case Matrix::TRANSLATION:
+            matrix.Translate(randomFloat(-100.0f, 100.0f), randomFloat(-100.0f, 100.0f), randomFloat(-10.0f, 10.0f));
+            break;
+        case Matrix::SCALE_TRANSLATION:
+            matrix.Translate(randomFloat(-100.0f, 100.0f), randomFloat(-100.0f, 100.0f), 0.0f);
+            matrix.Scale(randomScale(), randomScale(), randomScale());
+            break;
+        case Matrix::RIGID:
+            matrix.Translate(randomFloat(-100.0f, 100.0f), randomFloat(-100.0f, 100.0f), randomFloat(-10.0f, 10.0f));
+            matrix.Roll(randomAngle());
+            if (rand() % 2) {
+                matrix.Pitch(randomAngle());
+                matrix.Yaw(randomAngle());
+            }
+            break;
+        case Matrix::AFFINE:
+            matrix.Translate(randomFloat(-100.0f, 100.0f), randomFloat(-100.0f, 100.0f), 0.0f);
+            matrix.Roll(randomAngle());
+            matrix.Scale(randomScale(), randomScale(), 1.0f);
+            break;
+        case Matrix::GENERAL:
+            if (rand() % 2) {
+                matrix.setPerspectiveProjection(randomFloat(0.5f, 1.5f), randomFloat(1.0f, 2.0f), randomFloat(0.1f, 1.0f), randomFloat(10.0f, 100.0f));
+            } else {
+                matrix.setOrthoProjection(-randomFloat(1.0f, 10.0f), randomFloat(1.0f, 10.0f), -randomFloat(1.0f, 10.0f), randomFloat(1.0f, 10.0f), -1.0f, 1.0f);
+                // ortho on its own is a scale and a translation, a projection in the bottom row makes it general
+                matrix.m[2][3] = -randomFloat(0.1f, 1.0f);
+            }
+            break;
+    }
+    return matrix;
+}
+
+static const char *kindName(Matrix::Structure kind) {
+    const char *names[] = {"translation", "scale + translation", "rigid", "affine", "general"};
+    return names[kind];
+}
+
+// Matrix::inverseCounts since the last call, and starts counting again
+static void takeCounts(int *counts) {
+    for (int kind = Matrix::TRANSLATION; kind <= Matrix::GENERAL; kind++) {
+        counts[kind] = Matrix::inverseCounts[kind];
+        Matrix::inverseCounts[kind] = 0;
+    }
+}
+
+static float worst(const Matrix &a, const Matrix &b) {
+    float error = 0.0f;
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            error = fmaxf(error, fabsf(a.m[i][j] - b.m[i][j]) / fmaxf(1.0f, fabsf(b.m[i][j])));
+        }
+    }
+    return error;
+}
+
+static double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+#if defined(MATRIX_NO_SIMD)
+    printf("plain C++ build\n");
+#else
+    printf("inverse() as Matrix.cpp picked it for this machine\n");
+#endif
+    int counts[Matrix::GENERAL + 1];
+    srand(1);
+    Matrix identity;
+    if (identity.structure() != Matrix::TRANSLATION || worst(identity.inverse(), identity) != 0.0f) {
+        printf("The identity should be a translation and its own inverse\n");
+        return 1;
+    }
+    
+    float sum = 0.0f;
+    for (int kind = Matrix::TRANSLATION; kind <= Matrix::GENERAL; kind++) {
+        std::vector<Matrix> matrices(MATRICES);
+        float inverseError = 0.0f, generalError = 0.0f;
+        takeCounts(counts);
+        for (int i = 0; i < MATRICES; i++) {
+            Matrix &matrix = matrices[i];
+            matrix = randomMatrix((Matrix::Structure)kind);
+            if (matrix.structure() != kind) {
+                printf("A %s matrix was taken for %s\n", kindName((Matrix::Structure)kind), kindName(matrix.structure()));
+                return 1;
+            }
+            Matrix inverse = matrix.inverse();
+            // inverse * matrix and matrix * inverse both have to be the identity
+            inverseError = fmaxf(inverseError, fmaxf(worst(inverse * matrix, identity), worst(matrix * inverse, identity)));
+            generalError = fmaxf(generalError, worst(inverse, matrix.generalInverse()));
+        }
+        takeCounts(counts);
+        if (counts[kind] != MATRICES) {
+            printf("%s: only %d of %d inverse() calls took its path, the rest went", kindName((Matrix::Structure)kind), counts[kind], MATRICES);
+            for (int other = Matrix::TRANSLATION; other <= Matrix::GENERAL; other++) {
+                if (other != kind && counts[other]) {
+                    printf(" %d %s", counts[other], kindName((Matrix::Structure)other));
+                }
+            }
+            printf("\n");
+            return 1;
+        }
+        if (inverseError > TOLERANCE || generalError > TOLERANCE) {
+            printf("%s: inverse() is off by %g from the identity and %g from generalInverse()\n", kindName((Matrix::Structure)kind), inverseError, generalError);
+            return 1;
+        }
+    
+        // a bit of every result gets summed, so none of the calls can be skipped
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int i = 0; i < CALLS; i++) {
+            Matrix inverse = matrices[i & (MATRICES - 1)].inverse();
+            sum += inverse.m[3][i & 3];
+        }
+        double inverseTime = seconds(start) / CALLS;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < CALLS; i++) {
+            Matrix inverse = matrices[i & (MATRICES - 1)].generalInverse();
+            sum += inverse.m[3][i & 3];
+        }
+        double generalTime = seconds(start) / CALLS;
+        printf("%-20s %d/%d through its path, inverse() %6.2f ns, generalInverse() %6.2f ns (off by at most %.1g)\n",
+               kindName((Matrix::Structure)kind), counts[kind], MATRICES, inverseTime * 1e9, generalTime * 1e9, inverseError);
+    }
+    printf("(%g)\n", sum);
+    return 0;
+}
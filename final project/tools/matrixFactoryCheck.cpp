@@ -0,0 +1,138 @@
+/*
+    matrixFactoryCheck
+
+    The static_asserts in Matrix.cpp only pin the compile time factories to a few values worked out by hand.
+    This builds every one of them on random inputs and compares all 16 floats with what the runtime set*
+    function it stands in for writes into an identity matrix:
+        translation            setPosition
+        scaling                setScale
+        orthoProjection        setOrthoProjection
+        perspectiveProjection  setPerspectiveProjection, fov all the way up to just under pi
+    and Matrix::tangent, the Taylor series perspectiveProjection uses, against tanf from -pi/2 to pi/2.
+    Reports the worst relative error of each. Anything past TOLERANCE is printed and the exit code is 1.
+    Builds on its own, from this folder:
+        c++ -O2 -I../NYUCodebase matrixFactoryCheck.cpp ../NYUCodebase/Matrix.cpp -o matrixFactoryCheck -pthread
+*/
+
+#include "Matrix.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define SAMPLES 100000
+// relative, a few float ulps
+#define TOLERANCE 4e-6f
+#define PI 3.14159265358979f
+
+static float randomFloat(float low, float high) {
+    return low + (high - low) * rand() / RAND_MAX;
+}
+
+static float relativeError(float a, float b) {
+    float difference = fabsf(a - b);
+    if (difference == 0.0f) {
+        return 0.0f;
+    }
+    return difference / fmaxf(fabsf(a), fabsf(b));
+}
+
+// Worst relative error over the 16 floats, and which one it was
+static float compare(const Matrix &compileTime, const Matrix &runtime, int &worst) {
+    float error = 0.0f;
+    worst = 0;
+    for (int i = 0; i < 16; i++) {
+        float e = relativeError(compileTime.ml[i], runtime.ml[i]);
+        if (e > error) {
+            error = e;
+            worst = i;
+        }
+    }
+    return error;
+}
+
+// Keeps the worst error of a factory and prints the inputs of the first sample past TOLERANCE
+struct Result {
+    const char *name;
+    float worst;
+    bool failed;
+    
+    Result(const char *name) : name(name), worst(0.0f), failed(false) {}
+    
+    void add(const Matrix &compileTime, const Matrix &runtime, const float *inputs, int inputCount) {
+        int element;
+        float error = compare(compileTime, runtime, element);
+        worst = fmaxf(worst, error);
+        if (error > TOLERANCE && !failed) {
+            failed = true;
+            printf("%s(", name);
+            for (int i = 0; i < inputCount; i++) {
+                printf(i ? ", %.9g" : "%.9g", inputs[i]);
+            }
+            printf(") ml[%d] is %.9g, the runtime one %.9g\n", element, compileTime.ml[element], runtime.ml[element]);
+        }
+    }
+    
+    bool report() const {
+        printf("    %-22s worst relative error %.3g\n", name, worst);
+        return !failed;
+    }
+};
+
+int main() {
+    srand(1);
+    
+    Result translation("translation");
+    Result scaling("scaling");
+    Result ortho("orthoProjection");
+    Result perspective("perspectiveProjection");
+    for (int i = 0; i < SAMPLES; i++) {
+        float position[3] = {randomFloat(-1000.0f, 1000.0f), randomFloat(-1000.0f, 1000.0f), randomFloat(-1000.0f, 1000.0f)};
+        Matrix runtime;
+        runtime.setPosition(position[0], position[1], position[2]);
+        translation.add(Matrix::translation(position[0], position[1], position[2]), runtime, position, 3);
+    
+        float scale[3] = {randomFloat(-100.0f, 100.0f), randomFloat(-100.0f, 100.0f), randomFloat(-100.0f, 100.0f)};
+        runtime.identity();
+        runtime.setScale(scale[0], scale[1], scale[2]);
+        scaling.add(Matrix::scaling(scale[0], scale[1], scale[2]), runtime, scale, 3);
+    
+        // left < right and so on, with the odd box nowhere near the origin
+        float left = randomFloat(-1000.0f, 1000.0f), bottom = randomFloat(-1000.0f, 1000.0f), zNear = randomFloat(-100.0f, 100.0f);
+        float box[6] = {left, left + randomFloat(0.01f, 2000.0f), bottom, bottom + randomFloat(0.01f, 2000.0f), zNear, zNear + randomFloat(0.01f, 200.0f)};
+        runtime.identity();
+        runtime.setOrthoProjection(box[0], box[1], box[2], box[3], box[4], box[5]);
+        ortho.add(Matrix::orthoProjection(box[0], box[1], box[2], box[3], box[4], box[5]), runtime, box, 6);
+    
+        // a tenth of the fovs crowd up against pi, where the tangent runs off to infinity
+        float fov = i % 10 == 0 ? PI - powf(10.0f, randomFloat(-3.0f, -1.0f)) : randomFloat(0.01f, PI - 0.001f);
+        float zClose = randomFloat(0.01f, 10.0f);
+        float lens[4] = {fov, randomFloat(0.25f, 4.0f), zClose, zClose + randomFloat(0.1f, 1000.0f)};
+        runtime.identity();
+        runtime.setPerspectiveProjection(lens[0], lens[1], lens[2], lens[3]);
+        perspective.add(Matrix::perspectiveProjection(lens[0], lens[1], lens[2], lens[3]), runtime, lens, 4);
+    }
+    
+    // the series against tanf on its own, evenly over the range plus right up against pi/2
+    float tangentWorst = 0.0f;
+    bool tangentOk = true;
+    for (int i = 0; i <= SAMPLES; i++) {
+        float angle = i < SAMPLES / 2 ? -PI / 2.0f + 0.0005f + (PI - 0.001f) * i / (SAMPLES / 2) : PI / 2.0f - powf(10.0f, randomFloat(-3.0f, -0.5f));
+        float error = relativeError(Matrix::tangent(angle), tanf(angle));
+        tangentWorst = fmaxf(tangentWorst, error);
+        if (error > TOLERANCE && tangentOk) {
+            tangentOk = false;
+            printf("tangent(%.9g) is %.9g, tanf %.9g\n", angle, Matrix::tangent(angle), tanf(angle));
+        }
+    }
+    
+    printf("%d random inputs each, against the runtime set* functions\n", SAMPLES);
+    bool ok = translation.report();
+    ok = scaling.report() && ok;
+    ok = ortho.report() && ok;
+    ok = perspective.report() && ok;
+    printf("    %-22s worst relative error %.3g against tanf\n", "tangent", tangentWorst);
+    if (!ok || !tangentOk) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,178 @@
+/*
+    matrixKernelBench
+
+    Checks Matrix's multiply, transform and general inverse against plain double precision versions on random
+    matrices, then reports how long each takes a call. Whichever SIMD path Matrix.cpp picks for this machine is the
+    one being tested, build it again with -DMATRIX_NO_SIMD added for the plain C++ numbers.
+    Anything outside the tolerance is printed and the exit code is 1.
+    Builds on its own, from this folder:
+        c++ -O2 -I../NYUCodebase matrixKernelBench.cpp ../NYUCodebase/Matrix.cpp -o matrixKernelBench -pthread
+*/
+
+#include "Matrix.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+
+#define CALLS 1000000
+
+static float randomFloat(float low, float high) {
+    return low + (high - low) * rand() / RAND_MAX;
+}
+
+// Random entries with a heavy diagonal, so the inverse is well behaved and float error stays small
+static Matrix randomMatrix() {
+    Matrix matrix;
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            matrix.m[i][j] = randomFloat(-1.0f, 1.0f) + (i == j ? 4.0f : 0.0f);
+        }
+    }
+    return matrix;
+}
+
+// The same maths as Matrix, m[column][row], with doubles
+static void referenceMultiply(const Matrix &m1, const Matrix &m2, double r[4][4]) {
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            r[i][j] = 0.0;
+            for (int k = 0; k < 4; k++) {
+                r[i][j] += (double)m1.m[i][k] * m2.m[k][j];
+            }
+        }
+    }
+}
+
+static void referenceTransform(const Matrix &matrix, const float *in, double *out) {
+    for (int j = 0; j < 4; j++) {
+        out[j] = 0.0;
+        for (int i = 0; i < 4; i++) {
+            out[j] += (double)matrix.m[i][j] * in[i];
+        }
+    }
+}
+
+// Gauss-Jordan with partial pivoting, a different way to the cofactors Matrix uses
+static void referenceInverse(const Matrix &matrix, double r[4][4]) {
+    double a[4][8];
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            a[i][j] = matrix.m[i][j];
+            a[i][j + 4] = i == j ? 1.0 : 0.0;
+        }
+    }
+    for (int c = 0; c < 4; c++) {
+        int pivot = c;
+        for (int i = c + 1; i < 4; i++) {
+            if (fabs(a[i][c]) > fabs(a[pivot][c])) {
+                pivot = i;
+            }
+        }
+        for (int j = 0; j < 8; j++) {
+            double t = a[c][j];
+            a[c][j] = a[pivot][j];
+            a[pivot][j] = t;
+        }
+        double scale = 1.0 / a[c][c];
+        for (int j = 0; j < 8; j++) {
+            a[c][j] *= scale;
+        }
+        for (int i = 0; i < 4; i++) {
+            if (i != c) {
+                double factor = a[i][c];
+                for (int j = 0; j < 8; j++) {
+                    a[i][j] -= factor * a[c][j];
+                }
+            }
+        }
+    }
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            r[i][j] = a[i][j + 4];
+        }
+    }
+}
+
+static double worst(const Matrix &matrix, double r[4][4]) {
+    double error = 0.0;
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            error = fmax(error, fabs(matrix.m[i][j] - r[i][j]) / fmax(1.0, fabs(r[i][j])));
+        }
+    }
+    return error;
+}
+
+static double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+#if defined(MATRIX_NO_SIMD)
+    printf("plain C++ kernels\n");
+#else
+    printf("kernels as Matrix.cpp picked them for this machine\n");
+#endif
+    srand(1);
+    std::vector<Matrix> matrices(1024);
+    for (size_t i = 0; i < matrices.size(); i++) {
+        matrices[i] = randomMatrix();
+    }
+    
+    double multiplyError = 0.0, transformError = 0.0, inverseError = 0.0;
+    for (size_t i = 0; i < matrices.size(); i++) {
+        const Matrix &m1 = matrices[i];
+        const Matrix &m2 = matrices[(i + 1) % matrices.size()];
+        double r[4][4];
+        referenceMultiply(m1, m2, r);
+        multiplyError = fmax(multiplyError, worst(m1 * m2, r));
+    
+        float in[4] = {randomFloat(-10.0f, 10.0f), randomFloat(-10.0f, 10.0f), randomFloat(-10.0f, 10.0f), 1.0f};
+        float out[4];
+        double expected[4];
+        m1.transform(in, out);
+        referenceTransform(m1, in, expected);
+        for (int j = 0; j < 4; j++) {
+            transformError = fmax(transformError, fabs(out[j] - expected[j]) / fmax(1.0, fabs(expected[j])));
+        }
+    
+        referenceInverse(m1, r);
+        inverseError = fmax(inverseError, worst(m1.generalInverse(), r));
+    }
+    printf("worst relative error: multiply %.2g, transform %.2g, inverse %.2g\n", multiplyError, transformError, inverseError);
+    if (multiplyError > 1e-6 || transformError > 1e-6 || inverseError > 1e-5) {
+        printf("outside the tolerance\n");
+        return 1;
+    }
+    
+    // a bit of every result gets summed, so none of the calls can be skipped
+    size_t mask = matrices.size() - 1;
+    float sum = 0.0f;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < CALLS; i++) {
+        Matrix product = matrices[i & mask] * matrices[(i + 1) & mask];
+        sum += product.m[i & 3][(i >> 2) & 3];
+    }
+    double multiplyTime = seconds(start) / CALLS;
+    
+    float point[4] = {1.0f, 2.0f, 3.0f, 1.0f};
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < CALLS; i++) {
+        float out[4];
+        matrices[i & mask].transform(point, out);
+        sum += out[i & 3];
+    }
+    double transformTime = seconds(start) / CALLS;
+    
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < CALLS; i++) {
+        Matrix inverse = matrices[i & mask].generalInverse();
+        sum += inverse.m[i & 3][(i >> 2) & 3];
+    }
+    double inverseTime = seconds(start) / CALLS;
+    
+    printf("multiply %.2f ns, transform %.2f ns, inverse %.2f ns a call (%g)\n", multiplyTime * 1e9, transformTime * 1e9, inverseTime * 1e9, sum);
+    return 0;
+}
@@ -0,0 +1,169 @@
+/*
+    quadMeshCheck
+
+    Builds a small grid of tiles with QuadMesh the way ChunkedTileMap::buildChunk does for Map::createMap
+    (a quad per tile at x, -y in tiles, its sprite's corner of a 30 x 30 sheet), in every QuadFormat, and draws it
+    once straight out of memory and once after upload(). GL is stubbed (glStubs.h), so the vertices, texture
+    coordinates and indices that reach glDrawElements are read back through the attribute pointers and
+    compared with what the grid should come out as: 4 corners a quad counter clockwise from the bottom left,
+    v going down the sheet, and 0 1 2, 0 2 3 for every quad. Packed formats get their rounding as slack.
+    It also checks vertexBytes(), and that a grid past the 16 bit index limit is drawn in pieces that add up.
+    Anything that doesn't match is printed and the exit code is 1.
+    Builds on its own, from this folder (only the GL headers are needed, no context):
+        c++ -O2 -I../NYUCodebase -I/Library/Frameworks/SDL2.framework/Headers quadMeshCheck.cpp ../NYUCodebase/QuadMesh.cpp -o quadMeshCheck
+*/
+
+#include "glStubs.h"
+#include "QuadMesh.h"
+#include <stdio.h>
+#include <math.h>
+
+#define SHEET_SPRITES 30
+#define GRID_WIDTH 5
+#define GRID_HEIGHT 3
+// more quads than 16 bit indices can reach in one draw
+#define BIG_GRID_WIDTH 200
+#define BIG_GRID_HEIGHT 100
+
+static int spriteAt(int x, int y) {
+    return (x * 7 + y * 13) % (SHEET_SPRITES * SHEET_SPRITES);
+}
+
+static void buildGrid(QuadMesh &mesh, int width, int height) {
+    float spriteSize = 1.0f / (float)SHEET_SPRITES;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            int sprite = spriteAt(x, y);
+            float u = (float)(sprite % SHEET_SPRITES) / (float)SHEET_SPRITES;
+            float v = (float)(sprite / SHEET_SPRITES) / (float)SHEET_SPRITES;
+            mesh.addRect((float)x, (float)-y, (float)(x + 1), (float)(-y - 1), u, v, spriteSize, spriteSize);
+        }
+    }
+}
+
+// Corner 0..3 of the tile at x, y as it went into addRect
+static StubVertex expectedCorner(int x, int y, int corner) {
+    int sprite = spriteAt(x, y);
+    float spriteSize = 1.0f / (float)SHEET_SPRITES;
+    float u = (float)(sprite % SHEET_SPRITES) / (float)SHEET_SPRITES;
+    float v = (float)(sprite / SHEET_SPRITES) / (float)SHEET_SPRITES;
+    bool right = corner == 1 || corner == 2;
+    bool top = corner >= 2;
+    StubVertex vertex = {
+        (float)(right ? x + 1 : x), (float)(top ? -y : -y - 1),
+        right ? u + spriteSize : u, top ? v : v + spriteSize
+    };
+    return vertex;
+}
+
+static const char *formatName(QuadFormat format) {
+    return format == QUAD_FLOAT ? "QUAD_FLOAT" : format == QUAD_PACKED_UV ? "QUAD_PACKED_UV" : "QUAD_PACKED";
+}
+
+// Every draw since the last gl.reset() against a width x height grid, quad numbers carrying on from one draw to the next
+static bool checkDraws(const char *what, QuadFormat format, int width, int height) {
+    // positions are whole numbers, so only the normalized shorts get rounded
+    float uvSlack = format == QUAD_FLOAT ? 0.0f : 0.5f / 65535.0f + 1e-7f;
+    int quad = 0;
+    for (size_t d = 0; d < gl.draws.size(); d++) {
+        const StubDraw &draw = gl.draws[d];
+        if (draw.indices.size() % 6 != 0) {
+            printf("%s %s: draw %d has %d indices, not 6 a quad\n", formatName(format), what, (int)d, (int)draw.indices.size());
+            return false;
+        }
+        int quads = (int)draw.indices.size() / 6;
+        for (int q = 0; q < quads; q++) {
+            const GLushort pattern[6] = {0, 1, 2, 0, 2, 3};
+            for (int i = 0; i < 6; i++) {
+                if (draw.indices[q * 6 + i] != q * 4 + pattern[i]) {
+                    printf("%s %s: index %d of quad %d is %d, should be %d\n", formatName(format), what, i, quad + q,
+                           draw.indices[q * 6 + i], q * 4 + pattern[i]);
+                    return false;
+                }
+            }
+            int x = (quad + q) % width, y = (quad + q) / width;
+            for (int corner = 0; corner < 4; corner++) {
+                StubVertex expected = expectedCorner(x, y, corner);
+                const StubVertex &got = draw.vertices[q * 4 + corner];
+                if (got.x != expected.x || got.y != expected.y || fabsf(got.u - expected.u) > uvSlack || fabsf(got.v - expected.v) > uvSlack) {
+                    printf("%s %s: tile %d,%d corner %d is %g,%g uv %g,%g, should be %g,%g uv %g,%g\n", formatName(format), what, x, y, corner,
+                           got.x, got.y, got.u, got.v, expected.x, expected.y, expected.u, expected.v);
+                    return false;
+                }
+            }
+        }
+        quad += quads;
+    }
+    if (quad != width * height) {
+        printf("%s %s: %d quads drawn, the grid has %d\n", formatName(format), what, quad, width * height);
+        return false;
+    }
+    return true;
+}
+
+static bool checkFormat(QuadFormat format) {
+    ShaderProgram program("vertex_textured.glsl", "fragment_textured.glsl");
+    int vertexSize = format == QUAD_FLOAT ? 16 : format == QUAD_PACKED_UV ? 12 : 8;
+    
+    QuadMesh mesh(format);
+    buildGrid(mesh, GRID_WIDTH, GRID_HEIGHT);
+    if (mesh.quadCount() != GRID_WIDTH * GRID_HEIGHT || mesh.vertexBytes() != GRID_WIDTH * GRID_HEIGHT * 4 * vertexSize) {
+        printf("%s: %d quads in %d bytes, should be %d in %d\n", formatName(format), mesh.quadCount(), mesh.vertexBytes(),
+               GRID_WIDTH * GRID_HEIGHT, GRID_WIDTH * GRID_HEIGHT * 4 * vertexSize);
+        return false;
+    }
+    if (QuadMesh::bytesPerQuad(format) != 4 * vertexSize + 12) {
+        printf("%s: bytesPerQuad is %d, should be %d\n", formatName(format), QuadMesh::bytesPerQuad(format), 4 * vertexSize + 12);
+        return false;
+    }
+    
+    gl.reset();
+    mesh.draw(&program);
+    if (gl.draws.size() != 1 || !checkDraws("from memory", format, GRID_WIDTH, GRID_HEIGHT)) {
+        printf("%s from memory: %d draws\n", formatName(format), (int)gl.draws.size());
+        return false;
+    }
+    
+    // the way a chunk is kept, in a buffer object with the shared index buffer
+    gl.reset();
+    mesh.upload();
+    mesh.draw(&program);
+    bool ok = gl.draws.size() == 1 && checkDraws("uploaded", format, GRID_WIDTH, GRID_HEIGHT);
+    mesh.clear();
+    if (!ok) {
+        return false;
+    }
+    
+    // and a rebuilt one, which has to drop the old quads
+    mesh.reset();
+    buildGrid(mesh, GRID_WIDTH, GRID_HEIGHT);
+    gl.reset();
+    mesh.draw(&program);
+    if (!checkDraws("rebuilt", format, GRID_WIDTH, GRID_HEIGHT)) {
+        return false;
+    }
+    
+    QuadMesh big(format);
+    buildGrid(big, BIG_GRID_WIDTH, BIG_GRID_HEIGHT);
+    gl.reset();
+    big.draw(&program);
+    if (gl.draws.size() != 2 || !checkDraws("past 65536 vertices", format, BIG_GRID_WIDTH, BIG_GRID_HEIGHT)) {
+        printf("%s past 65536 vertices: %d draws, should be 2\n", formatName(format), (int)gl.draws.size());
+        return false;
+    }
+    
+    printf("    %-15s %d x %d grid, %2d bytes a vertex, from memory, uploaded and rebuilt, %d x %d in 2 draws\n", formatName(format),
+           GRID_WIDTH, GRID_HEIGHT, vertexSize, BIG_GRID_WIDTH, BIG_GRID_HEIGHT);
+    return true;
+}
+
+int main() {
+    bool ok = checkFormat(QUAD_FLOAT);
+    ok = checkFormat(QUAD_PACKED_UV) && ok;
+    ok = checkFormat(QUAD_PACKED) && ok;
+    if (!ok) {
+        return 1;
+    }
+    printf("every format matches\n");
+    return 0;
+}
@@ -0,0 +1,181 @@
+/*
+    spriteBatchCheck
+
+    Draws a Space Invaders frame through SpriteBatch with GL stubbed (glStubs.h): 30 invaders placed with a
+    Matrix and 3 bullets with an Affine2D, all off the same sprite sheet, then the same frame again with the
+    player on a texture of its own added in the middle of them.
+    The first frame has to be one draw call of 33 quads, drawCalls 1 and verticesDrawn 132, the second two
+    draw calls, one a texture, with the 34 quads between them. Every corner GL gets has to be where the sprite's
+    transform puts it, with its texture coordinates, and the indices 0 1 2, 0 2 3 a quad. Anything else is
+    printed and the exit code is 1.
+    Builds on its own, from this folder (only the GL headers are needed, no context):
+        c++ -O2 -I../NYUCodebase -I/Library/Frameworks/SDL2.framework/Headers spriteBatchCheck.cpp ../NYUCodebase/SpriteBatch.cpp ../NYUCodebase/QuadMesh.cpp ../NYUCodebase/Affine2D.cpp ../NYUCodebase/Matrix.cpp -o spriteBatchCheck
+*/
+
+#include "glStubs.h"
+#include "SpriteBatch.h"
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+
+#define SHEET_TEXTURE 7
+#define PLAYER_TEXTURE 3
+#define INVADER_ROWS 5
+#define INVADER_COLUMNS 6
+#define BULLETS 3
+#define SHEET_SPRITES 8
+// float positions come back exactly, the packed texture coordinates are rounded to 1/65535
+#define POSITION_SLACK 1e-5f
+#define UV_SLACK (0.5f / 65535.0f + 1e-7f)
+
+// A sprite as the game has it, the square SpriteSheet vertices scaled and moved into place
+struct Sprite {
+    GLuint textureID;
+    float x, y, size;
+    int sprite;
+    bool affine;
+};
+
+// SpriteSheet's 6 vertices and texture coordinates for a sprite of the sheet, like Entity::draw
+static void spriteQuad(int sprite, float *vertices, float *texCoords) {
+    float u = (float)(sprite % SHEET_SPRITES) / (float)SHEET_SPRITES;
+    float v = (float)(sprite / SHEET_SPRITES) / (float)SHEET_SPRITES;
+    float size = 1.0f / (float)SHEET_SPRITES;
+    const float quad[] = {-0.5f, -0.5f, 0.5f, 0.5f, -0.5f, 0.5f, 0.5f, 0.5f, -0.5f, -0.5f, 0.5f, -0.5f};
+    const float uv[] = {u, v + size, u + size, v, u, v, u + size, v, u, v + size, u + size, v + size};
+    std::copy(quad, quad + 12, vertices);
+    std::copy(uv, uv + 12, texCoords);
+}
+
+static void drawSprite(SpriteBatch &batch, const Sprite &sprite) {
+    float vertices[12], texCoords[12];
+    spriteQuad(sprite.sprite, vertices, texCoords);
+    if (sprite.affine) {
+        Affine2D transform;
+        transform.Translate(sprite.x, sprite.y);
+        transform.Scale(sprite.size, sprite.size);
+        batch.draw(sprite.textureID, transform, vertices, texCoords);
+    } else {
+        Matrix modelMatrix;
+        modelMatrix.Translate(sprite.x, sprite.y, 0.0f);
+        modelMatrix.Scale(sprite.size, sprite.size, 1.0f);
+        batch.draw(sprite.textureID, modelMatrix, vertices, texCoords);
+    }
+}
+
+// Corner 0..3 counter clockwise from the bottom left, where the sprite is on screen and in the sheet
+static StubVertex expectedCorner(const Sprite &sprite, int corner) {
+    bool right = corner == 1 || corner == 2;
+    bool top = corner >= 2;
+    float size = 1.0f / (float)SHEET_SPRITES;
+    float u = (float)(sprite.sprite % SHEET_SPRITES) / (float)SHEET_SPRITES;
+    float v = (float)(sprite.sprite / SHEET_SPRITES) / (float)SHEET_SPRITES;
+    StubVertex vertex = {
+        sprite.x + (right ? 0.5f : -0.5f) * sprite.size, sprite.y + (top ? 0.5f : -0.5f) * sprite.size,
+        right ? u + size : u, top ? v : v + size
+    };
+    return vertex;
+}
+
+static bool checkDraw(const char *what, const StubDraw &draw, const std::vector<Sprite> &sprites) {
+    if (draw.indices.size() != sprites.size() * 6) {
+        printf("%s: %d indices for %d sprites\n", what, (int)draw.indices.size(), (int)sprites.size());
+        return false;
+    }
+    for (size_t s = 0; s < sprites.size(); s++) {
+        const GLushort pattern[6] = {0, 1, 2, 0, 2, 3};
+        for (int i = 0; i < 6; i++) {
+            if (draw.indices[s * 6 + i] != s * 4 + pattern[i]) {
+                printf("%s: index %d of quad %d is %d, should be %d\n", what, i, (int)s, draw.indices[s * 6 + i], (int)(s * 4 + pattern[i]));
+                return false;
+            }
+        }
+        for (int corner = 0; corner < 4; corner++) {
+            StubVertex expected = expectedCorner(sprites[s], corner);
+            const StubVertex &got = draw.vertices[s * 4 + corner];
+            if (fabsf(got.x - expected.x) > POSITION_SLACK || fabsf(got.y - expected.y) > POSITION_SLACK ||
+                fabsf(got.u - expected.u) > UV_SLACK || fabsf(got.v - expected.v) > UV_SLACK) {
+                printf("%s: sprite %d corner %d is %g,%g uv %g,%g, should be %g,%g uv %g,%g\n", what, (int)s, corner,
+                       got.x, got.y, got.u, got.v, expected.x, expected.y, expected.u, expected.v);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool checkCounters(const char *what, const SpriteBatch &batch, int drawCalls, int quads) {
+    if (batch.drawCalls != drawCalls || batch.verticesDrawn != quads * 4 || (int)gl.draws.size() != drawCalls || gl.textureBinds != drawCalls) {
+        printf("%s: drawCalls %d, verticesDrawn %d, %d glDrawElements and %d texture binds, should be %d draws of %d vertices\n", what,
+               batch.drawCalls, batch.verticesDrawn, (int)gl.draws.size(), gl.textureBinds, drawCalls, quads * 4);
+        return false;
+    }
+    if (batch.bytesUploaded != quads * QuadMesh::bytesPerQuad(QUAD_PACKED_UV)) {
+        printf("%s: bytesUploaded %d, should be %d\n", what, batch.bytesUploaded, quads * QuadMesh::bytesPerQuad(QUAD_PACKED_UV));
+        return false;
+    }
+    return true;
+}
+
+int main() {
+    ShaderProgram program("vertex_textured.glsl", "fragment_textured.glsl");
+    SpriteBatch batch;
+    
+    std::vector<Sprite> invaders;
+    for (int row = 0; row < INVADER_ROWS; row++) {
+        for (int column = 0; column < INVADER_COLUMNS; column++) {
+            Sprite invader = {SHEET_TEXTURE, -2.5f + column * 0.6f, 1.5f - row * 0.4f, 0.3f, row, false};
+            invaders.push_back(invader);
+        }
+    }
+    for (int i = 0; i < BULLETS; i++) {
+        Sprite bullet = {SHEET_TEXTURE, -1.0f + i * 0.75f, -1.0f + i * 0.3f, 0.1f, 60 + i, true};
+        invaders.push_back(bullet);
+    }
+    int quads = (int)invaders.size();
+    
+    gl.reset();
+    batch.begin();
+    for (size_t i = 0; i < invaders.size(); i++) {
+        drawSprite(batch, invaders[i]);
+    }
+    batch.end(&program);
+    if (!checkCounters("30 invaders and 3 bullets", batch, 1, quads) || !checkDraw("30 invaders and 3 bullets", gl.draws[0], invaders)) {
+        return 1;
+    }
+    printf("30 invaders and %d bullets on one texture: %d draw call, %d vertices\n", BULLETS, batch.drawCalls, batch.verticesDrawn);
+    
+    // the player in the middle of the frame on its own texture, sorting puts it first and keeps the rest in order
+    gl.reset();
+    batch.begin();
+    Sprite player = {PLAYER_TEXTURE, 0.0f, -1.8f, 0.5f, 0, false};
+    for (size_t i = 0; i < invaders.size(); i++) {
+        if (i == invaders.size() / 2) {
+            drawSprite(batch, player);
+        }
+        drawSprite(batch, invaders[i]);
+    }
+    batch.end(&program);
+    if (!checkCounters("with the player", batch, 2, quads + 1)) {
+        return 1;
+    }
+    if (gl.draws[0].textureID != PLAYER_TEXTURE || gl.draws[1].textureID != SHEET_TEXTURE) {
+        printf("with the player: drew texture %d then %d, should be %d then %d\n", gl.draws[0].textureID, gl.draws[1].textureID,
+               PLAYER_TEXTURE, SHEET_TEXTURE);
+        return 1;
+    }
+    if (!checkDraw("the player", gl.draws[0], std::vector<Sprite>(1, player)) || !checkDraw("the invaders after the player", gl.draws[1], invaders)) {
+        return 1;
+    }
+    printf("plus the player on a second texture: %d draw calls, %d vertices\n", batch.drawCalls, batch.verticesDrawn);
+    
+    // an empty frame draws nothing and clears the counters
+    gl.reset();
+    batch.begin();
+    batch.end(&program);
+    if (batch.drawCalls != 0 || batch.verticesDrawn != 0 || !gl.draws.empty()) {
+        printf("An empty frame made %d draw calls\n", (int)gl.draws.size());
+        return 1;
+    }
+    return 0;
+}
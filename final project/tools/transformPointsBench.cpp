@@ -0,0 +1,169 @@
+/*
+    transformPointsBench
+
+    Checks Matrix::transformPoints, packed, strided and in place, against transforming the points one at a time
+    with Matrix::transform, for every count up to a few SIMD widths and for spans big enough to be split across
+    threads. Then reports how many points a second it gets through at 1k, 100k and 1M points.
+    Anything that doesn't agree is printed and the exit code is 1.
+    Builds on its own, from this folder:
+        c++ -O2 -I../NYUCodebase transformPointsBench.cpp ../NYUCodebase/Matrix.cpp -o transformPointsBench -pthread
+*/
+
+#include "Matrix.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+
+#define TOLERANCE 0.00001f
+// interleaved vertex data: x, y, then u, v and anything else
+#define VERTEX_STRIDE 5
+
+static float randomFloat(float low, float high) {
+    return low + (high - low) * rand() / RAND_MAX;
+}
+
+static Matrix randomTransform() {
+    Matrix matrix;
+    matrix.Translate(randomFloat(-100.0f, 100.0f), randomFloat(-100.0f, 100.0f), 0.0f);
+    matrix.Rotate(randomFloat(-3.14159f, 3.14159f));
+    matrix.Scale(randomFloat(0.1f, 10.0f), randomFloat(0.1f, 10.0f), 1.0f);
+    return matrix;
+}
+
+// Point i of out has to be what transform() makes of point i of in, the z and w of transform() are 0 and 1
+static bool agrees(const char *what, const Matrix &matrix, const std::vector<float> &in, size_t inStride, const std::vector<float> &out, size_t outStride, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        float point[4] = {in[i * inStride], in[i * inStride + 1], 0.0f, 1.0f};
+        float expected[4];
+        matrix.transform(point, expected);
+        for (int j = 0; j < 2; j++) {
+            float found = out[i * outStride + j];
+            if (fabsf(found - expected[j]) > TOLERANCE * fmaxf(1.0f, fabsf(expected[j]))) {
+                printf("%s, %d points: point %d %c is %g, transform() gives %g\n", what, (int)count, (int)i, j ? 'y' : 'x', found, expected[j]);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// The floats between points are left alone
+static bool untouched(const char *what, const std::vector<float> &out, size_t outStride, size_t count, float fill) {
+    for (size_t i = 0; i < count; i++) {
+        for (size_t j = 2; j < outStride; j++) {
+            if (out[i * outStride + j] != fill) {
+                printf("%s, %d points: wrote over float %d of point %d\n", what, (int)count, (int)j, (int)i);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static std::vector<float> randomPoints(size_t count, size_t stride) {
+    std::vector<float> points(count * stride);
+    for (size_t i = 0; i < points.size(); i++) {
+        points[i] = randomFloat(-1000.0f, 1000.0f);
+    }
+    return points;
+}
+
+static bool check(size_t count) {
+    Matrix matrix = randomTransform();
+    
+    std::vector<float> in = randomPoints(count, 2);
+    std::vector<float> out(count * 2 + 1, -1.0f);
+    matrix.transformPoints(in.data(), out.data(), count);
+    if (!agrees("packed", matrix, in, 2, out, 2, count)) {
+        return false;
+    }
+    // one float past the end is there to catch a SIMD store that goes too far
+    if (out[count * 2] != -1.0f) {
+        printf("packed, %d points: wrote past the end\n", (int)count);
+        return false;
+    }
+    
+    std::vector<float> inPlace = in;
+    matrix.transformPoints(inPlace.data(), inPlace.data(), count);
+    if (!agrees("in place", matrix, in, 2, inPlace, 2, count)) {
+        return false;
+    }
+    
+    std::vector<float> vertices = randomPoints(count, VERTEX_STRIDE);
+    std::vector<float> strided(count * VERTEX_STRIDE, 7.0f);
+    matrix.transformPoints(vertices.data(), VERTEX_STRIDE, strided.data(), VERTEX_STRIDE, count);
+    if (!agrees("strided", matrix, vertices, VERTEX_STRIDE, strided, VERTEX_STRIDE, count) || !untouched("strided", strided, VERTEX_STRIDE, count, 7.0f)) {
+        return false;
+    }
+    
+    // interleaved in, packed out, what a batch does with a mesh's vertices
+    std::vector<float> unpacked(count * 2);
+    matrix.transformPoints(vertices.data(), VERTEX_STRIDE, unpacked.data(), 2, count);
+    return agrees("strided to packed", matrix, vertices, VERTEX_STRIDE, unpacked, 2, count);
+}
+
+static double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void throughput(size_t count) {
+    Matrix matrix = randomTransform();
+    std::vector<float> in = randomPoints(count, 2);
+    std::vector<float> out(count * 2);
+    std::vector<float> vertices = randomPoints(count, VERTEX_STRIDE);
+    std::vector<float> transformed(count * VERTEX_STRIDE);
+    // about the same number of points whatever the span
+    int repeats = (int)(20000000 / count) + 1;
+    
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; r++) {
+        matrix.transformPoints(in.data(), out.data(), count);
+    }
+    double packed = seconds(start) / repeats;
+    
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; r++) {
+        matrix.transformPoints(vertices.data(), VERTEX_STRIDE, transformed.data(), VERTEX_STRIDE, count);
+    }
+    double strided = seconds(start) / repeats;
+    
+    // the way it had to be done before, one transform() a point
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; r++) {
+        for (size_t i = 0; i < count; i++) {
+            float point[4] = {in[i * 2], in[i * 2 + 1], 0.0f, 1.0f};
+            float result[4];
+            matrix.transform(point, result);
+            out[i * 2] = result[0];
+            out[i * 2 + 1] = result[1];
+        }
+    }
+    double single = seconds(start) / repeats;
+    
+    printf("%8d points: packed %7.0f M points/s, strided %7.0f M points/s, a transform() each %7.0f M points/s (%g %g)\n",
+           (int)count, count / packed / 1e6, count / strided / 1e6, count / single / 1e6, out[count], transformed[count]);
+}
+
+int main() {
+    srand(1);
+    // every way a span can end against the SIMD width, then a few big enough to be split across threads
+    for (size_t count = 0; count <= 64; count++) {
+        if (!check(count)) {
+            return 1;
+        }
+    }
+    size_t big[] = {262143, 262144, 262145, 1000001};
+    for (int i = 0; i < 4; i++) {
+        if (!check(big[i])) {
+            return 1;
+        }
+    }
+    printf("transformPoints agrees with transform() for 0 to 64 points and spans up to 1M\n");
+    
+    throughput(1000);
+    throughput(100000);
+    throughput(1000000);
+    return 0;
+}
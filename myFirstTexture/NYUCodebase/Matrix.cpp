@@ -1,11 +1,47 @@
 
 #include "Matrix.h"
 #include <math.h>
+#include <thread>
+#include <vector>
 
-Matrix::Matrix() {
-    identity();
+// Spans at least this long get split across threads
+#ifndef MATRIX_PARALLEL_POINTS
+    #define MATRIX_PARALLEL_POINTS 262144
+#endif
+#define MATRIX_MAX_THREADS 4
+// How far off a rotation can be and still get inverted by transposing
+#define MATRIX_RIGID_TOLERANCE 0.00001f
+
+// Pick the SIMD path at build time, define MATRIX_NO_SIMD to force the plain C++ one
+#if !defined(MATRIX_NO_SIMD) && (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+    #include <xmmintrin.h>
+    #define MATRIX_SSE
+#elif !defined(MATRIX_NO_SIMD) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+    #include <arm_neon.h>
+    #define MATRIX_NEON
+#endif
+
+// The compile time matrices, checked against values worked out by hand
+static constexpr bool nearlyEqual(float a, float b) {
+    return (a - b) < 0.00001f && (b - a) < 0.00001f;
 }
 
+static constexpr Matrix checkOrtho = Matrix::orthoProjection(-3.55f, 3.55f, -2.0f, 2.0f, -1.0f, 1.0f);
+static_assert(nearlyEqual(checkOrtho.m[0][0], 0.28169014f) && nearlyEqual(checkOrtho.m[1][1], 0.5f) && nearlyEqual(checkOrtho.m[2][2], -1.0f), "orthoProjection scale is wrong");
+static_assert(checkOrtho.m[3][0] == 0.0f && checkOrtho.m[3][1] == 0.0f && checkOrtho.m[3][2] == 0.0f && checkOrtho.m[3][3] == 1.0f, "orthoProjection offset is wrong");
+static constexpr Matrix checkOffsetOrtho = Matrix::orthoProjection(0.0f, 640.0f, 0.0f, 360.0f, -1.0f, 1.0f);
+static_assert(nearlyEqual(checkOffsetOrtho.m[3][0], -1.0f) && nearlyEqual(checkOffsetOrtho.m[3][1], -1.0f) && nearlyEqual(checkOffsetOrtho.m[0][0], 0.003125f), "orthoProjection offset is wrong");
+
+static_assert(nearlyEqual(Matrix::tangent(0.0f), 0.0f) && nearlyEqual(Matrix::tangent(0.78539816f), 1.0f) && nearlyEqual(Matrix::tangent(1.04719755f), 1.7320508f), "tangent is wrong");
+static constexpr Matrix checkPerspective = Matrix::perspectiveProjection(1.57079633f, 2.0f, 1.0f, 3.0f);
+static_assert(nearlyEqual(checkPerspective.m[0][0], 0.5f) && nearlyEqual(checkPerspective.m[1][1], 1.0f) && nearlyEqual(checkPerspective.m[2][2], -2.0f) && nearlyEqual(checkPerspective.m[3][2], -3.0f), "perspectiveProjection is wrong");
+static_assert(checkPerspective.m[2][3] == -1.0f && checkPerspective.m[3][3] == 0.0f, "perspectiveProjection is wrong");
+
+static constexpr Matrix checkTranslation = Matrix::translation(1.0f, 2.0f, 3.0f);
+static_assert(checkTranslation.m[3][0] == 1.0f && checkTranslation.m[3][1] == 2.0f && checkTranslation.m[3][2] == 3.0f && checkTranslation.m[0][0] == 1.0f, "translation is wrong");
+static constexpr Matrix checkScaling = Matrix::scaling(2.0f, 3.0f, 4.0f);
+static_assert(checkScaling.m[0][0] == 2.0f && checkScaling.m[1][1] == 3.0f && checkScaling.m[2][2] == 4.0f && checkScaling.m[3][3] == 1.0f, "scaling is wrong");
+
 void Matrix::identity() {
     m[0][0] = 1.0;
     m[1][0] = 0.0;
@@ -16,19 +52,23 @@ void Matrix::identity() {
     m[1][1] = 1.0;
     m[2][1] = 0.0;
     m[3][1] = 0.0;
-
+    
     m[0][2] = 0.0;
     m[1][2] = 0.0;
     m[2][2] = 1.0;
     m[3][2] = 0.0;
-
+    
     m[0][3] = 0.0;
     m[1][3] = 0.0;
     m[2][3] = 0.0;
     m[3][3] = 1.0;
 }
 
-Matrix Matrix::inverse() const {
+// The plain versions, used when there's no SIMD and as the reference the SIMD ones have to match.
+// Each one is only compiled where something calls it, NEON still uses the plain inverse
+#if !defined(MATRIX_SSE)
+static Matrix inverseScalar(const Matrix &matrix) {
+    const float (*m)[4] = matrix.m;
     float m00 = m[0][0], m01 = m[0][1], m02 = m[0][2], m03 = m[0][3];
     float m10 = m[1][0], m11 = m[1][1], m12 = m[1][2], m13 = m[1][3];
     float m20 = m[2][0], m21 = m[2][1], m22 = m[2][2], m23 = m[2][3];
@@ -101,8 +141,11 @@ Matrix Matrix::inverse() const {
     m2.m[3][3] = d33;
     return m2;
 }
+#endif
 
-Matrix Matrix::operator * (const Matrix &m2) const {
+#if !defined(MATRIX_SSE) && !defined(MATRIX_NEON)
+static Matrix multiplyScalar(const Matrix &m1, const Matrix &m2) {
+    const float (*m)[4] = m1.m;
     Matrix r;
     
     r.m[0][0] = m[0][0] * m2.m[0][0] + m[0][1] * m2.m[1][0] + m[0][2] * m2.m[2][0] + m[0][3] * m2.m[3][0];
@@ -127,6 +170,487 @@ Matrix Matrix::operator * (const Matrix &m2) const {
     
     return r;
 }
+#endif
+
+#if defined(MATRIX_SSE)
+
+// Row i of the result is row i of m1 times m2, adds go in the same order as the plain version so the results match exactly
+static inline __m128 multiplyRow(__m128 a, __m128 row0, __m128 row1, __m128 row2, __m128 row3) {
+    __m128 sum = _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 0, 0)), row0);
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 1, 1, 1)), row1));
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 2, 2)), row2));
+    return _mm_add_ps(sum, _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 3, 3)), row3));
+}
+
+static Matrix multiplySIMD(const Matrix &m1, const Matrix &m2) {
+    __m128 row0 = _mm_loadu_ps(m2.m[0]);
+    __m128 row1 = _mm_loadu_ps(m2.m[1]);
+    __m128 row2 = _mm_loadu_ps(m2.m[2]);
+    __m128 row3 = _mm_loadu_ps(m2.m[3]);
+    __m128 r0 = multiplyRow(_mm_loadu_ps(m1.m[0]), row0, row1, row2, row3);
+    __m128 r1 = multiplyRow(_mm_loadu_ps(m1.m[1]), row0, row1, row2, row3);
+    __m128 r2 = multiplyRow(_mm_loadu_ps(m1.m[2]), row0, row1, row2, row3);
+    __m128 r3 = multiplyRow(_mm_loadu_ps(m1.m[3]), row0, row1, row2, row3);
+    
+    Matrix r;
+    _mm_storeu_ps(r.m[0], r0);
+    _mm_storeu_ps(r.m[1], r1);
+    _mm_storeu_ps(r.m[2], r2);
+    _mm_storeu_ps(r.m[3], r3);
+    return r;
+}
+
+static void transformSIMD(const Matrix &matrix, const float *in, float *out) {
+    __m128 sum = _mm_mul_ps(_mm_loadu_ps(matrix.m[0]), _mm_set1_ps(in[0]));
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(matrix.m[1]), _mm_set1_ps(in[1])));
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(matrix.m[2]), _mm_set1_ps(in[2])));
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(matrix.m[3]), _mm_set1_ps(in[3])));
+    _mm_storeu_ps(out, sum);
+}
+
+#define SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x))
+#define SWIZZLE(a, x, y, z, w) SHUFFLE(a, a, x, y, z, w)
+
+// 2x2 blocks are stored as (a b c d) for | a b |
+//                                        | c d |
+// A * B
+static inline __m128 block2Mul(__m128 a, __m128 b) {
+    return _mm_add_ps(_mm_mul_ps(a, SWIZZLE(b, 0, 3, 0, 3)), _mm_mul_ps(SWIZZLE(a, 1, 0, 3, 2), SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+// adjugate(A) * B
+static inline __m128 block2AdjMul(__m128 a, __m128 b) {
+    return _mm_sub_ps(_mm_mul_ps(SWIZZLE(a, 3, 3, 0, 0), b), _mm_mul_ps(SWIZZLE(a, 1, 1, 2, 2), SWIZZLE(b, 2, 3, 0, 1)));
+}
+
+// A * adjugate(B)
+static inline __m128 block2MulAdj(__m128 a, __m128 b) {
+    return _mm_sub_ps(_mm_mul_ps(a, SWIZZLE(b, 3, 0, 3, 0)), _mm_mul_ps(SWIZZLE(a, 1, 0, 3, 2), SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+// Block inverse: split into four 2x2 blocks | A B | and build the inverse out of their adjugates
+//                                          | C D |
+// Rounds a little differently from the plain version, results agree to within float error
+static Matrix inverseSIMD(const Matrix &matrix) {
+    __m128 row0 = _mm_loadu_ps(matrix.m[0]);
+    __m128 row1 = _mm_loadu_ps(matrix.m[1]);
+    __m128 row2 = _mm_loadu_ps(matrix.m[2]);
+    __m128 row3 = _mm_loadu_ps(matrix.m[3]);
+    
+    __m128 A = _mm_movelh_ps(row0, row1);
+    __m128 B = _mm_movehl_ps(row1, row0);
+    __m128 C = _mm_movelh_ps(row2, row3);
+    __m128 D = _mm_movehl_ps(row3, row2);
+    
+    // determinants of the four blocks as (|A| |B| |C| |D|)
+    __m128 detSub = _mm_sub_ps(_mm_mul_ps(SHUFFLE(row0, row2, 0, 2, 0, 2), SHUFFLE(row1, row3, 1, 3, 1, 3)),
+                               _mm_mul_ps(SHUFFLE(row0, row2, 1, 3, 1, 3), SHUFFLE(row1, row3, 0, 2, 0, 2)));
+    __m128 detA = SWIZZLE(detSub, 0, 0, 0, 0);
+    __m128 detB = SWIZZLE(detSub, 1, 1, 1, 1);
+    __m128 detC = SWIZZLE(detSub, 2, 2, 2, 2);
+    __m128 detD = SWIZZLE(detSub, 3, 3, 3, 3);
+    
+    __m128 D_C = block2AdjMul(D, C);
+    __m128 A_B = block2AdjMul(A, B);
+    __m128 X = _mm_sub_ps(_mm_mul_ps(detD, A), block2Mul(B, D_C));
+    __m128 W = _mm_sub_ps(_mm_mul_ps(detA, D), block2Mul(C, A_B));
+    __m128 Y = _mm_sub_ps(_mm_mul_ps(detB, C), block2MulAdj(D, A_B));
+    __m128 Z = _mm_sub_ps(_mm_mul_ps(detC, B), block2MulAdj(A, D_C));
+    
+    // |M| = |A||D| + |B||C| - trace((A#B)(D#C))
+    __m128 tr = _mm_mul_ps(A_B, SWIZZLE(D_C, 0, 2, 1, 3));
+    tr = _mm_add_ps(tr, SWIZZLE(tr, 1, 0, 3, 2));
+    tr = _mm_add_ps(tr, SWIZZLE(tr, 2, 3, 0, 1));
+    __m128 detM = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), tr);
+    
+    __m128 invDet = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), detM);
+    X = _mm_mul_ps(X, invDet);
+    Y = _mm_mul_ps(Y, invDet);
+    Z = _mm_mul_ps(Z, invDet);
+    W = _mm_mul_ps(W, invDet);
+    
+    Matrix r;
+    _mm_storeu_ps(r.m[0], SHUFFLE(X, Y, 3, 1, 3, 1));
+    _mm_storeu_ps(r.m[1], SHUFFLE(X, Y, 2, 0, 2, 0));
+    _mm_storeu_ps(r.m[2], SHUFFLE(Z, W, 3, 1, 3, 1));
+    _mm_storeu_ps(r.m[3], SHUFFLE(Z, W, 2, 0, 2, 0));
+    return r;
+}
+
+// structure() a column at a time, it gives the same answers as the plain one (the dot products are summed
+// in the same order) for about a third of the work, so sorting out the shortcut doesn't cost more than it saves
+static Matrix::Structure structureSIMD(const Matrix &matrix) {
+    __m128 column0 = _mm_loadu_ps(matrix.m[0]);
+    __m128 column1 = _mm_loadu_ps(matrix.m[1]);
+    __m128 column2 = _mm_loadu_ps(matrix.m[2]);
+    __m128 column3 = _mm_loadu_ps(matrix.m[3]);
+    __m128 zero = _mm_setzero_ps();
+    __m128 one = _mm_set1_ps(1.0f);
+    
+    // bit j is set where row j of the column is 0, and in ones where row i of column i is 1
+    int zeros0 = _mm_movemask_ps(_mm_cmpeq_ps(column0, zero));
+    int zeros1 = _mm_movemask_ps(_mm_cmpeq_ps(column1, zero));
+    int zeros2 = _mm_movemask_ps(_mm_cmpeq_ps(column2, zero));
+    int ones = (_mm_movemask_ps(_mm_cmpeq_ps(column0, one)) & 1) | (_mm_movemask_ps(_mm_cmpeq_ps(column1, one)) & 2) |
+               (_mm_movemask_ps(_mm_cmpeq_ps(column2, one)) & 4) | (_mm_movemask_ps(_mm_cmpeq_ps(column3, one)) & 8);
+    
+    // anything with a projection in the bottom row needs the real thing
+    if(!(zeros0 & zeros1 & zeros2 & 8) || !(ones & 8)) {
+        return Matrix::GENERAL;
+    }
+    if((zeros0 & 6) == 6 && (zeros1 & 5) == 5 && (zeros2 & 3) == 3) {
+        return (ones & 7) == 7 ? Matrix::TRANSLATION : Matrix::SCALE_TRANSLATION;
+    }
+    
+    // columns of a rotation are unit length and at right angles to each other. w is 0 in all three,
+    // so after transposing the products adding the four rows gives (dot00 dot11 dot22 dot01) and (dot02 dot12 0 0)
+    __m128 x = _mm_mul_ps(column0, column0);
+    __m128 y = _mm_mul_ps(column1, column1);
+    __m128 z = _mm_mul_ps(column2, column2);
+    __m128 w = _mm_mul_ps(column0, column1);
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+    __m128 dots = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_add_ps(x, y), z), w), _mm_setr_ps(1.0f, 1.0f, 1.0f, 0.0f));
+    x = _mm_mul_ps(column0, column2);
+    y = _mm_mul_ps(column1, column2);
+    z = zero;
+    w = zero;
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+    __m128 moreDots = _mm_add_ps(_mm_add_ps(_mm_add_ps(x, y), z), w);
+    
+    __m128 sign = _mm_set1_ps(-0.0f);
+    __m128 tolerance = _mm_set1_ps(MATRIX_RIGID_TOLERANCE);
+    int close = _mm_movemask_ps(_mm_cmplt_ps(_mm_andnot_ps(sign, dots), tolerance)) &
+                _mm_movemask_ps(_mm_cmplt_ps(_mm_andnot_ps(sign, moreDots), tolerance));
+    return close == 15 ? Matrix::RIGID : Matrix::AFFINE;
+}
+
+// -(inverse 3x3) * translation with w = 1, for the inverse's last column out of its first three
+static inline __m128 inverseTranslation(__m128 inverse0, __m128 inverse1, __m128 inverse2, __m128 translation) {
+    __m128 sum = _mm_mul_ps(inverse0, SWIZZLE(translation, 0, 0, 0, 0));
+    sum = _mm_add_ps(sum, _mm_mul_ps(inverse1, SWIZZLE(translation, 1, 1, 1, 1)));
+    sum = _mm_add_ps(sum, _mm_mul_ps(inverse2, SWIZZLE(translation, 2, 2, 2, 2)));
+    return _mm_add_ps(_mm_xor_ps(sum, _mm_setr_ps(-0.0f, -0.0f, -0.0f, 0.0f)), _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f));
+}
+
+// u x v for the x, y and z of two columns, w comes out 0 when theirs are
+static inline __m128 cross(__m128 u, __m128 v) {
+    return _mm_sub_ps(_mm_mul_ps(SWIZZLE(u, 1, 2, 0, 3), SWIZZLE(v, 2, 0, 1, 3)), _mm_mul_ps(SWIZZLE(u, 2, 0, 1, 3), SWIZZLE(v, 1, 2, 0, 3)));
+}
+
+// The inverse of a matrix structureSIMD has sorted, with the shortcut for its kind. Translations, scales and
+// rotations come out the same as the plain shortcuts, affine ones round a little differently
+static Matrix inverseStructuredSIMD(const Matrix &matrix, Matrix::Structure kind) {
+    __m128 column0 = _mm_loadu_ps(matrix.m[0]);
+    __m128 column1 = _mm_loadu_ps(matrix.m[1]);
+    __m128 column2 = _mm_loadu_ps(matrix.m[2]);
+    __m128 column3 = _mm_loadu_ps(matrix.m[3]);
+    __m128 negate = _mm_setr_ps(-0.0f, -0.0f, -0.0f, 0.0f);
+    
+    Matrix r;
+    switch(kind) {
+        case Matrix::TRANSLATION:
+            _mm_storeu_ps(r.m[3], _mm_xor_ps(column3, negate));
+            return r;
+        case Matrix::SCALE_TRANSLATION: {
+            // one divide for all three scales, w is 1 / 1. Everything off the diagonal is 0, so adding the
+            // columns lines the scales up, and each column masks out its own lane of the result
+            __m128 zero = _mm_setzero_ps();
+            __m128 diagonal = _mm_add_ps(_mm_add_ps(column0, column1), _mm_add_ps(column2, _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f)));
+            __m128 scales = _mm_div_ps(_mm_set1_ps(1.0f), diagonal);
+            _mm_storeu_ps(r.m[0], _mm_and_ps(scales, _mm_cmpneq_ps(column0, zero)));
+            _mm_storeu_ps(r.m[1], _mm_and_ps(scales, _mm_cmpneq_ps(column1, zero)));
+            _mm_storeu_ps(r.m[2], _mm_and_ps(scales, _mm_cmpneq_ps(column2, zero)));
+            _mm_storeu_ps(r.m[3], _mm_mul_ps(_mm_xor_ps(column3, negate), scales));
+            return r;
+        }
+        case Matrix::RIGID: {
+            // the inverse of a rotation is its transpose, then undo the translation with it
+            __m128 w = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+            _MM_TRANSPOSE4_PS(column0, column1, column2, w);
+            _mm_storeu_ps(r.m[0], column0);
+            _mm_storeu_ps(r.m[1], column1);
+            _mm_storeu_ps(r.m[2], column2);
+            _mm_storeu_ps(r.m[3], inverseTranslation(column0, column1, column2, column3));
+            return r;
+        }
+        case Matrix::AFFINE: {
+            // the rows of a 3x3 inverse are the cross products of its columns over the determinant
+            __m128 row0 = cross(column1, column2);
+            __m128 row1 = cross(column2, column0);
+            __m128 row2 = cross(column0, column1);
+            __m128 products = _mm_mul_ps(column0, row0);
+            __m128 determinant = _mm_add_ss(_mm_add_ss(products, SWIZZLE(products, 1, 1, 1, 1)), SWIZZLE(products, 2, 2, 2, 2));
+            __m128 invDet = _mm_div_ps(_mm_set1_ps(1.0f), SWIZZLE(determinant, 0, 0, 0, 0));
+            __m128 w = _mm_setzero_ps();
+            _MM_TRANSPOSE4_PS(row0, row1, row2, w);
+            row0 = _mm_mul_ps(row0, invDet);
+            row1 = _mm_mul_ps(row1, invDet);
+            row2 = _mm_mul_ps(row2, invDet);
+            _mm_storeu_ps(r.m[0], row0);
+            _mm_storeu_ps(r.m[1], row1);
+            _mm_storeu_ps(r.m[2], row2);
+            _mm_storeu_ps(r.m[3], inverseTranslation(row0, row1, row2, column3));
+            return r;
+        }
+        default:
+            return inverseSIMD(matrix);
+    }
+}
+
+#undef SWIZZLE
+#undef SHUFFLE
+
+#elif defined(MATRIX_NEON)
+
+// Separate multiply and add (not vmlaq) so the rounding is the same as the plain version
+static Matrix multiplySIMD(const Matrix &m1, const Matrix &m2) {
+    Matrix r;
+    float32x4_t row0 = vld1q_f32(m2.m[0]);
+    float32x4_t row1 = vld1q_f32(m2.m[1]);
+    float32x4_t row2 = vld1q_f32(m2.m[2]);
+    float32x4_t row3 = vld1q_f32(m2.m[3]);
+    for(int i = 0; i < 4; i++) {
+        float32x4_t sum = vmulq_f32(vdupq_n_f32(m1.m[i][0]), row0);
+        sum = vaddq_f32(sum, vmulq_f32(vdupq_n_f32(m1.m[i][1]), row1));
+        sum = vaddq_f32(sum, vmulq_f32(vdupq_n_f32(m1.m[i][2]), row2));
+        sum = vaddq_f32(sum, vmulq_f32(vdupq_n_f32(m1.m[i][3]), row3));
+        vst1q_f32(r.m[i], sum);
+    }
+    return r;
+}
+
+static void transformSIMD(const Matrix &matrix, const float *in, float *out) {
+    float32x4_t sum = vmulq_f32(vld1q_f32(matrix.m[0]), vdupq_n_f32(in[0]));
+    sum = vaddq_f32(sum, vmulq_f32(vld1q_f32(matrix.m[1]), vdupq_n_f32(in[1])));
+    sum = vaddq_f32(sum, vmulq_f32(vld1q_f32(matrix.m[2]), vdupq_n_f32(in[2])));
+    sum = vaddq_f32(sum, vmulq_f32(vld1q_f32(matrix.m[3]), vdupq_n_f32(in[3])));
+    vst1q_f32(out, sum);
+}
+
+// No NEON inverse yet, the plain one is fine for the few we do per frame
+static Matrix inverseSIMD(const Matrix &matrix) {
+    return inverseScalar(matrix);
+}
+
+#endif
+
+#if !defined(MATRIX_SSE) && !defined(MATRIX_NEON)
+static void transformScalar(const Matrix &matrix, const float *in, float *out) {
+    const float (*m)[4] = matrix.m;
+    float x = in[0], y = in[1], z = in[2], w = in[3];
+    for(int j = 0; j < 4; j++) {
+        out[j] = m[0][j] * x + m[1][j] * y + m[2][j] * z + m[3][j] * w;
+    }
+}
+#endif
+
+int Matrix::inverseCounts[Matrix::GENERAL + 1];
+
+Matrix Matrix::generalInverse() const {
+#if defined(MATRIX_SSE) || defined(MATRIX_NEON)
+    return inverseSIMD(*this);
+#else
+    return inverseScalar(*this);
+#endif
+}
+
+Matrix::Structure Matrix::structure() const {
+#if defined(MATRIX_SSE)
+    return structureSIMD(*this);
+#else
+    // anything with a projection in the bottom row needs the real thing
+    // the tests are or'd together rather than short circuited so they don't turn into a chain of branches
+    if((m[0][3] != 0.0f) | (m[1][3] != 0.0f) | (m[2][3] != 0.0f) | (m[3][3] != 1.0f)) {
+        return GENERAL;
+    }
+    if((m[1][0] == 0.0f) & (m[2][0] == 0.0f) & (m[0][1] == 0.0f) & (m[2][1] == 0.0f) & (m[0][2] == 0.0f) & (m[1][2] == 0.0f)) {
+        if((m[0][0] == 1.0f) & (m[1][1] == 1.0f) & (m[2][2] == 1.0f)) {
+            return TRANSLATION;
+        }
+        return SCALE_TRANSLATION;
+    }
+    // columns of a rotation are unit length and at right angles to each other
+    float dot00 = m[0][0] * m[0][0] + m[0][1] * m[0][1] + m[0][2] * m[0][2];
+    float dot11 = m[1][0] * m[1][0] + m[1][1] * m[1][1] + m[1][2] * m[1][2];
+    float dot22 = m[2][0] * m[2][0] + m[2][1] * m[2][1] + m[2][2] * m[2][2];
+    float dot01 = m[0][0] * m[1][0] + m[0][1] * m[1][1] + m[0][2] * m[1][2];
+    float dot02 = m[0][0] * m[2][0] + m[0][1] * m[2][1] + m[0][2] * m[2][2];
+    float dot12 = m[1][0] * m[2][0] + m[1][1] * m[2][1] + m[1][2] * m[2][2];
+    if(fabsf(dot00 - 1.0f) < MATRIX_RIGID_TOLERANCE && fabsf(dot11 - 1.0f) < MATRIX_RIGID_TOLERANCE && fabsf(dot22 - 1.0f) < MATRIX_RIGID_TOLERANCE &&
+       fabsf(dot01) < MATRIX_RIGID_TOLERANCE && fabsf(dot02) < MATRIX_RIGID_TOLERANCE && fabsf(dot12) < MATRIX_RIGID_TOLERANCE) {
+        return RIGID;
+    }
+    return AFFINE;
+#endif
+}
+
+Matrix Matrix::inverse() const {
+    Structure kind = structure();
+#if defined(MATRIX_COUNT_INVERSES)
+    inverseCounts[kind]++;
+#endif
+#if defined(MATRIX_SSE)
+    return inverseStructuredSIMD(*this, kind);
+#else
+    Matrix r;
+    switch(kind) {
+        case TRANSLATION:
+            r.m[3][0] = -m[3][0];
+            r.m[3][1] = -m[3][1];
+            r.m[3][2] = -m[3][2];
+            return r;
+        case SCALE_TRANSLATION:
+            r.m[0][0] = 1.0f / m[0][0];
+            r.m[1][1] = 1.0f / m[1][1];
+            r.m[2][2] = 1.0f / m[2][2];
+            r.m[3][0] = -m[3][0] * r.m[0][0];
+            r.m[3][1] = -m[3][1] * r.m[1][1];
+            r.m[3][2] = -m[3][2] * r.m[2][2];
+            return r;
+        case RIGID:
+            // the inverse of a rotation is its transpose, then undo the translation with it
+            for(int i = 0; i < 3; i++) {
+                for(int j = 0; j < 3; j++) {
+                    r.m[i][j] = m[j][i];
+                }
+            }
+            break;
+        case AFFINE: {
+            // 3x3 inverse from the cofactors, r.m[col][row] = cofactor(col, row) / determinant
+            float c00 = m[1][1] * m[2][2] - m[2][1] * m[1][2];
+            float c01 = m[2][1] * m[0][2] - m[0][1] * m[2][2];
+            float c02 = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+            float invDet = 1.0f / (m[0][0] * c00 + m[1][0] * c01 + m[2][0] * c02);
+            r.m[0][0] = c00 * invDet;
+            r.m[0][1] = c01 * invDet;
+            r.m[0][2] = c02 * invDet;
+            r.m[1][0] = (m[2][0] * m[1][2] - m[1][0] * m[2][2]) * invDet;
+            r.m[1][1] = (m[0][0] * m[2][2] - m[2][0] * m[0][2]) * invDet;
+            r.m[1][2] = (m[1][0] * m[0][2] - m[0][0] * m[1][2]) * invDet;
+            r.m[2][0] = (m[1][0] * m[2][1] - m[2][0] * m[1][1]) * invDet;
+            r.m[2][1] = (m[2][0] * m[0][1] - m[0][0] * m[2][1]) * invDet;
+            r.m[2][2] = (m[0][0] * m[1][1] - m[1][0] * m[0][1]) * invDet;
+            break;
+        }
+        default:
+            return generalInverse();
+    }
+    // rigid and affine: the new translation is -(inverse 3x3) * translation
+    for(int j = 0; j < 3; j++) {
+        r.m[3][j] = -(r.m[0][j] * m[3][0] + r.m[1][j] * m[3][1] + r.m[2][j] * m[3][2]);
+    }
+    return r;
+#endif
+}
+
+Matrix Matrix::operator * (const Matrix &m2) const {
+#if defined(MATRIX_SSE) || defined(MATRIX_NEON)
+    return multiplySIMD(*this, m2);
+#else
+    return multiplyScalar(*this, m2);
+#endif
+}
+
+void Matrix::transform(const float *in, float *out) const {
+#if defined(MATRIX_SSE) || defined(MATRIX_NEON)
+    transformSIMD(*this, in, out);
+#else
+    transformScalar(*this, in, out);
+#endif
+}
+
+// The 2D part of a transform, same multiply then add order as transform() so the results are the same
+static void transformPointsScalar(const Matrix &matrix, const float *in, size_t inStride, float *out, size_t outStride, size_t count) {
+    float a = matrix.m[0][0], b = matrix.m[0][1];
+    float c = matrix.m[1][0], d = matrix.m[1][1];
+    float tx = matrix.m[3][0], ty = matrix.m[3][1];
+    for(size_t i = 0; i < count; i++) {
+        float x = in[i * inStride];
+        float y = in[i * inStride + 1];
+        out[i * outStride] = a * x + c * y + tx;
+        out[i * outStride + 1] = b * x + d * y + ty;
+    }
+}
+
+// Tightly packed points, two at a time
+static void transformPointsPacked(const Matrix &matrix, const float *in, float *out, size_t count) {
+    size_t i = 0;
+#if defined(MATRIX_SSE)
+    __m128 xColumn = _mm_setr_ps(matrix.m[0][0], matrix.m[0][1], matrix.m[0][0], matrix.m[0][1]);
+    __m128 yColumn = _mm_setr_ps(matrix.m[1][0], matrix.m[1][1], matrix.m[1][0], matrix.m[1][1]);
+    __m128 translation = _mm_setr_ps(matrix.m[3][0], matrix.m[3][1], matrix.m[3][0], matrix.m[3][1]);
+    for(; i + 2 <= count; i += 2) {
+        __m128 points = _mm_loadu_ps(in + i * 2);
+        __m128 xs = _mm_shuffle_ps(points, points, _MM_SHUFFLE(2, 2, 0, 0));
+        __m128 ys = _mm_shuffle_ps(points, points, _MM_SHUFFLE(3, 3, 1, 1));
+        __m128 result = _mm_add_ps(_mm_add_ps(_mm_mul_ps(xColumn, xs), _mm_mul_ps(yColumn, ys)), translation);
+        _mm_storeu_ps(out + i * 2, result);
+    }
+#elif defined(MATRIX_NEON)
+    float xValues[4] = {matrix.m[0][0], matrix.m[0][1], matrix.m[0][0], matrix.m[0][1]};
+    float yValues[4] = {matrix.m[1][0], matrix.m[1][1], matrix.m[1][0], matrix.m[1][1]};
+    float tValues[4] = {matrix.m[3][0], matrix.m[3][1], matrix.m[3][0], matrix.m[3][1]};
+    float32x4_t xColumn = vld1q_f32(xValues);
+    float32x4_t yColumn = vld1q_f32(yValues);
+    float32x4_t translation = vld1q_f32(tValues);
+    for(; i + 2 <= count; i += 2) {
+        float32x4_t points = vld1q_f32(in + i * 2);
+        float32x2_t low = vget_low_f32(points);
+        float32x2_t high = vget_high_f32(points);
+        float32x4_t xs = vcombine_f32(vdup_lane_f32(low, 0), vdup_lane_f32(high, 0));
+        float32x4_t ys = vcombine_f32(vdup_lane_f32(low, 1), vdup_lane_f32(high, 1));
+        float32x4_t result = vaddq_f32(vaddq_f32(vmulq_f32(xColumn, xs), vmulq_f32(yColumn, ys)), translation);
+        vst1q_f32(out + i * 2, result);
+    }
+#endif
+    transformPointsScalar(matrix, in + i * 2, 2, out + i * 2, 2, count - i);
+}
+
+static void transformPointsSpan(const Matrix &matrix, const float *in, size_t inStride, float *out, size_t outStride, size_t count) {
+    if(inStride == 2 && outStride == 2) {
+        transformPointsPacked(matrix, in, out, count);
+    } else {
+        transformPointsScalar(matrix, in, inStride, out, outStride, count);
+    }
+}
+
+// Big spans (a whole particle system, a level's worth of tiles) get split up, small ones aren't worth a thread
+static void transformPointsParallel(const Matrix &matrix, const float *in, size_t inStride, float *out, size_t outStride, size_t count) {
+    if(count < MATRIX_PARALLEL_POINTS) {
+        transformPointsSpan(matrix, in, inStride, out, outStride, count);
+        return;
+    }
+    // asking for the core count isn't free, so only once we know the span is big
+    size_t threadCount = std::thread::hardware_concurrency();
+    if(threadCount > MATRIX_MAX_THREADS) {
+        threadCount = MATRIX_MAX_THREADS;
+    }
+    if(threadCount < 2) {
+        transformPointsSpan(matrix, in, inStride, out, outStride, count);
+        return;
+    }
+    
+    // Even chunks, this thread does the last one
+    size_t chunk = (count + threadCount - 1) / threadCount;
+    chunk += chunk % 2;
+    std::vector<std::thread> workers;
+    size_t start = 0;
+    for(; start + chunk < count; start += chunk) {
+        workers.push_back(std::thread(transformPointsSpan, std::cref(matrix), in + start * inStride, inStride, out + start * outStride, outStride, chunk));
+    }
+    transformPointsSpan(matrix, in + start * inStride, inStride, out + start * outStride, outStride, count - start);
+    for(size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+}
+
+void Matrix::transformPoints(const float *in, float *out, size_t count) const {
+    transformPointsParallel(*this, in, 2, out, 2, count);
+}
+
+void Matrix::transformPoints(const float *in, size_t inStride, float *out, size_t outStride, size_t count) const {
+    transformPointsParallel(*this, in, inStride, out, outStride, count);
+}
 
 void Matrix::setPosition(float x, float y, float z) {
     m[3][0] = x;
@@ -200,13 +724,13 @@ void Matrix::Scale(float x, float y, float z) {
 }
 
 void Matrix::setOrthoProjection(float left, float right, float bottom, float top, float zNear, float zFar) {
-    m[0][0] = 2.0f/(right-left);
-    m[1][1] = 2.0f/(top-bottom);
-    m[2][2] = -2.0f/(zFar-zNear);
-
-    m[3][0] = -((right+left)/(right-left));
-    m[3][1] = -((top+bottom)/(top-bottom));
-    m[3][2] = -((zFar+zNear)/(zFar-zNear));
+    m[0][0] = orthoScale(left, right);
+    m[1][1] = orthoScale(bottom, top);
+    m[2][2] = -orthoScale(zNear, zFar);
+    
+    m[3][0] = orthoOffset(left, right);
+    m[3][1] = orthoOffset(bottom, top);
+    m[3][2] = orthoOffset(zNear, zFar);
 }
 
 void Matrix::setPerspectiveProjection(float fov, float aspect, float zNear, float zFar) {    
@@ -0,0 +1,252 @@
+#include "TextureAtlas.h"
+#include <SDL_image.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string.h>
+
+// Gap between packed images so linear filtering doesn't pull in the neighbour's pixels
+#define ATLAS_PADDING 2
+
+static int nextPowerOfTwo(int value) {
+    int power = 1;
+    while(power < value) {
+        power *= 2;
+    }
+    return power;
+}
+
+TextureAtlas::TextureAtlas() : textureID(0), width(0), height(0) {
+    wholeAtlas.u = 0.0f;
+    wholeAtlas.v = 0.0f;
+    wholeAtlas.width = 1.0f;
+    wholeAtlas.height = 1.0f;
+    wholeAtlas.pixelWidth = 0;
+    wholeAtlas.pixelHeight = 0;
+}
+
+TextureAtlas::~TextureAtlas() {
+    for(size_t i = 0; i < sources.size(); i++) {
+        if(sources[i].surface) {
+            SDL_FreeSurface(sources[i].surface);
+        }
+    }
+}
+
+void TextureAtlas::addImage(const std::string &name, const std::string &imagePath) {
+    SDL_Surface *loaded = IMG_Load(imagePath.c_str());
+    
+    if(loaded == NULL){
+        printf("bad image\n");
+        exit(1);
+    }
+    
+    // Everything in the atlas is stored as BGRA bytes, same layout LoadTexture hands to GL
+    SDL_Surface *surface = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_ARGB8888, 0);
+    SDL_FreeSurface(loaded);
+    
+    Source source;
+    source.name = name;
+    source.surface = surface;
+    source.width = surface->w;
+    source.height = surface->h;
+    source.x = 0;
+    source.y = 0;
+    sources.push_back(source);
+}
+
+void TextureAtlas::addSprite(const std::string &name, const std::string &imageName, int x, int y, int width, int height) {
+    Sprite sprite;
+    sprite.name = name;
+    sprite.imageName = imageName;
+    sprite.x = x;
+    sprite.y = y;
+    sprite.width = width;
+    sprite.height = height;
+    sprites.push_back(sprite);
+}
+
+bool TextureAtlas::pack(int maxSize) {
+    if(sources.empty()) {
+        return false;
+    }
+    
+    // Tallest images first, then lay them out left to right on shelves
+    std::vector<int> order;
+    int widest = 0;
+    int tallest = 0;
+    for(size_t i = 0; i < sources.size(); i++) {
+        order.push_back((int)i);
+        widest = std::max(widest, sources[i].width);
+        tallest = std::max(tallest, sources[i].height);
+    }
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+        return sources[a].height > sources[b].height;
+    });
+    
+    int atlasWidth = nextPowerOfTwo(widest);
+    int atlasHeight = nextPowerOfTwo(tallest);
+    while(atlasWidth <= maxSize && atlasHeight <= maxSize) {
+        int shelfX = 0;
+        int shelfY = 0;
+        int shelfHeight = 0;
+        bool fits = true;
+        for(size_t i = 0; i < order.size(); i++) {
+            Source &source = sources[order[i]];
+            if(shelfX + source.width > atlasWidth) {
+                shelfX = 0;
+                shelfY += shelfHeight + ATLAS_PADDING;
+                shelfHeight = 0;
+            }
+            if(shelfY + source.height > atlasHeight) {
+                fits = false;
+                break;
+            }
+            source.x = shelfX;
+            source.y = shelfY;
+            shelfX += source.width + ATLAS_PADDING;
+            shelfHeight = std::max(shelfHeight, source.height);
+        }
+        if(fits) {
+            width = atlasWidth;
+            height = atlasHeight;
+            makeRegions();
+            return true;
+        }
+        // Didn't fit, grow the shorter side and try again
+        if(atlasWidth <= atlasHeight) {
+            atlasWidth *= 2;
+        } else {
+            atlasHeight *= 2;
+        }
+    }
+    printf("Images don't fit in a %dx%d atlas\n", maxSize, maxSize);
+    return false;
+}
+
+void TextureAtlas::makeRegions() {
+    wholeAtlas.pixelWidth = width;
+    wholeAtlas.pixelHeight = height;
+    regions.clear();
+    for(size_t i = 0; i < sources.size(); i++) {
+        AtlasRegion region;
+        region.u = (float)sources[i].x / (float)width;
+        region.v = (float)sources[i].y / (float)height;
+        region.width = (float)sources[i].width / (float)width;
+        region.height = (float)sources[i].height / (float)height;
+        region.pixelWidth = sources[i].width;
+        region.pixelHeight = sources[i].height;
+        regions[sources[i].name] = region;
+    }
+    for(size_t i = 0; i < sprites.size(); i++) {
+        for(size_t j = 0; j < sources.size(); j++) {
+            if(sources[j].name != sprites[i].imageName) {
+                continue;
+            }
+            AtlasRegion region;
+            region.u = (float)(sources[j].x + sprites[i].x) / (float)width;
+            region.v = (float)(sources[j].y + sprites[i].y) / (float)height;
+            region.width = (float)sprites[i].width / (float)width;
+            region.height = (float)sprites[i].height / (float)height;
+            region.pixelWidth = sprites[i].width;
+            region.pixelHeight = sprites[i].height;
+            regions[sprites[i].name] = region;
+        }
+    }
+}
+
+GLuint TextureAtlas::build(int maxSize) {
+    if(!pack(maxSize)) {
+        return 0;
+    }
+    
+    pixels.assign((size_t)width * height * 4, 0);
+    for(size_t i = 0; i < sources.size(); i++) {
+        SDL_Surface *surface = sources[i].surface;
+        for(int row = 0; row < surface->h; row++) {
+            unsigned char *from = (unsigned char *)surface->pixels + row * surface->pitch;
+            unsigned char *to = &pixels[((size_t)(sources[i].y + row) * width + sources[i].x) * 4];
+            memcpy(to, from, surface->w * 4);
+        }
+        // The pixels live in the atlas now
+        SDL_FreeSurface(surface);
+        sources[i].surface = NULL;
+    }
+    
+    upload(pixels.data());
+    return textureID;
+}
+
+void TextureAtlas::upload(const void *data) {
+    if(textureID == 0) {
+        glGenTextures(1, &textureID);
+    }
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_BGRA, GL_UNSIGNED_BYTE, data);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+}
+
+bool TextureAtlas::save(const std::string &imagePath, const std::string &tablePath) const {
+    if(pixels.empty()) {
+        return false;
+    }
+    SDL_Surface *surface = SDL_CreateRGBSurfaceFrom((void *)pixels.data(), width, height, 32, width * 4, 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
+    int result = SDL_SaveBMP(surface, imagePath.c_str());
+    SDL_FreeSurface(surface);
+    if(result != 0) {
+        return false;
+    }
+    
+    // One line per region: name u v width height pixelWidth pixelHeight
+    std::ofstream table(tablePath);
+    table << width << " " << height << "\n";
+    for(std::map<std::string, AtlasRegion>::const_iterator it = regions.begin(); it != regions.end(); ++it) {
+        const AtlasRegion &region = it->second;
+        table << it->first << " " << region.u << " " << region.v << " " << region.width << " " << region.height << " " << region.pixelWidth << " " << region.pixelHeight << "\n";
+    }
+    return table.good();
+}
+
+GLuint TextureAtlas::load(const std::string &imagePath, const std::string &tablePath) {
+    std::ifstream table(tablePath);
+    if(table.fail()) {
+        std::cout << "Error opening atlas table:" << tablePath << std::endl;
+        return 0;
+    }
+    table >> width >> height;
+    wholeAtlas.pixelWidth = width;
+    wholeAtlas.pixelHeight = height;
+    regions.clear();
+    std::string name;
+    AtlasRegion region;
+    while(table >> name >> region.u >> region.v >> region.width >> region.height >> region.pixelWidth >> region.pixelHeight) {
+        regions[name] = region;
+    }
+    
+    SDL_Surface *loaded = IMG_Load(imagePath.c_str());
+    if(loaded == NULL){
+        printf("bad image\n");
+        exit(1);
+    }
+    SDL_Surface *surface = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_ARGB8888, 0);
+    SDL_FreeSurface(loaded);
+    
+    pixels.assign((size_t)width * height * 4, 0);
+    for(int row = 0; row < surface->h && row < height; row++) {
+        memcpy(&pixels[(size_t)row * width * 4], (unsigned char *)surface->pixels + row * surface->pitch, std::min(surface->w, width) * 4);
+    }
+    SDL_FreeSurface(surface);
+    
+    upload(pixels.data());
+    return textureID;
+}
+
+const AtlasRegion &TextureAtlas::region(const std::string &name) const {
+    std::map<std::string, AtlasRegion>::const_iterator found = regions.find(name);
+    if(found == regions.end()) {
+        printf("No sprite called %s in the atlas\n", name.c_str());
+        return wholeAtlas;
+    }
+    return found->second;
+}
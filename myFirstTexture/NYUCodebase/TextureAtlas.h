@@ -0,0 +1,80 @@
+#pragma once
+
+#ifdef _WINDOWS
+	#include <GL/glew.h>
+#endif
+#include <SDL.h>
+#include <SDL_opengl.h>
+#include <string>
+#include <vector>
+#include <map>
+
+// Where a sprite ended up inside the atlas
+// u, v, width and height are texture coordinates, the pixel size is kept so sprites can keep their aspect
+struct AtlasRegion {
+    float u;
+    float v;
+    float width;
+    float height;
+    int pixelWidth;
+    int pixelHeight;
+};
+
+// Packs a handful of images into one texture so everything can be drawn without switching textures
+class TextureAtlas {
+    public:
+        TextureAtlas();
+        ~TextureAtlas();
+    
+        // Queue an image for the atlas, the whole image can be looked up by name afterwards
+        void addImage(const std::string &name, const std::string &imagePath);
+    
+        // Name a piece of an image that was added, in pixels of the original image
+        void addSprite(const std::string &name, const std::string &imageName, int x, int y, int width, int height);
+    
+        // Decide where every image goes, only uses the image sizes so it works without GL
+        bool pack(int maxSize);
+    
+        // Pack, copy every image into one buffer and upload it, returns the atlas texture
+        GLuint build(int maxSize);
+    
+        // Write the packed atlas and its lookup table so later runs can skip packing
+        bool save(const std::string &imagePath, const std::string &tablePath) const;
+    
+        // Load an atlas written by save()
+        GLuint load(const std::string &imagePath, const std::string &tablePath);
+    
+        const AtlasRegion &region(const std::string &name) const;
+    
+        GLuint textureID;
+        int width;
+        int height;
+    
+    private:
+        struct Source {
+            std::string name;
+            SDL_Surface *surface;
+            int width;
+            int height;
+            int x;
+            int y;
+        };
+    
+        struct Sprite {
+            std::string name;
+            std::string imageName;
+            int x;
+            int y;
+            int width;
+            int height;
+        };
+    
+        void makeRegions();
+        void upload(const void *pixels);
+    
+        std::vector<Source> sources;
+        std::vector<Sprite> sprites;
+        std::vector<unsigned char> pixels;
+        std::map<std::string, AtlasRegion> regions;
+        AtlasRegion wholeAtlas;
+};
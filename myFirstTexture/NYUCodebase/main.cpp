@@ -6,6 +6,7 @@
 #include <SDL_image.h>
 #include "ShaderProgram.h"
 #include "Matrix.h"
+#include "TextureAtlas.h"
 
 #ifdef _WINDOWS
 #define RESOURCE_FOLDER ""
@@ -64,14 +65,21 @@ int main(int argc, char *argv[])
     float lastFrameTicks = 0.0f;
     float angle = 0.0f;
     
-    // Load the textures our program is gonna use
-    GLuint fireTexture = LoadTexture(RESOURCE_FOLDER"images/fire2.png");
-    GLuint medalTexture = LoadTexture(RESOURCE_FOLDER"images/flat_medal9.png");
-    GLuint tileTexture = LoadTexture(RESOURCE_FOLDER"images/rpgTile181.png");
+    // Load the textures our program is gonna use, all three go into one atlas texture
+    TextureAtlas atlas;
+    atlas.addImage("fire", RESOURCE_FOLDER"images/fire2.png");
+    atlas.addImage("medal", RESOURCE_FOLDER"images/flat_medal9.png");
+    atlas.addImage("tile", RESOURCE_FOLDER"images/rpgTile181.png");
+    GLuint atlasTexture = atlas.build(1024);
+    const AtlasRegion &fire = atlas.region("fire");
+    const AtlasRegion &medal = atlas.region("medal");
+    const AtlasRegion &tile = atlas.region("tile");
     
     
     projectionMatrix.setOrthoProjection(-3.55, 3.55, -2.0f, 2.0f, -1.0f, 1.0f);
-    glUseProgram(program.programID);
+    program.use();
+    // Everything is in the atlas, so this is the only bind we need
+    glBindTexture(GL_TEXTURE_2D, atlasTexture);
     
     while (!done) {
         while (SDL_PollEvent(&event)) {
@@ -107,12 +115,13 @@ int main(int argc, char *argv[])
         glEnableVertexAttribArray(program.positionAttribute);
         
         // Now map a texture map to it
-        float texCoords[] = {0.0, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0, 0.0, 0.0, 1.0, 1.0, 1.0};
+        float texCoords[] = {
+            fire.u, fire.v+fire.height, fire.u+fire.width, fire.v, fire.u, fire.v,
+            fire.u+fire.width, fire.v, fire.u, fire.v+fire.height, fire.u+fire.width, fire.v+fire.height};
         glVertexAttribPointer(program.texCoordAttribute, 2, GL_FLOAT, false, 0, texCoords);
         glEnableVertexAttribArray(program.texCoordAttribute);
         
-        // Now get the actual texture loaded and draw the arrays out
-        glBindTexture(GL_TEXTURE_2D, fireTexture);
+        // Now draw the arrays out
         glDrawArrays(GL_TRIANGLES, 0, 6);
         
         glDisableVertexAttribArray(program.positionAttribute);
@@ -140,12 +149,13 @@ int main(int argc, char *argv[])
         glEnableVertexAttribArray(program.positionAttribute);
         
         // Now map a texture map to it
-        float secondTexture[] = {0.0, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0, 0.0, 0.0, 1.0, 1.0, 1.0};
+        float secondTexture[] = {
+            medal.u, medal.v+medal.height, medal.u+medal.width, medal.v, medal.u, medal.v,
+            medal.u+medal.width, medal.v, medal.u, medal.v+medal.height, medal.u+medal.width, medal.v+medal.height};
         glVertexAttribPointer(program.texCoordAttribute, 2, GL_FLOAT, false, 0, secondTexture);
         glEnableVertexAttribArray(program.texCoordAttribute);
         
-        // Now get the actual texture loaded and draw the arrays out
-        glBindTexture(GL_TEXTURE_2D, medalTexture);
+        // Now draw the arrays out
         glDrawArrays(GL_TRIANGLES, 0, 6);
         
         glDisableVertexAttribArray(program.positionAttribute);
@@ -173,12 +183,13 @@ int main(int argc, char *argv[])
         glEnableVertexAttribArray(program.positionAttribute);
         
         // Now map a texture map to it
-        float thirdTexture[] = {0.0, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0, 0.0, 0.0, 1.0, 1.0, 1.0};
+        float thirdTexture[] = {
+            tile.u, tile.v+tile.height, tile.u+tile.width, tile.v, tile.u, tile.v,
+            tile.u+tile.width, tile.v, tile.u, tile.v+tile.height, tile.u+tile.width, tile.v+tile.height};
         glVertexAttribPointer(program.texCoordAttribute, 2, GL_FLOAT, false, 0, thirdTexture);
         glEnableVertexAttribArray(program.texCoordAttribute);
         
-        // Now get the actual texture loaded and draw the arrays out
-        glBindTexture(GL_TEXTURE_2D, tileTexture);
+        // Now draw the arrays out
         glDrawArrays(GL_TRIANGLES, 0, 6);
         
         
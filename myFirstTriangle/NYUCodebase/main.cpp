@@ -48,7 +48,7 @@ int main(int argc, char *argv[])
         program.setProjectionMatrix(projectionMatrix);
         program.setViewMatrix(viewMatrix);
     
-        glUseProgram(program.programID);
+        program.use();
     
         float vertices[] = {0.5f, -0.5f, 0.0f, 0.5f, -0.5f, -0.5f};
         glVertexAttribPointer(program.positionAttribute, 2, GL_FLOAT, false, 0, vertices);
@@ -63,7 +63,7 @@ void DrawText(ShaderProgram *program, GLuint &fontTexture, std::string text, flo
     program->setModelMatrix(matrix);
     
     
-    glUseProgram(program->programID);
+    program->use();
     glBindTexture(GL_TEXTURE_2D, fontTexture);
     
     glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, 0, vertexData.data());
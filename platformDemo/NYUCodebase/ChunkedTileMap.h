@@ -0,0 +1,119 @@
+#pragma once
+
+#ifdef _WINDOWS
+	#include <GL/glew.h>
+#endif
+#include <SDL_opengl.h>
+#include <vector>
+#include "Matrix.h"
+#include "ShaderProgram.h"
+#include "QuadMesh.h"
+
+// Tiles per side of a chunk, a 640x360 window at our zoom levels sees at most a few chunks across
+#define CHUNK_TILES 16
+// Chunk textures the cache keeps by default, 64 MiB at 32 texels a tile. A window only sees a handful of chunks,
+// the rest lets the camera turn back without redrawing everything it just passed
+#define CHUNK_CACHE_TEXTURES 64
+
+/*
+    A tile layer cut into CHUNK_TILES x CHUNK_TILES chunks, each with its own buffer object.
+    A chunk's mesh is only built the first time it's on screen and again after one of its tiles changes,
+    and draw() only touches the chunks the camera can see, so a frame costs about the same whatever size the level is.
+    Tile x, y covers tileSize * x to tileSize * (x + 1) across and -tileSize * y down to -tileSize * (y + 1).
+    The meshes are QUAD_PACKED, corners in whole tiles as shorts that draw() scales up by tileSize.
+    With the cache on, each chunk is rendered once into a texture and drawn as a single quad after that. The textures
+    are a pool of at most maxTextures, a chunk coming on screen takes the one that's been off screen the longest,
+    so the memory doesn't grow with the size of the level.
+*/
+class ChunkedTileMap {
+    public:
+        ChunkedTileMap(float tileSize, int spriteCountX, int spriteCountY);
+    
+        // Throws away every tile and chunk, everything starts empty
+        void resize(int width, int height);
+    
+        // Draws straight from width * height sprite indices somebody else owns, like a mapped level file, instead of
+        // copying them. They have to stay around until the next resize or useTiles, the first setTile copies them
+        void useTiles(const int *tiles, int width, int height);
+    
+        // sprite is the index into the sprite sheet, -1 leaves the tile empty
+        void setTile(int x, int y, int sprite);
+        int getTile(int x, int y) const;
+    
+        // Draws the chunks that end up on screen with these matrices. modelMatrix is set on program here,
+        // program should already have the same view and projection set
+        void draw(ShaderProgram *program, GLuint textureID, const Matrix &modelMatrix, const Matrix &viewMatrix, const Matrix &projectionMatrix);
+    
+        // Frees the chunk buffers and cached textures, call it while the GL context is still around
+        void clear();
+    
+        // Draw every chunk from a texture it was rendered into, texelsPerTile across each tile, instead of tile by tile.
+        // A chunk's texture is only redrawn after one of its tiles changes or after it went to another chunk, at most
+        // maxTextures are kept (more only while more chunks than that are on screen at once). Can be switched any
+        // time, it stays off if the driver has no framebuffer objects
+        void setCached(bool enabled, int texelsPerTile = 32, int maxTextures = CHUNK_CACHE_TEXTURES);
+        bool cached() const;
+        static bool cacheSupported();
+    
+        int width;
+        int height;
+    
+        // What the last draw() did
+        int chunksDrawn;
+        int chunksBuilt;
+        int tilesDrawn;
+        int chunksBaked;
+        int chunksEvicted;
+    
+        // Bytes of vertices in every built chunk, and what the same tiles took as 6 float vertices each
+        int meshBytes() const;
+        int unindexedMeshBytes() const;
+        // Textures the cache holds right now and their size
+        int cacheTextures() const;
+        int cacheBytes() const;
+    
+    private:
+        struct Chunk {
+            Chunk() : mesh(QUAD_PACKED), dirty(true), cacheSlot(-1), cacheDirty(true) {}
+            QuadMesh mesh;
+            bool dirty;
+            // index into cacheSlots, -1 while the chunk has no texture
+            int cacheSlot;
+            bool cacheDirty;
+        };
+    
+        // A texture of the pool and the chunk drawn into it, lastDrawn is the draw() it was last on screen in
+        struct CacheSlot {
+            GLuint texture;
+            GLuint framebuffer;
+            int chunk;
+            unsigned int lastDrawn;
+        };
+    
+        void buildChunk(int chunkX, int chunkY);
+        void bakeChunk(ShaderProgram *program, GLuint textureID, int chunkX, int chunkY);
+        int takeCacheSlot(int chunkIndex);
+        void trimCache();
+        void buildCacheQuads();
+        void clearCache();
+        const int *tileData() const;
+    
+        float tileSize;
+        int spriteCountX;
+        int spriteCountY;
+        int chunksWide;
+        int chunksHigh;
+        std::vector<int> tiles;
+        // set by useTiles, tiles is empty while it is
+        const int *externalTiles;
+        std::vector<Chunk> chunks;
+    
+        bool useCache;
+        int cacheTexelsPerTile;
+        int cacheMaxTextures;
+        std::vector<CacheSlot> cacheSlots;
+        // counts draw() calls, for lastDrawn
+        unsigned int cacheFrame;
+        // one quad per chunk covering it, drawn with that chunk's texture
+        QuadMesh cacheQuads;
+};
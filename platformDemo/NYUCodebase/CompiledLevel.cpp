@@ -0,0 +1,334 @@
+#include "CompiledLevel.h"
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+#ifdef _WINDOWS
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+// Big enough for any level anyone is going to make, small enough that none of the sizes below can overflow
+#define LEVEL_MAX_SIDE (1 << 20)
+#define LEVEL_MAX_LAYERS 256
+
+static uint64_t alignUp(uint64_t offset) {
+    return (offset + LEVEL_FILE_ALIGN - 1) / LEVEL_FILE_ALIGN * LEVEL_FILE_ALIGN;
+}
+
+static uint64_t collisionRowWords(int width) {
+    return ((uint64_t)width + 63) / 64;
+}
+
+// The file is little endian and gets used as it is, so there's nothing to fix it up on anything else
+static bool littleEndian() {
+    uint32_t one = 1;
+    return *(const unsigned char *)&one == 1;
+}
+
+static void copyName(char *to, const std::string &from) {
+    memset(to, 0, LEVEL_NAME_LENGTH);
+    memcpy(to, from.data(), from.size() < LEVEL_NAME_LENGTH - 1 ? from.size() : LEVEL_NAME_LENGTH - 1);
+}
+
+CompiledLevel::CompiledLevel() : bytes(NULL), byteCount(0), mapping(NULL) {}
+
+CompiledLevel::~CompiledLevel() {
+    close();
+}
+
+bool CompiledLevel::isSolidLayer(const char *name) {
+    const char *solid = "solid";
+    for (int i = 0; solid[i]; i++) {
+        if (tolower((unsigned char)name[i]) != solid[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CompiledLevel::hashFile(const char *path, uint64_t &hash) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+    hash = 14695981039346656037ULL;
+    unsigned char buffer[65536];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        for (size_t i = 0; i < count; i++) {
+            hash = (hash ^ buffer[i]) * 1099511628211ULL;
+        }
+    }
+    bool ok = !ferror(file);
+    fclose(file);
+    return ok;
+}
+
+bool CompiledLevel::statFile(const char *path, uint64_t &size, int64_t &modified) {
+#ifdef _WINDOWS
+    WIN32_FILE_ATTRIBUTE_DATA info;
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &info)) {
+        return false;
+    }
+    size = ((uint64_t)info.nFileSizeHigh << 32) | info.nFileSizeLow;
+    // 100 ns steps since 1601, the same seconds stat() gives everywhere else
+    uint64_t time = ((uint64_t)info.ftLastWriteTime.dwHighDateTime << 32) | info.ftLastWriteTime.dwLowDateTime;
+    modified = (int64_t)(time / 10000000ULL) - 11644473600LL;
+#else
+    struct stat info;
+    if (stat(path, &info) != 0) {
+        return false;
+    }
+    size = (uint64_t)info.st_size;
+    modified = (int64_t)info.st_mtime;
+#endif
+    return true;
+}
+
+bool CompiledLevel::build(const TiledMap &map, const char *sourcePath) {
+    close();
+    if (!littleEndian() || map.width <= 0 || map.height <= 0 || map.width > LEVEL_MAX_SIDE || map.height > LEVEL_MAX_SIDE
+        || map.layers.size() > LEVEL_MAX_LAYERS) {
+        printf("A %dx%d map with %d layers can't be compiled\n", map.width, map.height, (int)map.layers.size());
+        return false;
+    }
+    uint64_t sourceHash = 0, sourceSize = 0;
+    int64_t sourceModified = 0;
+    if (sourcePath && (!statFile(sourcePath, sourceSize, sourceModified) || !hashFile(sourcePath, sourceHash))) {
+        printf("Couldn't read %s\n", sourcePath);
+        return false;
+    }
+    
+    // everything's position first, then one allocation for all of it
+    uint64_t tileCount = (uint64_t)map.width * map.height;
+    LevelFileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = LEVEL_FILE_MAGIC;
+    header.version = LEVEL_FILE_VERSION;
+    header.sourceHash = sourceHash;
+    header.sourceSize = sourceSize;
+    header.sourceModified = sourceModified;
+    header.width = map.width;
+    header.height = map.height;
+    header.tileWidth = map.tileWidth;
+    header.tileHeight = map.tileHeight;
+    header.layerCount = (uint32_t)map.layers.size();
+    header.objectCount = (uint32_t)map.objects.size();
+    header.layersOffset = alignUp(sizeof(LevelFileHeader));
+    header.objectsOffset = alignUp(header.layersOffset + header.layerCount * sizeof(LevelFileLayer));
+    uint64_t tilesOffset = alignUp(header.objectsOffset + header.objectCount * sizeof(LevelFileObject));
+    header.collisionOffset = alignUp(tilesOffset + header.layerCount * alignUp(tileCount * sizeof(int32_t)));
+    header.fileSize = header.collisionOffset + collisionRowWords(map.width) * map.height * sizeof(uint64_t);
+    
+    built.assign((size_t)(header.fileSize / sizeof(uint64_t)), 0);
+    unsigned char *out = (unsigned char *)built.data();
+    memcpy(out, &header, sizeof(header));
+    
+    LevelFileLayer *layers = (LevelFileLayer *)(out + header.layersOffset);
+    uint64_t *collision = (uint64_t *)(out + header.collisionOffset);
+    uint64_t rowWords = collisionRowWords(map.width);
+    for (uint32_t i = 0; i < header.layerCount; i++) {
+        const TiledLayer &source = map.layers[i];
+        copyName(layers[i].name, source.type);
+        layers[i].tilesOffset = tilesOffset + i * alignUp(tileCount * sizeof(int32_t));
+        int32_t *tiles = (int32_t *)(out + layers[i].tilesOffset);
+        // a layer without its data comes out empty rather than not at all, so layer numbers stay the same
+        bool hasData = source.data.size() == tileCount;
+        bool solid = isSolidLayer(layers[i].name);
+        for (int y = 0; y < map.height; y++) {
+            uint64_t *collisionRow = collision + y * rowWords;
+            for (int x = 0; x < map.width; x++) {
+                size_t t = (size_t)y * map.width + x;
+                // the map counts tiles from 1 with 0 for none, the sprite sheet counts from 0
+                int sprite = hasData && source.data[t] > 0 ? source.data[t] - 1 : -1;
+                tiles[t] = sprite;
+                if (solid && sprite >= 0) {
+                    collisionRow[x / 64] |= (uint64_t)1 << (x % 64);
+                }
+            }
+        }
+    }
+    LevelFileObject *objects = (LevelFileObject *)(out + header.objectsOffset);
+    for (uint32_t i = 0; i < header.objectCount; i++) {
+        copyName(objects[i].type, map.objects[i].type);
+        objects[i].x = map.objects[i].x;
+        objects[i].y = map.objects[i].y;
+    }
+    
+    bytes = out;
+    byteCount = (size_t)header.fileSize;
+    return true;
+}
+
+bool CompiledLevel::validate() const {
+    if (byteCount < sizeof(LevelFileHeader)) {
+        return false;
+    }
+    const LevelFileHeader &h = header();
+    if (h.magic != LEVEL_FILE_MAGIC || h.version != LEVEL_FILE_VERSION || h.fileSize != byteCount) {
+        return false;
+    }
+    if (h.width <= 0 || h.height <= 0 || h.width > LEVEL_MAX_SIDE || h.height > LEVEL_MAX_SIDE || h.layerCount > LEVEL_MAX_LAYERS) {
+        return false;
+    }
+    // every table has to be aligned and fit inside the file, then nothing that reads from them can go outside it
+    uint64_t tileBytes = (uint64_t)h.width * h.height * sizeof(int32_t);
+    uint64_t collisionBytes = collisionRowWords(h.width) * h.height * sizeof(uint64_t);
+    if (h.layersOffset % LEVEL_FILE_ALIGN || h.objectsOffset % LEVEL_FILE_ALIGN || h.collisionOffset % LEVEL_FILE_ALIGN
+        || h.layersOffset > byteCount || (byteCount - h.layersOffset) / sizeof(LevelFileLayer) < h.layerCount
+        || h.objectsOffset > byteCount || (byteCount - h.objectsOffset) / sizeof(LevelFileObject) < h.objectCount
+        || h.collisionOffset > byteCount || byteCount - h.collisionOffset < collisionBytes) {
+        return false;
+    }
+    for (uint32_t i = 0; i < h.layerCount; i++) {
+        const LevelFileLayer &l = layer(i);
+        if (l.name[LEVEL_NAME_LENGTH - 1] != 0 || l.tilesOffset % LEVEL_FILE_ALIGN || l.tilesOffset > byteCount || byteCount - l.tilesOffset < tileBytes) {
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < h.objectCount; i++) {
+        if (object(i).type[LEVEL_NAME_LENGTH - 1] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CompiledLevel::open(const char *path, const char *sourcePath) {
+    close();
+    if (!littleEndian()) {
+        printf("Compiled levels are little endian, %s can't be used here\n", path);
+        return false;
+    }
+#ifdef _WINDOWS
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        printf("Couldn't open level %s\n", path);
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    HANDLE fileMapping = NULL;
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+        fileMapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    }
+    // the mapped view keeps the file open on its own
+    CloseHandle(file);
+    if (fileMapping) {
+        mapping = MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(fileMapping);
+    }
+    if (!mapping) {
+        printf("Couldn't map level %s\n", path);
+        return false;
+    }
+    byteCount = (size_t)fileSize.QuadPart;
+#else
+    int file = ::open(path, O_RDONLY);
+    if (file < 0) {
+        printf("Couldn't open level %s\n", path);
+        return false;
+    }
+    struct stat info;
+    void *view = MAP_FAILED;
+    if (fstat(file, &info) == 0 && info.st_size > 0) {
+        view = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    }
+    // the mapping keeps the file open on its own
+    ::close(file);
+    if (view == MAP_FAILED) {
+        printf("Couldn't map level %s\n", path);
+        return false;
+    }
+    mapping = view;
+    byteCount = (size_t)info.st_size;
+#endif
+    bytes = (const unsigned char *)mapping;
+    if (!validate()) {
+        printf("%s isn't a version %d compiled level\n", path, LEVEL_FILE_VERSION);
+        close();
+        return false;
+    }
+    // an edited map is a different size or at least a newer one, there's no need to read it to tell
+    uint64_t sourceSize;
+    int64_t sourceModified;
+    if (sourcePath && statFile(sourcePath, sourceSize, sourceModified)
+        && (sourceSize != header().sourceSize || sourceModified != header().sourceModified)) {
+        printf("%s was compiled from an older %s\n", path, sourcePath);
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool CompiledLevel::write(const char *path) const {
+    if (!loaded()) {
+        return false;
+    }
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        printf("Couldn't create level %s\n", path);
+        return false;
+    }
+    bool ok = fwrite(bytes, byteCount, 1, file) == 1;
+    ok = fclose(file) == 0 && ok;
+    if (!ok) {
+        printf("Couldn't write level %s\n", path);
+    }
+    return ok;
+}
+
+void CompiledLevel::close() {
+    if (mapping) {
+#ifdef _WINDOWS
+        UnmapViewOfFile(mapping);
+#else
+        munmap(mapping, byteCount);
+#endif
+        mapping = NULL;
+    }
+    std::vector<uint64_t>().swap(built);
+    bytes = NULL;
+    byteCount = 0;
+}
+
+bool CompiledLevel::loaded() const {
+    return bytes != NULL;
+}
+
+const LevelFileHeader &CompiledLevel::header() const {
+    return *(const LevelFileHeader *)bytes;
+}
+
+const LevelFileLayer &CompiledLevel::layer(int index) const {
+    return ((const LevelFileLayer *)(bytes + header().layersOffset))[index];
+}
+
+const int *CompiledLevel::layerTiles(int index) const {
+    return (const int *)(bytes + layer(index).tilesOffset);
+}
+
+const LevelFileObject &CompiledLevel::object(int index) const {
+    return ((const LevelFileObject *)(bytes + header().objectsOffset))[index];
+}
+
+bool CompiledLevel::solid(int x, int y) const {
+    const LevelFileHeader &h = header();
+    if (x < 0 || y < 0 || x >= h.width || y >= h.height) {
+        return false;
+    }
+    const uint64_t *collision = (const uint64_t *)(bytes + h.collisionOffset);
+    return (collision[y * collisionRowWords(h.width) + x / 64] >> (x % 64)) & 1;
+}
+
+const unsigned char *CompiledLevel::data() const {
+    return bytes;
+}
+
+size_t CompiledLevel::size() const {
+    return byteCount;
+}
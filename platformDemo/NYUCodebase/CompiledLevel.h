@@ -0,0 +1,105 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "TiledMap.h"
+
+// "NLVL" when the first 4 bytes are read as a little endian int
+#define LEVEL_FILE_MAGIC 0x4c564c4e
+// Bump whenever anything below changes, files with any other version get turned away
+#define LEVEL_FILE_VERSION 3
+#define LEVEL_NAME_LENGTH 32
+// Every table and tile array starts on a multiple of this, so all of it can be read right where it's mapped
+#define LEVEL_FILE_ALIGN 16
+
+/*
+    A compiled level file is the header, the layer table, the object table, each layer's tiles and then the
+    collision bitmap, all little endian. Every offset counts from the start of the file.
+*/
+struct LevelFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t fileSize;
+    // hashFile() of the map it was compiled from, for compileLevel --check to tell a level that's older than its map
+    uint64_t sourceHash;
+    // statFile() of the same map, all the game looks at when it opens the level so it doesn't have to read the map
+    uint64_t sourceSize;
+    int64_t sourceModified;
+    int32_t width;
+    int32_t height;
+    int32_t tileWidth;
+    int32_t tileHeight;
+    uint32_t layerCount;
+    uint32_t objectCount;
+    uint64_t layersOffset;
+    uint64_t objectsOffset;
+    // one bit per tile, set where a solid layer has a tile. Each row is padded out to whole 64 bit words
+    uint64_t collisionOffset;
+};
+
+struct LevelFileLayer {
+    // 0 terminated, cut short if it had to be
+    char name[LEVEL_NAME_LENGTH];
+    // width * height sprite indices a row at a time, -1 where there's no tile
+    uint64_t tilesOffset;
+};
+
+struct LevelFileObject {
+    char type[LEVEL_NAME_LENGTH];
+    // in whole tiles, the same as TiledObject
+    int32_t x;
+    int32_t y;
+};
+
+/*
+    A level laid out exactly the way its compiled file is, either mapped straight from the file or built in memory
+    from a parsed map. Opening a file only checks the header and tables against its size, the tiles and the
+    collision bitmap aren't read until something uses them, so how long it takes doesn't depend on the level's size.
+    Layers whose name starts with "solid" (any case) are the ones that go into the collision bitmap.
+*/
+class CompiledLevel {
+    public:
+        CompiledLevel();
+        ~CompiledLevel();
+    
+        // Lays a parsed map out the way a file would have it, in memory the level owns. Given the file the map
+        // was loaded from, its hash, size and time go in the header, otherwise they're 0
+        bool build(const TiledMap &map, const char *sourcePath = NULL);
+        // Maps a compiled level file, false if it isn't one this version can use. Given the map it was compiled
+        // from, it's also false when that map's size or time has changed since, which only takes a stat() whatever
+        // the map's size. A map that isn't there is taken on trust
+        bool open(const char *path, const char *sourcePath = NULL);
+        bool write(const char *path) const;
+        void close();
+    
+        bool loaded() const;
+        const LevelFileHeader &header() const;
+        const LevelFileLayer &layer(int index) const;
+        const int *layerTiles(int index) const;
+        const LevelFileObject &object(int index) const;
+        // Outside the level isn't solid
+        bool solid(int x, int y) const;
+    
+        // The whole level, byte for byte what write() puts in a file
+        const unsigned char *data() const;
+        size_t size() const;
+    
+        static bool isSolidLayer(const char *name);
+        // 64 bit FNV-1a of the whole file, false if it can't be read
+        static bool hashFile(const char *path, uint64_t &hash);
+        // Size in bytes and last change in seconds since 1970, false if the file isn't there
+        static bool statFile(const char *path, uint64_t &size, int64_t &modified);
+    
+    private:
+        CompiledLevel(const CompiledLevel &);
+        CompiledLevel &operator=(const CompiledLevel &);
+    
+        bool validate() const;
+    
+        const unsigned char *bytes;
+        size_t byteCount;
+        // what build() made, 64 bit words so everything in it is aligned
+        std::vector<uint64_t> built;
+        void *mapping;
+};
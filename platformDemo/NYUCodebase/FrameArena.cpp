@@ -0,0 +1,45 @@
+#include "FrameArena.h"
+#include <algorithm>
+
+FrameArena::FrameArena(size_t floatCount) : blockUsed(0), used(0), highWater(0) {
+    blocks.push_back(std::vector<float>(floatCount));
+}
+
+float* FrameArena::allocate(size_t count) {
+    if (blockUsed + count > blocks.back().size()) {
+        blocks.push_back(std::vector<float>(std::max(count, blocks.back().size())));
+        blockUsed = 0;
+    }
+    float* memory = blocks.back().data() + blockUsed;
+    blockUsed += count;
+    used += count;
+    if (used > highWater) {
+        highWater = used;
+    }
+    return memory;
+}
+
+void FrameArena::reset() {
+    if (blocks.size() > 1) {
+        blocks.clear();
+        blocks.push_back(std::vector<float>(highWater));
+    }
+    blockUsed = 0;
+    used = 0;
+}
+
+size_t FrameArena::highWaterMark() const {
+    return highWater;
+}
+
+size_t FrameArena::highWaterBytes() const {
+    return highWater * sizeof(float);
+}
+
+size_t FrameArena::capacity() const {
+    size_t total = 0;
+    for (size_t i = 0; i < blocks.size(); i++) {
+        total += blocks[i].size();
+    }
+    return total;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+
+/*
+    Scratch space for the geometry of a single frame
+    Anything drawn this frame grabs its floats from here, and the whole thing is rewound at the top of the next frame.
+    If a frame needs more than we have, a new block is chained on and the next reset merges everything into one
+    block big enough for the high water mark, so after the first few frames nothing gets allocated at all.
+*/
+class FrameArena {
+    public:
+        FrameArena(size_t floatCount);
+    
+        // Hand out count floats that stay valid until the next reset
+        float* allocate(size_t count);
+    
+        // Called once at the top of every frame
+        void reset();
+    
+        // Most floats a single frame has needed so far
+        size_t highWaterMark() const;
+        size_t highWaterBytes() const;
+    
+        // Floats held right now, across every block
+        size_t capacity() const;
+    
+    private:
+        std::vector<std::vector<float>> blocks;
+        size_t blockUsed;
+        size_t used;
+        size_t highWater;
+};
+
+// What the game sizes its arena for. Only entities and text come out of it, the tiles live in the tile
+// map's chunk buffers. Each entity or character is one quad, 12 position floats and 12 texture coordinate floats
+#define ARENA_ENTITIES 16
+#define ARENA_TEXT_CHARACTERS 128
+#define ARENA_FLOATS ((ARENA_ENTITIES + ARENA_TEXT_CHARACTERS) * 24)
@@ -0,0 +1,132 @@
+#include "TileDataDecoder.h"
+#include <stdint.h>
+#include <string.h>
+
+// pshufb does the whole base64 alphabet lookup 16 characters at a time, anything older gets the table a group at a time
+#if !defined(TILE_DATA_NO_SIMD) && defined(__SSSE3__)
+    #include <tmmintrin.h>
+    #define BASE64_SSSE3
+#endif
+
+#define BASE64_SKIP -2
+#define BASE64_PAD -3
+#define BASE64_BAD -1
+
+static signed char base64Values[256];
+
+static void buildBase64Values() {
+    static bool built = false;
+    if (built) {
+        return;
+    }
+    memset(base64Values, BASE64_BAD, sizeof(base64Values));
+    const char *alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    for (int i = 0; i < 64; i++) {
+        base64Values[(unsigned char)alphabet[i]] = (signed char)i;
+    }
+    base64Values[(unsigned char)' '] = BASE64_SKIP;
+    base64Values[(unsigned char)'\t'] = BASE64_SKIP;
+    base64Values[(unsigned char)'\r'] = BASE64_SKIP;
+    base64Values[(unsigned char)'\n'] = BASE64_SKIP;
+    base64Values[(unsigned char)'='] = BASE64_PAD;
+    built = true;
+}
+
+#ifdef BASE64_SSSE3
+// 16 characters into 12 bytes, false if any of them isn't in the alphabet (whitespace, padding) so the caller can go slow
+// Sorts characters by their high and low nibbles, the same lookup tells which range they're in and what to add to get there
+static bool decodeBase64Block(const unsigned char *in, unsigned char *out) {
+    const __m128i lowLimits = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m128i highLimits = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m128i offsets = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i nibble = _mm_set1_epi8(0x0f);
+    
+    __m128i text = _mm_loadu_si128((const __m128i *)in);
+    __m128i high = _mm_and_si128(_mm_srli_epi32(text, 4), nibble);
+    __m128i low = _mm_and_si128(text, nibble);
+    __m128i invalid = _mm_and_si128(_mm_shuffle_epi8(lowLimits, low), _mm_shuffle_epi8(highLimits, high));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(invalid, _mm_setzero_si128())) != 0xffff) {
+        return false;
+    }
+    // '/' shares its high nibble with '+', it's the only one that needs its own offset
+    __m128i slash = _mm_cmpeq_epi8(text, _mm_set1_epi8('/'));
+    __m128i values = _mm_add_epi8(text, _mm_shuffle_epi8(offsets, _mm_add_epi8(slash, high)));
+    
+    // 6 bit values to 12 bit pairs to 24 bit groups, then drop the empty top byte of each
+    __m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+    __m128i groups = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+    __m128i bytes = _mm_shuffle_epi8(groups, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+    // writes 16, the last 4 get overwritten by the next block or are past what's reported as used
+    _mm_storeu_si128((__m128i *)out, bytes);
+    return true;
+}
+#endif
+
+long decodeBase64(const char *text, size_t length, unsigned char *out, size_t outSize) {
+    buildBase64Values();
+    const unsigned char *p = (const unsigned char *)text;
+    const unsigned char *end = p + length;
+    size_t written = 0;
+    uint32_t group = 0;
+    int count = 0;
+    while (p != end) {
+        if (count == 0) {
+#ifdef BASE64_SSSE3
+            while (end - p >= 16 && outSize - written >= 16 && decodeBase64Block(p, out + written)) {
+                p += 16;
+                written += 12;
+            }
+#endif
+            // four characters that are all in the alphabet, no whitespace or padding to worry about
+            while (end - p >= 4 && outSize - written >= 3) {
+                int a = base64Values[p[0]], b = base64Values[p[1]], c = base64Values[p[2]], d = base64Values[p[3]];
+                if ((a | b | c | d) < 0) {
+                    break;
+                }
+                uint32_t bits = (uint32_t)a << 18 | (uint32_t)b << 12 | (uint32_t)c << 6 | (uint32_t)d;
+                out[written] = (unsigned char)(bits >> 16);
+                out[written + 1] = (unsigned char)(bits >> 8);
+                out[written + 2] = (unsigned char)bits;
+                written += 3;
+                p += 4;
+            }
+            if (p == end) {
+                break;
+            }
+        }
+        int value = base64Values[*p++];
+        if (value == BASE64_SKIP) {
+            continue;
+        } else if (value == BASE64_PAD) {
+            break;
+        } else if (value == BASE64_BAD) {
+            return -1;
+        }
+        group = group << 6 | (uint32_t)value;
+        if (++count == 4) {
+            if (outSize - written < 3) {
+                return -1;
+            }
+            out[written] = (unsigned char)(group >> 16);
+            out[written + 1] = (unsigned char)(group >> 8);
+            out[written + 2] = (unsigned char)group;
+            written += 3;
+            group = 0;
+            count = 0;
+        }
+    }
+    // a last group cut short by padding still has a byte or two in it
+    if (count == 1) {
+        return -1;
+    } else if (count > 1) {
+        if (outSize - written < (size_t)(count - 1)) {
+            return -1;
+        }
+        group <<= 6 * (4 - count);
+        out[written++] = (unsigned char)(group >> 16);
+        if (count == 3) {
+            out[written++] = (unsigned char)(group >> 8);
+        }
+    }
+    return (long)written;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <stddef.h>
+
+/*
+    Base64, the text encoding Tiled can wrap a layer's tiles in, written straight into memory the caller owns
+    so a layer never exists as anything but its own tile array once it's loaded. Compressed layers are base64
+    around zlib or gzip data, TiledMap hands that to zlib itself.
+*/
+
+// Base64 text into out, whitespace anywhere in it is skipped. The number of bytes written, or -1 for a character
+// that isn't base64 or more data than out has room for
+long decodeBase64(const char *text, size_t length, unsigned char *out, size_t outSize);
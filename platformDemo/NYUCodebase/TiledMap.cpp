@@ -0,0 +1,475 @@
+#include "TiledMap.h"
+#include "TileDataDecoder.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <limits.h>
+#include <zlib.h>
+
+// The top bits of a tile id say whether it's flipped or rotated, nothing here draws tiles that way
+#define TILE_ID_MASK 0x0fffffff
+
+bool TextSpan::operator == (const char *text) const {
+    size_t length = strlen(text);
+    return (size_t)(end - begin) == length && memcmp(begin, text, length) == 0;
+}
+
+bool TextSpan::empty() const {
+    return begin == end;
+}
+
+std::string TextSpan::str() const {
+    return std::string(begin, end);
+}
+
+// Whole numbers only, like atoi but it has to be the entire span
+static bool toInt(const TextSpan &span, int &value) {
+    const char *p = span.begin;
+    bool negative = p != span.end && *p == '-';
+    if (negative) {
+        p++;
+    }
+    if (p == span.end) {
+        return false;
+    }
+    int result = 0;
+    for (; p != span.end; p++) {
+        if (*p < '0' || *p > '9') {
+            return false;
+        }
+        result = result * 10 + (*p - '0');
+    }
+    value = negative ? -result : result;
+    return true;
+}
+
+// Splits key=value, false if there's no =
+static bool splitKey(const TextSpan &line, TextSpan &key, TextSpan &value) {
+    const char *equals = (const char *)memchr(line.begin, '=', line.end - line.begin);
+    if (!equals) {
+        return false;
+    }
+    key = TextSpan(line.begin, equals);
+    value = TextSpan(equals + 1, line.end);
+    return true;
+}
+
+static bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+TiledMap::TiledMap() : width(-1), height(-1), tileWidth(0), tileHeight(0), cursor(NULL), end(NULL), tagEmpty(false) {}
+
+bool TiledMap::load(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        printf("Couldn't open map %s\n", path);
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    contents.resize(size > 0 ? size : 0);
+    bool ok = size <= 0 || fread(&contents[0], size, 1, file) == 1;
+    fclose(file);
+    if (!ok) {
+        printf("Couldn't read map %s\n", path);
+        return false;
+    }
+    return parse(contents.data(), contents.size());
+}
+
+bool TiledMap::nextLine(TextSpan &line) {
+    if (cursor == end) {
+        return false;
+    }
+    const char *newline = (const char *)memchr(cursor, '\n', end - cursor);
+    const char *lineEnd = newline ? newline : end;
+    line = TextSpan(cursor, lineEnd);
+    // files saved on windows
+    if (!line.empty() && line.end[-1] == '\r') {
+        line.end--;
+    }
+    cursor = newline ? newline + 1 : end;
+    return true;
+}
+
+bool TiledMap::readTiles(std::vector<int> &data) {
+    data.resize((size_t)width * height);
+    const unsigned char *p = (const unsigned char *)cursor;
+    const unsigned char *last = (const unsigned char *)end;
+    int *out = data.data();
+    for (size_t i = 0; i < data.size(); i++) {
+        // commas, spaces and line breaks between the numbers all get skipped the same way,
+        // anything else means the rows ran out early
+        unsigned digit;
+        while (p == last || (digit = *p - '0') > 9) {
+            if (p == last || (*p != ',' && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')) {
+                return false;
+            }
+            p++;
+        }
+        unsigned value = digit;
+        for (p++; p != last && (digit = *p - '0') <= 9; p++) {
+            value = value * 10 + digit;
+        }
+        out[i] = (int)value;
+    }
+    cursor = (const char *)p;
+    return true;
+}
+
+bool TiledMap::parse(const char *text, size_t length) {
+    cursor = text;
+    end = text + length;
+    width = -1;
+    height = -1;
+    layers.clear();
+    objects.clear();
+    
+    // the text export starts with [header], a .tmx with its <?xml line
+    const char *first = text;
+    while (first != end && isSpace(*first)) {
+        first++;
+    }
+    if (first != end && *first == '<') {
+        return parseTMX();
+    }
+    
+    // anything in brackets that isn't one of ours is an object group, the export names the section after it
+    enum Section { NONE, HEADER, LAYER, OBJECTS } section = NONE;
+    // objects are a # name line and then their keys, the next one starts at the next # or blank line
+    bool objectOpen = false;
+    TextSpan line, key, value;
+    while (nextLine(line)) {
+        if (line.empty()) {
+            if (section != OBJECTS) {
+                section = NONE;
+            }
+            objectOpen = false;
+        } else if (line == "[header]") {
+            section = HEADER;
+        } else if (line == "[layer]") {
+            // tiles can't be read without knowing how many there are
+            if (width <= 0 || height <= 0) {
+                return false;
+            }
+            section = LAYER;
+            layers.push_back(TiledLayer());
+        } else if (line == "[tilesets]") {
+            section = NONE;
+        } else if (line.begin[0] == '[') {
+            section = OBJECTS;
+            objectOpen = false;
+        } else if (line.begin[0] == '#') {
+            objectOpen = false;
+        } else if (!splitKey(line, key, value)) {
+            continue;
+        } else if (section == HEADER) {
+            if (key == "width") {
+                toInt(value, width);
+            } else if (key == "height") {
+                toInt(value, height);
+            } else if (key == "tilewidth") {
+                toInt(value, tileWidth);
+            } else if (key == "tileheight") {
+                toInt(value, tileHeight);
+            }
+        } else if (section == LAYER) {
+            if (key == "type") {
+                layers.back().type = value.str();
+            } else if (key == "data") {
+                if (!readTiles(layers.back().data)) {
+                    printf("Map layer %s ends before its %dx%d tiles do\n", layers.back().type.c_str(), width, height);
+                    return false;
+                }
+                // the rest of the last row
+                TextSpan rest;
+                nextLine(rest);
+            }
+        } else if (section == OBJECTS && (key == "type" || key == "location")) {
+            if (!objectOpen) {
+                TiledObject object = {"", 0, 0};
+                objects.push_back(object);
+                objectOpen = true;
+            }
+            if (key == "type") {
+                objects.back().type = value.str();
+            } else {
+                // x,y,width,height, only where it starts gets used
+                const char *comma = (const char *)memchr(value.begin, ',', value.end - value.begin);
+                const char *second = comma ? (const char *)memchr(comma + 1, ',', value.end - comma - 1) : NULL;
+                toInt(TextSpan(value.begin, comma ? comma : value.end), objects.back().x);
+                if (comma) {
+                    toInt(TextSpan(comma + 1, second ? second : value.end), objects.back().y);
+                }
+            }
+        }
+    }
+    return width > 0 && height > 0;
+}
+
+bool TiledMap::nextTag(TextSpan &name) {
+    while (true) {
+        const char *open = (const char *)memchr(cursor, '<', end - cursor);
+        if (!open || open + 1 == end) {
+            cursor = end;
+            return false;
+        }
+        cursor = open + 1;
+        if (*cursor == '!' || *cursor == '?') {
+            // the <?xml line, comments and doctypes, none of them hold anything we want
+            bool comment = end - cursor >= 3 && cursor[1] == '-' && cursor[2] == '-';
+            const char *close = cursor;
+            while ((close = (const char *)memchr(close, '>', end - close)) && comment && (close - cursor < 5 || close[-1] != '-' || close[-2] != '-')) {
+                close++;
+            }
+            cursor = close ? close + 1 : end;
+            continue;
+        }
+        // closing tags keep their / so they can't be mistaken for opening ones
+        const char *start = cursor;
+        if (*cursor == '/') {
+            cursor++;
+        }
+        while (cursor != end && !isSpace(*cursor) && *cursor != '>' && *cursor != '/') {
+            cursor++;
+        }
+        name = TextSpan(start, cursor);
+        tagEmpty = false;
+        return true;
+    }
+}
+
+bool TiledMap::nextAttribute(TextSpan &name, TextSpan &value) {
+    while (cursor != end && isSpace(*cursor)) {
+        cursor++;
+    }
+    if (cursor == end) {
+        return false;
+    }
+    if (*cursor == '/' || *cursor == '>') {
+        tagEmpty = *cursor == '/';
+        const char *close = (const char *)memchr(cursor, '>', end - cursor);
+        cursor = close ? close + 1 : end;
+        return false;
+    }
+    const char *start = cursor;
+    while (cursor != end && *cursor != '=' && !isSpace(*cursor) && *cursor != '>' && *cursor != '/') {
+        cursor++;
+    }
+    name = TextSpan(start, cursor);
+    value = TextSpan();
+    while (cursor != end && isSpace(*cursor)) {
+        cursor++;
+    }
+    if (cursor == end || *cursor != '=') {
+        return true;
+    }
+    cursor++;
+    while (cursor != end && isSpace(*cursor)) {
+        cursor++;
+    }
+    if (cursor == end || (*cursor != '"' && *cursor != '\'')) {
+        return true;
+    }
+    const char *close = (const char *)memchr(cursor + 1, *cursor, end - cursor - 1);
+    value = TextSpan(cursor + 1, close ? close : end);
+    cursor = close ? close + 1 : end;
+    return true;
+}
+
+// zlib or gzip wrapped deflate data into exactly outSize bytes. zlib tells the two apart from the header and checks
+// the adler32 or crc32 at the end, so a damaged layer fails here instead of loading as the wrong tiles
+static bool inflateTiles(const unsigned char *data, size_t length, unsigned char *out, size_t outSize) {
+    if (length > UINT_MAX || outSize > UINT_MAX) {
+        return false;
+    }
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    // 15 bit window, plus 32 to take either header
+    if (inflateInit2(&stream, 15 + 32) != Z_OK) {
+        return false;
+    }
+    stream.next_in = (Bytef *)data;
+    stream.avail_in = (uInt)length;
+    stream.next_out = out;
+    stream.avail_out = (uInt)outSize;
+    // one call with all of it, anything short of the end of the stream is either damaged or too big for out
+    int result = inflate(&stream, Z_FINISH);
+    bool complete = result == Z_STREAM_END && stream.total_out == outSize;
+    inflateEnd(&stream);
+    return complete;
+}
+
+bool TiledMap::readEncodedTiles(std::vector<int> &data, const TextSpan &encoding, const TextSpan &compression) {
+    data.resize((size_t)width * height);
+    if (encoding == "csv") {
+        if (!readTiles(data)) {
+            return false;
+        }
+        for (size_t i = 0; i < data.size(); i++) {
+            data[i] &= TILE_ID_MASK;
+        }
+        return true;
+    } else if (encoding.empty()) {
+        // no encoding at all is a <tile gid=""/> for every tile
+        size_t count = 0;
+        TextSpan tag, name, value;
+        while (nextTag(tag) && !(tag == "/data")) {
+            bool isTile = tag == "tile";
+            int id = 0;
+            while (nextAttribute(name, value)) {
+                if (isTile && name == "gid") {
+                    id = (int)(strtoul(value.begin, NULL, 10) & TILE_ID_MASK);
+                }
+            }
+            if (isTile) {
+                if (count == data.size()) {
+                    return false;
+                }
+                data[count++] = id;
+            }
+        }
+        return count == data.size();
+    } else if (!(encoding == "base64")) {
+        printf("Map layer encoding %s isn't supported\n", encoding.str().c_str());
+        return false;
+    }
+    
+    const char *close = (const char *)memchr(cursor, '<', end - cursor);
+    TextSpan text(cursor, close ? close : end);
+    cursor = text.end;
+    // the ids get decoded right on top of the tile array and then fixed up where they are
+    unsigned char *bytes = (unsigned char *)data.data();
+    size_t byteCount = data.size() * sizeof(int);
+    if (compression.empty()) {
+        if (decodeBase64(text.begin, text.end - text.begin, bytes, byteCount) != (long)byteCount) {
+            return false;
+        }
+    } else if (compression == "zlib" || compression == "gzip") {
+        std::vector<unsigned char> packed((text.end - text.begin) / 4 * 3 + 3);
+        long packedSize = decodeBase64(text.begin, text.end - text.begin, packed.data(), packed.size());
+        if (packedSize < 0 || !inflateTiles(packed.data(), packedSize, bytes, byteCount)) {
+            return false;
+        }
+    } else {
+        printf("Map layer compression %s isn't supported\n", compression.str().c_str());
+        return false;
+    }
+    // 32 bit little endian in the file whatever this machine is
+    for (size_t i = 0; i < data.size(); i++) {
+        const unsigned char *id = bytes + i * sizeof(int);
+        uint32_t value = (uint32_t)id[0] | (uint32_t)id[1] << 8 | (uint32_t)id[2] << 16 | (uint32_t)id[3] << 24;
+        data[i] = (int)(value & TILE_ID_MASK);
+    }
+    return true;
+}
+
+bool TiledMap::parseTMX() {
+    bool inLayer = false, inObjectGroup = false, inTileset = false;
+    TextSpan tag, name, value;
+    while (nextTag(tag)) {
+        if (tag == "map") {
+            bool infinite = false;
+            while (nextAttribute(name, value)) {
+                if (name == "width") {
+                    toInt(value, width);
+                } else if (name == "height") {
+                    toInt(value, height);
+                } else if (name == "tilewidth") {
+                    toInt(value, tileWidth);
+                } else if (name == "tileheight") {
+                    toInt(value, tileHeight);
+                } else if (name == "infinite") {
+                    infinite = value == "1";
+                }
+            }
+            if (infinite) {
+                printf("Infinite maps are saved in chunks, only fixed size ones can be loaded\n");
+                return false;
+            }
+        } else if (tag == "layer") {
+            // tiles can't be read without knowing how many there are
+            if (width <= 0 || height <= 0) {
+                return false;
+            }
+            layers.push_back(TiledLayer());
+            int layerWidth = width, layerHeight = height;
+            while (nextAttribute(name, value)) {
+                if (name == "name") {
+                    layers.back().type = value.str();
+                } else if (name == "width") {
+                    toInt(value, layerWidth);
+                } else if (name == "height") {
+                    toInt(value, layerHeight);
+                }
+            }
+            if (layerWidth != width || layerHeight != height) {
+                printf("Map layer %s is %dx%d, only layers the size of the map are supported\n", layers.back().type.c_str(), layerWidth, layerHeight);
+                return false;
+            }
+            inLayer = !tagEmpty;
+        } else if (tag == "data" && inLayer) {
+            TextSpan encoding, compression;
+            while (nextAttribute(name, value)) {
+                if (name == "encoding") {
+                    encoding = value;
+                } else if (name == "compression") {
+                    compression = value;
+                }
+            }
+            if (!readEncodedTiles(layers.back().data, encoding, compression)) {
+                printf("Map layer %s doesn't have %dx%d tiles in it\n", layers.back().type.c_str(), width, height);
+                return false;
+            }
+        } else if (tag == "object" && inObjectGroup) {
+            TiledObject object = {"", 0, 0};
+            TextSpan objectName;
+            float x = 0.0f, y = 0.0f;
+            bool isTile = false;
+            while (nextAttribute(name, value)) {
+                if (name == "type" || name == "class") {
+                    object.type = value.str();
+                } else if (name == "name") {
+                    objectName = value;
+                } else if (name == "x") {
+                    x = strtof(value.begin, NULL);
+                } else if (name == "y") {
+                    y = strtof(value.begin, NULL);
+                } else if (name == "gid") {
+                    isTile = true;
+                }
+            }
+            if (object.type.empty()) {
+                object.type = objectName.str();
+            }
+            // pixels to the whole tiles the text export uses, tile objects hang up from their bottom edge
+            float unitX = (float)(tileWidth > 0 ? tileWidth : 1);
+            float unitY = (float)(tileHeight > 0 ? tileHeight : 1);
+            if (isTile) {
+                y -= unitY;
+            }
+            object.x = (int)floorf(x / unitX + 0.5f);
+            object.y = (int)floorf(y / unitY + 0.5f);
+            objects.push_back(object);
+        } else {
+            while (nextAttribute(name, value)) {}
+            // tilesets have object groups of their own for collision shapes, those aren't objects in the level
+            if (tag == "tileset") {
+                inTileset = !tagEmpty;
+            } else if (tag == "/tileset") {
+                inTileset = false;
+            } else if (tag == "objectgroup") {
+                inObjectGroup = !inTileset && !tagEmpty;
+            } else if (tag == "/objectgroup") {
+                inObjectGroup = false;
+            } else if (tag == "/layer") {
+                inLayer = false;
+            }
+        }
+    }
+    return width > 0 && height > 0;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// A piece of a loaded map file, only good while the file's buffer is around
+struct TextSpan {
+    TextSpan() : begin(NULL), end(NULL) {}
+    TextSpan(const char *begin, const char *end) : begin(begin), end(end) {}
+    
+    bool operator == (const char *text) const;
+    bool empty() const;
+    std::string str() const;
+    
+    const char *begin;
+    const char *end;
+};
+
+struct TiledLayer {
+    std::string type;
+    // width * height tile ids a row at a time, as they are in the file so 0 is no tile and the rest count from 1
+    std::vector<int> data;
+};
+
+struct TiledObject {
+    std::string type;
+    // location= straight from the file, in whole tiles. A .tmx has pixels and they get rounded to the same thing
+    int x;
+    int y;
+};
+
+/*
+    A Tiled map, either the text export with [header], [layer] and object group sections of key=value lines
+    or the .tmx Tiled saves itself, told apart by how the file starts.
+    The whole file is read with one fread and parsed in one pass over the buffer without copying it into
+    lines or strings, so each layer's data is the only allocation no matter how big the map is.
+    A .tmx gets the same one pass treatment, tags and attributes are picked out of the buffer as they go by
+    and base64 layers, zlib or gzip compressed or not, are decoded straight into the layer's tile array.
+    Every tile layer and every object in an object group is kept, objects belonging to tilesets aren't.
+*/
+class TiledMap {
+    public:
+        TiledMap();
+    
+        bool load(const char *path);
+        // Parses a map that's already in memory, false if the header or a layer's data is missing or cut short
+        bool parse(const char *text, size_t length);
+    
+        int width;
+        int height;
+        int tileWidth;
+        int tileHeight;
+        std::vector<TiledLayer> layers;
+        std::vector<TiledObject> objects;
+    
+    private:
+        bool nextLine(TextSpan &line);
+        bool readTiles(std::vector<int> &data);
+    
+        bool parseTMX();
+        // Moves past the next tag's name, the attributes after it are read with nextAttribute until it returns false
+        bool nextTag(TextSpan &name);
+        bool nextAttribute(TextSpan &name, TextSpan &value);
+        bool readEncodedTiles(std::vector<int> &data, const TextSpan &encoding, const TextSpan &compression);
+    
+        std::string contents;
+        const char *cursor;
+        const char *end;
+        // whether the last tag read ended with />
+        bool tagEmpty;
+};
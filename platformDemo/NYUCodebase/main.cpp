@@ -6,6 +6,10 @@
 #include <SDL_image.h>
 #include "Matrix.h"
 #include "ShaderProgram.h"
+#include "ChunkedTileMap.h"
+#include "TiledMap.h"
+#include "CompiledLevel.h"
+#include "FrameArena.h"
 #include <vector>
 
 #ifdef _WINDOWS
@@ -14,10 +18,9 @@
 #define RESOURCE_FOLDER "NYUCodebase.app/Contents/Resources/"
 #endif
 
-#include <fstream>
 #include <string>
 #include <iostream>
-#include <sstream>
+#include <algorithm>
 
 #define SPRITE_COUNT_X 30
 #define SPRITE_COUNT_Y 30
@@ -34,6 +37,12 @@ using namespace std;
 
 SDL_Window* displayWindow;
 
+// The camera always shows the same slice of the world, so its projection is worked out at compile time
+constexpr Matrix screenProjection = Matrix::orthoProjection(-3.55f, 3.55f, -2.0f, 2.0f, -1.0f, 1.0f);
+
+// Every frame's entity and text quads come out of here, rewound at the top of the game loop
+FrameArena frameArena(ARENA_FLOATS);
+
 // Load desired texture into the program
 GLuint LoadTexture(const char *image_path) {
     SDL_Surface *surface = IMG_Load(image_path);
@@ -55,39 +64,42 @@ GLuint LoadTexture(const char *image_path) {
 
 void DrawText(ShaderProgram *program, GLuint &fontTexture, std::string text, float size, float spacing, float xCord, float yCord, Matrix &matrix) {
     float texture_size = 1.0/16.0f;
-    std::vector<float> vertexData;
-    std::vector<float> texCoordData;
+    float *vertexData = frameArena.allocate(text.size() * 12);
+    float *texCoordData = frameArena.allocate(text.size() * 12);
     for(int i=0; i < text.size(); i++) {
         float texture_x = (float)(((int)text[i]) % 16) / 16.0f;
         float texture_y = (float)(((int)text[i]) / 16) / 16.0f;
-        vertexData.insert(vertexData.end(), {
+        float quad[] = {
             ((size+spacing) * i) + (-0.5f * size), 0.5f * size,
             ((size+spacing) * i) + (-0.5f * size), -0.5f * size,
             ((size+spacing) * i) + (0.5f * size), 0.5f * size,
             ((size+spacing) * i) + (0.5f * size), -0.5f * size,
             ((size+spacing) * i) + (0.5f * size), 0.5f * size,
             ((size+spacing) * i) + (-0.5f * size), -0.5f * size,
-        });
-        texCoordData.insert(texCoordData.end(), {
+        };
+        float quadTexts[] = {
             texture_x, texture_y,
             texture_x, texture_y + texture_size,
             texture_x + texture_size, texture_y,
             texture_x + texture_size, texture_y + texture_size,
             texture_x + texture_size, texture_y,
             texture_x, texture_y + texture_size,
-        }); }
+        };
+        copy(quad, quad + 12, vertexData + i * 12);
+        copy(quadTexts, quadTexts + 12, texCoordData + i * 12);
+    }
     matrix.identity();
     matrix.Translate(xCord, yCord, 0.0f);
     program->setModelMatrix(matrix);
     
     
-    glUseProgram(program->programID);
+    program->use();
     glBindTexture(GL_TEXTURE_2D, fontTexture);
     
-    glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, 0, vertexData.data());
+    glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, 0, vertexData);
     glEnableVertexAttribArray(program->positionAttribute);
     
-    glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, 0, texCoordData.data());
+    glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, 0, texCoordData);
     glEnableVertexAttribArray(program->texCoordAttribute);
     
     glDrawArrays(GL_TRIANGLES, 0, (float)(text.size() * 6));
@@ -133,8 +145,6 @@ public:
     
     // Sprite positioning
     int spritePos;
-    vector<float> tileVerts;
-    vector<float> tileTexts;
 
     
     // Position the object
@@ -152,35 +162,39 @@ public:
                 
         float spriteWidth = 1.0f / (float) SPRITE_COUNT_X;
         float spriteHeight = 1.0f / (float) SPRITE_COUNT_Y;
-                
-        tileVerts.insert(tileVerts.end(), {
+        
+        // Only this frame's quad, the old vectors here kept every frame's quad forever
+        float *tileVerts = frameArena.allocate(12);
+        float *tileTexts = frameArena.allocate(12);
+        float quad[] = {
             TILE_SIZE * x, -TILE_SIZE * y,
             TILE_SIZE * x, (-TILE_SIZE * y)-TILE_SIZE,
             (TILE_SIZE * x)+TILE_SIZE, (-TILE_SIZE * y)-TILE_SIZE,
             TILE_SIZE * x, -TILE_SIZE * y,
             (TILE_SIZE * x)+TILE_SIZE, (-TILE_SIZE * y)-TILE_SIZE,
             (TILE_SIZE * x)+TILE_SIZE, -TILE_SIZE * y
-        });
-                
-        tileTexts.insert(tileTexts.end(), {
+        };
+        float quadTexts[] = {
             u, v,
             u, v+(spriteHeight),
             u+spriteWidth, v+(spriteHeight),
             u, v,
             u+spriteWidth, v+(spriteHeight),
             u+spriteWidth, v
-        });
+        };
+        copy(quad, quad + 12, tileVerts);
+        copy(quadTexts, quadTexts + 12, tileTexts);
         
         // Map the vertex array to position attribute
-        glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, 0, tileVerts.data());
+        glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, 0, tileVerts);
         glEnableVertexAttribArray(program->positionAttribute);
         
         // Map the texture array to the texture coordinate reader
-        glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, 0, tileTexts.data());
+        glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, 0, tileTexts);
         glEnableVertexAttribArray(program->texCoordAttribute);
         
         // Then actually draw it
-        glDrawArrays(GL_TRIANGLES, 0, ( (int)tileVerts.size() / 2));
+        glDrawArrays(GL_TRIANGLES, 0, 6);
         
         glDisableVertexAttribArray(program->positionAttribute);
         glDisableVertexAttribArray(program->texCoordAttribute);
@@ -204,142 +218,83 @@ public:
 
     // Constructor
     Map(GLuint textureID):
-    textureID(textureID){}
+    textureID(textureID), tileMap(TILE_SIZE, SPRITE_COUNT_X, SPRITE_COUNT_Y){}
     // fields for the map
     int mapWidth;
     int mapHeight;
     int tileWidth;
     int tileHeight;
-    unsigned char **levelData;
+    // Tiles, objects and which tiles are solid, the tile map draws straight out of it
+    CompiledLevel level;
     
     // Testing
     float x = 0;
     float y = 0;
     
-    // Tile Verts
-    std::vector<float> tileVerts;
-    std::vector<float> tileTexts;
-    
     // spritesheet
     GLuint textureID;
     
+    // the level's tiles cut into chunks that stay on the GPU, only the ones on screen get drawn
+    ChunkedTileMap tileMap;
+    
     // maybe keep a vector of entities in the map
     
-    bool readHeader(ifstream& levelFile){
-        string line;
-        mapWidth = -1;
-        mapHeight = -1;
-        while(getline(levelFile, line)) {
-            if(line == "") { break; }
-            istringstream sStream(line);
-            string key,value;
-            getline(sStream, key, '=');
-            getline(sStream, value);
-            if(key == "width") {
-                mapWidth = atoi(value.c_str());
-            }
-                else if(key == "height"){
-                    mapHeight = atoi(value.c_str());
-                }
-                else if (key == "tilewidth"){
-                    tileWidth = atoi(value.c_str());
-                }
-                else if (key == "tileheight"){
-                    tileHeight = atoi(value.c_str());
-                }
-        }
-        if(mapWidth == -1 || mapHeight == -1) {
-            return false;
-        } else { // allocate our map data
-            levelData = new unsigned char*[mapHeight];
-            for(int i = 0; i < mapHeight; ++i) {
-                levelData[i] = new unsigned char[mapWidth];
-            }
-            return true;
-        }
+    bool readHeader(const LevelFileHeader& header){
+        mapWidth = header.width;
+        mapHeight = header.height;
+        tileWidth = header.tileWidth;
+        tileHeight = header.tileHeight;
+        return mapWidth > 0 && mapHeight > 0;
+    }
+    // The tile map draws straight out of the level, whether that's a mapped file or one built from a text map
+    bool readLayerData(int layer){
+        tileMap.useTiles(level.layerTiles(layer), mapWidth, mapHeight);
+        return true;
     }
-    bool readLayerData(std::ifstream& levelFile){
-        string line;
-            while(getline(levelFile, line)) {
-                if(line == "") { break; }
-                istringstream sStream(line);
-                string key,value;
-                getline(sStream, key, '=');
-                getline(sStream, value);
-                if(key == "data") {
-                    for(int y=0; y < mapHeight; y++) {
-                        getline(levelFile, line);
-                        istringstream lineStream(line);
-                        string tile;
-                        for(int x=0; x < mapWidth; x++) {
-                            getline(lineStream, tile, ',');
-                            unsigned char val =  (unsigned char)atoi(tile.c_str());
-                            if(val > 0) {
-        // be careful, the tiles in this format are indexed from 1 not 0
-                                levelData[y][x] = val-1;
-                            } else {
-                                levelData[y][x] = 0;
-                            }
-                        }
-                    }
-                }
-            }
-            return true;
-        }
     // maybe store the player in an vector of entities, or for this particular assignment just hardcode it
     Entity player;
-    // Place entity where it belongs in levelData
+    // Place entity where it belongs in the level
     void placeEntity(std::string& type, float placeX, float placeY){
         player = Entity(50, placeX, placeY, textureID);
     }
 
-    bool readEntityData(std::ifstream& levelFile){
-        string line;
-        string type;
-        while(getline(levelFile, line)) {
-            if(line == "") { break; }
-            istringstream sStream(line);
-            string key,value;
-            getline(sStream, key, '=');
-            getline(sStream, value);
-            if(key == "type") {
-                type = value;
-            } else if(key == "location") {
-                istringstream lineStream(value);
-                string xPosition, yPosition;
-                getline(lineStream, xPosition, ',');
-                getline(lineStream, yPosition, ',');
-                float placeX = atoi(xPosition.c_str())/tileWidth * TILE_SIZE;
-                float placeY = atoi(yPosition.c_str())/tileHeight*-TILE_SIZE;
-                placeEntity(type, placeX, placeY);
-            }
-        }
+    bool readEntityData(const LevelFileObject& object){
+        std::string type = object.type;
+        float placeX = object.x/tileWidth * TILE_SIZE;
+        float placeY = object.y/tileHeight*-TILE_SIZE;
+        placeEntity(type, placeX, placeY);
         return true;
     }
 
-    void readMapFile(string& levelFile){
-        ifstream infile(levelFile);
-    
-        string line;
-        while(getline(infile, line)){
-            if (line == "[header]"){
-                if(!readHeader(infile)){
-                    return;
-                }
-            } else
-            if (line == "[layer]"){
-                readLayerData(infile);
-            } else
-            if (line == "[object]"){
-                readEntityData(infile);
+    // Compiled levels (see tools/compileLevel.cpp) get mapped and used as they are, nothing in them is parsed.
+    // Given the map a level was compiled from, the level is turned down if the map's size or time has changed since.
+    // .txt exports and .tmx are parsed by TiledMap and laid out in memory the same way
+    bool readMapFile(string& levelFile, const char *sourceFile = NULL){
+        if(levelFile.size() > 4 && levelFile.compare(levelFile.size() - 4, 4, ".lvl") == 0){
+            if(!level.open(levelFile.c_str(), sourceFile)){
+                return false;
+            }
+        } else {
+            TiledMap map;
+            if(!map.load(levelFile.c_str()) || !level.build(map)){
+                return false;
             }
         }
+        if(!readHeader(level.header())){
+            return false;
+        }
+        for(uint32_t i = 0; i < level.header().layerCount; i++){
+            readLayerData(i);
+        }
+        for(uint32_t i = 0; i < level.header().objectCount; i++){
+            readEntityData(level.object(i));
+        }
+        return true;
     }
 
     Matrix viewMatrix;
     Matrix modelMatrix;
-    Matrix projectionMatrix;
-    // Counts up the amount of tiles that need to be drawn and draw them
+    // Draws the player and whichever tile chunks are on screen
     void drawTiles(ShaderProgram *program){
     
         // Matrices
@@ -348,58 +303,16 @@ public:
         
         glClear(GL_COLOR_BUFFER_BIT);
     
-        projectionMatrix.setOrthoProjection(-3.55, 3.55, -2.0f, 2.0f, -1.0f, 1.0f);
-        glUseProgram(program->programID);
-        program->setProjectionMatrix(projectionMatrix);
+        program->use();
+        program->setProjectionMatrix(screenProjection);
         // don't forget you need to bind the texture
         glBindTexture(GL_TEXTURE_2D, textureID);
         
-        for (int y=0; y < mapHeight; y++){
-            for (int x=0; x < mapWidth;  x++){
-            if(levelData[y][x] != 0) {
-                float u = (float)(((int) levelData[y][x]) % SPRITE_COUNT_X) / (float) SPRITE_COUNT_X;
-                float v = (float)(((int) levelData[y][x]) / SPRITE_COUNT_X) / (float) SPRITE_COUNT_Y;
-                
-                float spriteWidth = 1.0f / (float) SPRITE_COUNT_X;
-                float spriteHeight = 1.0f / (float) SPRITE_COUNT_Y;
-                
-                tileVerts.insert(tileVerts.end(), {
-                    TILE_SIZE * x, -TILE_SIZE * y,
-                    TILE_SIZE * x, (-TILE_SIZE * y)-TILE_SIZE,
-                    (TILE_SIZE * x)+TILE_SIZE, (-TILE_SIZE * y)-TILE_SIZE,
-                    TILE_SIZE * x, -TILE_SIZE * y,
-                    (TILE_SIZE * x)+TILE_SIZE, (-TILE_SIZE * y)-TILE_SIZE,
-                    (TILE_SIZE * x)+TILE_SIZE, -TILE_SIZE * y
-                });
-                
-                tileTexts.insert(tileTexts.end(), {
-                    u, v,
-                    u, v+(spriteHeight),
-                    u+spriteWidth, v+(spriteHeight),
-                    u, v,
-                    u+spriteWidth, v+(spriteHeight),
-                    u+spriteWidth, v
-                });
-                }
-            }
-        }
-        
         player.position(program);
         player.draw(program);
         
-        // Map the vertex array to position attribute
-        glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, 0, tileVerts.data());
-        glEnableVertexAttribArray(program->positionAttribute);
-        
-        // Map the texture array to the texture coordinate reader
-        glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, 0, tileTexts.data());
-        glEnableVertexAttribArray(program->texCoordAttribute);
-        
-        // Then actually draw it
-        glDrawArrays(GL_TRIANGLES, 0, ( (int)tileVerts.size() / 2));
-        
-        glDisableVertexAttribArray(program->positionAttribute);
-        glDisableVertexAttribArray(program->texCoordAttribute);
+        // The tiles have always gone out with the player's model matrix still set, culled against the same camera
+        tileMap.draw(program, textureID, player.matrix, viewMatrix, screenProjection);
         
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -489,17 +402,24 @@ int main(int argc, char *argv[])
     float elapsed = 0.0f;
     
     GLuint mapTexture = LoadTexture(RESOURCE_FOLDER"spritesheet_rgba.png");
-    Map game = Map(mapTexture);
+    Map game(mapTexture);
     
     // Gotta make the game somewhere
-    std::string mapFile = RESOURCE_FOLDER"platformDemoMap.txt";
-    game.readMapFile(mapFile);
+    // the .lvl is platformDemoMap.tmx run through tools/compileLevel and it remembers that .tmx's size and time.
+    // After the map is edited they differ and the .tmx gets loaded instead, until the .lvl is compiled again
+    std::string mapFile = RESOURCE_FOLDER"platformDemoMap.lvl";
+    std::string sourceFile = RESOURCE_FOLDER"platformDemoMap.tmx";
+    if(!game.readMapFile(mapFile, sourceFile.c_str())){
+        game.readMapFile(sourceFile);
+    }
     
     // Grand Finale!
     while (!done){
         ticks = (float)SDL_GetTicks()/1000.0f;
         fixedElapsed = ticks - elapsed;
         elapsed = ticks;
+        // last frame's geometry has already been drawn, start the scratch space over
+        frameArena.reset();
         /* Need update function next */
         // update if the main menu is running, then render
         processEvents(event, done, elapsed, game);
@@ -516,6 +436,10 @@ int main(int argc, char *argv[])
             game.drawTiles(&program);
     }
 
+    // what ARENA_FLOATS has to cover, if it's more the first frames chained blocks on until it fit
+    printf("frame arena high water mark %d floats (%d bytes), started at %d floats\n", (int)frameArena.highWaterMark(),
+           (int)frameArena.highWaterBytes(), ARENA_FLOATS);
+    game.tileMap.clear();
     cleanUp(&program);
     return 0;
 }
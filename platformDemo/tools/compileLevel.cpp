@@ -0,0 +1,114 @@
+/*
+    compileLevel map.tmx level.lvl
+    compileLevel --check map.tmx level.lvl
+
+    Turns a Tiled map (.tmx or the .txt export) into a compiled level the game maps straight into memory,
+    then maps the file it wrote back in and checks it against the map it came from. --check only does the
+    checking, for a level that's already been compiled, and says so if the map has changed since going by a hash
+    of all of it. The game only compares the map's size and time with what the level has, so run it again after
+    editing a map, or after a checkout that touched it, or the game loads the map itself instead of the level.
+    Builds on its own, from this folder:
+        c++ -O2 -I../NYUCodebase compileLevel.cpp ../NYUCodebase/CompiledLevel.cpp ../NYUCodebase/TiledMap.cpp ../NYUCodebase/TileDataDecoder.cpp -o compileLevel -lz
+*/
+
+#include "CompiledLevel.h"
+#include "TiledMap.h"
+#include <stdio.h>
+#include <string.h>
+
+// Everything the game gets out of a level, read back through CompiledLevel and compared with what TiledMap parsed
+static bool matches(const TiledMap &map, const CompiledLevel &level) {
+    const LevelFileHeader &header = level.header();
+    if (header.width != map.width || header.height != map.height || header.tileWidth != map.tileWidth
+        || header.tileHeight != map.tileHeight || header.layerCount != map.layers.size() || header.objectCount != map.objects.size()) {
+        printf("The header doesn't match the map\n");
+        return false;
+    }
+    size_t tileCount = (size_t)map.width * map.height;
+    for (size_t i = 0; i < map.layers.size(); i++) {
+        const TiledLayer &source = map.layers[i];
+        if (source.type.compare(0, LEVEL_NAME_LENGTH - 1, level.layer(i).name) != 0) {
+            printf("Layer %d is called %s, not %s\n", (int)i, level.layer(i).name, source.type.c_str());
+            return false;
+        }
+        const int *tiles = level.layerTiles(i);
+        for (size_t t = 0; t < tileCount; t++) {
+            int id = source.data.size() == tileCount ? source.data[t] : 0;
+            if (tiles[t] != (id > 0 ? id - 1 : -1)) {
+                printf("Layer %s tile %d,%d is %d, not %d\n", source.type.c_str(), (int)(t % map.width), (int)(t / map.width), tiles[t], id - 1);
+                return false;
+            }
+        }
+    }
+    for (int y = 0; y < map.height; y++) {
+        for (int x = 0; x < map.width; x++) {
+            bool solid = false;
+            for (size_t i = 0; i < map.layers.size() && !solid; i++) {
+                const TiledLayer &source = map.layers[i];
+                solid = CompiledLevel::isSolidLayer(source.type.c_str()) && source.data.size() == tileCount && source.data[(size_t)y * map.width + x] > 0;
+            }
+            if (level.solid(x, y) != solid) {
+                printf("Tile %d,%d should%s be solid\n", x, y, solid ? "" : "n't");
+                return false;
+            }
+        }
+    }
+    for (size_t i = 0; i < map.objects.size(); i++) {
+        const TiledObject &source = map.objects[i];
+        const LevelFileObject &object = level.object(i);
+        if (source.type.compare(0, LEVEL_NAME_LENGTH - 1, object.type) != 0 || object.x != source.x || object.y != source.y) {
+            printf("Object %d is %s at %d,%d, not %s at %d,%d\n", (int)i, object.type, object.x, object.y, source.type.c_str(), source.x, source.y);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    bool checkOnly = argc == 4 && strcmp(argv[1], "--check") == 0;
+    if (argc != 3 && !checkOnly) {
+        printf("usage: compileLevel [--check] map.tmx level.lvl\n");
+        return 1;
+    }
+    const char *mapPath = argv[argc - 2];
+    const char *levelPath = argv[argc - 1];
+    
+    TiledMap map;
+    if (!map.load(mapPath)) {
+        printf("Couldn't load map %s\n", mapPath);
+        return 1;
+    }
+    // the map's hash, size and time go in the header, the game won't use the level once the last two change
+    CompiledLevel built;
+    if (!built.build(map, mapPath)) {
+        return 1;
+    }
+    if (!checkOnly && !built.write(levelPath)) {
+        return 1;
+    }
+    
+    CompiledLevel level;
+    if (!level.open(levelPath)) {
+        return 1;
+    }
+    const LevelFileHeader &header = level.header();
+    if (header.sourceHash != built.header().sourceHash) {
+        printf("%s was compiled from an older %s\n", levelPath, mapPath);
+        return 1;
+    }
+    if (header.sourceSize != built.header().sourceSize || header.sourceModified != built.header().sourceModified) {
+        printf("%s is the same as when %s was compiled from it, but its time has changed so the game won't use the level\n", mapPath, levelPath);
+        return 1;
+    }
+    
+    // the file has to come back byte for byte, and read back to the same map
+    if (level.size() != built.size() || memcmp(level.data(), built.data(), built.size()) != 0) {
+        printf("%s isn't what %s compiles to\n", levelPath, mapPath);
+        return 1;
+    }
+    if (!matches(map, level)) {
+        return 1;
+    }
+    printf("%s: %dx%d, %d layers, %d objects, %d bytes\n", levelPath, map.width, map.height, (int)map.layers.size(), (int)map.objects.size(), (int)level.size());
+    return 0;
+}
@@ -0,0 +1,109 @@
+/*
+    frameArenaSoak [frames]
+
+    Runs the game's FrameArena through frames (a million if no count is given) of what main.cpp does with it:
+    reset at the top of the frame, then 12 position and 12 texture coordinate floats for every entity drawn and
+    for every character of every DrawText string. How many entities and which strings change from frame to frame,
+    and some frames draw more than ARENA_FLOATS was sized for so the arena has to grow.
+    The busiest frame comes around within the first WARM_UP frames, after that capacity() and highWaterMark() must
+    never change again and every frame has to be handed the same memory, so nothing gets allocated. Anything else
+    is printed and the exit code is 1. Reports the high water mark and how long a frame of allocations takes.
+    Builds on its own, from this folder:
+        c++ -O2 -I../NYUCodebase frameArenaSoak.cpp ../NYUCodebase/FrameArena.cpp -o frameArenaSoak
+*/
+
+#include "FrameArena.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+#define WARM_UP 1000
+#define MAX_ENTITIES 40
+
+// The HUD and menu text that gets drawn over the level, a frame draws a few of them
+static const char *strings[] = {
+    "SCORE 000120",
+    "LIVES 3",
+    "PRESS SPACE TO RETURN TO THE START OF THE LEVEL",
+    "PAUSED",
+    "Welcome to the platform demo, use the arrow keys to look around the map",
+    ""
+};
+#define STRING_COUNT (int)(sizeof(strings) / sizeof(strings[0]))
+
+static double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// One frame of allocations, the way Entity::draw and DrawText ask for them. Writes to every float it gets so a
+// block that's too small shows up, and returns where the frame's first floats came from
+static float *drawFrame(FrameArena &arena, int frame) {
+    arena.reset();
+    float *first = NULL;
+    // the schedule repeats every MAX_ENTITIES * STRING_COUNT frames, well inside WARM_UP
+    int entities = (frame * 7) % MAX_ENTITIES;
+    for (int i = 0; i < entities; i++) {
+        float *vertices = arena.allocate(12);
+        float *texCoords = arena.allocate(12);
+        memset(vertices, 0, 12 * sizeof(float));
+        memset(texCoords, 0, 12 * sizeof(float));
+        if (!first) {
+            first = vertices;
+        }
+    }
+    int drawn = 1 + frame % 3;
+    for (int i = 0; i < drawn; i++) {
+        size_t length = strlen(strings[(frame + i * 2) % STRING_COUNT]);
+        float *vertices = arena.allocate(length * 12);
+        float *texCoords = arena.allocate(length * 12);
+        memset(vertices, 0, length * 12 * sizeof(float));
+        memset(texCoords, 0, length * 12 * sizeof(float));
+        if (!first) {
+            first = vertices;
+        }
+    }
+    return first;
+}
+
+int main(int argc, char *argv[]) {
+    int frames = argc > 1 ? atoi(argv[1]) : 1000000;
+    if (frames <= WARM_UP) {
+        printf("usage: frameArenaSoak [frames], more than %d\n", WARM_UP);
+        return 1;
+    }
+    FrameArena arena(ARENA_FLOATS);
+    size_t startCapacity = arena.capacity();
+    for (int frame = 0; frame < WARM_UP; frame++) {
+        drawFrame(arena, frame);
+    }
+    // the next reset is the one that merges the last chained blocks, anything after that has to stay put
+    drawFrame(arena, 0);
+    size_t capacity = arena.capacity();
+    size_t highWater = arena.highWaterMark();
+    float *memory = NULL;
+    
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int frame = WARM_UP; frame < frames; frame++) {
+        float *first = drawFrame(arena, frame);
+        if (first && !memory) {
+            memory = first;
+        }
+        if (arena.capacity() != capacity || arena.highWaterMark() != highWater || (first && first != memory)) {
+            printf("Frame %d after warming up: capacity %d floats (was %d), high water mark %d floats (was %d), %s memory\n", frame,
+                   (int)arena.capacity(), (int)capacity, (int)arena.highWaterMark(), (int)highWater, first == memory ? "the same" : "different");
+            return 1;
+        }
+    }
+    double time = seconds(start);
+    
+    if (highWater <= ARENA_FLOATS) {
+        printf("No frame went past the %d floats the arena starts with, nothing was tested growing it\n", ARENA_FLOATS);
+        return 1;
+    }
+    printf("%d frames, arena started at %d floats\n", frames, (int)startCapacity);
+    printf("    high water mark %d floats (%d bytes), capacity %d floats after %d frames of warming up\n", (int)highWater,
+           (int)arena.highWaterBytes(), (int)capacity, WARM_UP);
+    printf("    unchanged for the other %d frames, %.1f ns a frame of allocations\n", frames - WARM_UP, time * 1e9 / (frames - WARM_UP));
+    return 0;
+}
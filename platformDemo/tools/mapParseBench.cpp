@@ -0,0 +1,226 @@
+/*
+    mapParseBench [size]
+
+    Writes a size x size Tiled text export (4096 if no size is given) with a tile layer and an object group,
+    then loads it with the istringstream and getline reader main.cpp used to have and with TiledMap,
+    and reports how long each takes and how many MB a second that is.
+    Both have to come out with the same size, tiles and objects, anything that doesn't is printed and the
+    exit code is 1. The map is written to mapParseBench.txt in the current folder and deleted afterwards.
+    Builds on its own, from this folder:
+        c++ -O2 -I../NYUCodebase mapParseBench.cpp ../NYUCodebase/TiledMap.cpp ../NYUCodebase/TileDataDecoder.cpp -o mapParseBench -lz
+*/
+
+#include "TiledMap.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+
+#define MAP_FILE "mapParseBench.txt"
+
+using namespace std;
+
+// What main.cpp's readHeader, readLayerData and readEntityData got out of a map, with whole tile ids kept
+// (the old reader cut them to an unsigned char) so the two can be compared
+struct OldMap {
+    int mapWidth;
+    int mapHeight;
+    int tileWidth;
+    int tileHeight;
+    vector<int> tiles;
+    vector<TiledObject> objects;
+    
+    bool readHeader(ifstream& levelFile){
+        string line;
+        mapWidth = -1;
+        mapHeight = -1;
+        while(getline(levelFile, line)) {
+            if(line == "") { break; }
+            istringstream sStream(line);
+            string key,value;
+            getline(sStream, key, '=');
+            getline(sStream, value);
+            if(key == "width") {
+                mapWidth = atoi(value.c_str());
+            } else if(key == "height"){
+                mapHeight = atoi(value.c_str());
+            } else if (key == "tilewidth"){
+                tileWidth = atoi(value.c_str());
+            } else if (key == "tileheight"){
+                tileHeight = atoi(value.c_str());
+            }
+        }
+        if(mapWidth == -1 || mapHeight == -1) {
+            return false;
+        }
+        tiles.resize(mapWidth * mapHeight);
+        return true;
+    }
+    
+    void readLayerData(ifstream& levelFile){
+        string line;
+        while(getline(levelFile, line)) {
+            if(line == "") { break; }
+            istringstream sStream(line);
+            string key,value;
+            getline(sStream, key, '=');
+            getline(sStream, value);
+            if(key == "data") {
+                for(int y=0; y < mapHeight; y++) {
+                    getline(levelFile, line);
+                    istringstream lineStream(line);
+                    string tile;
+                    for(int x=0; x < mapWidth; x++) {
+                        getline(lineStream, tile, ',');
+                        tiles[y * mapWidth + x] = atoi(tile.c_str());
+                    }
+                }
+            }
+        }
+    }
+    
+    void readEntityData(ifstream& levelFile){
+        string line;
+        TiledObject object = {"", 0, 0};
+        while(getline(levelFile, line)) {
+            if(line == "") { break; }
+            istringstream sStream(line);
+            string key,value;
+            getline(sStream, key, '=');
+            getline(sStream, value);
+            if(key == "type") {
+                object.type = value;
+            } else if(key == "location") {
+                istringstream lineStream(value);
+                string xPosition, yPosition;
+                getline(lineStream, xPosition, ',');
+                getline(lineStream, yPosition, ',');
+                object.x = atoi(xPosition.c_str());
+                object.y = atoi(yPosition.c_str());
+                objects.push_back(object);
+            }
+        }
+    }
+    
+    // [Object Layer 1] is what Tiled calls the group, the old reader only knew [object]
+    bool load(const char *path){
+        ifstream infile(path);
+        string line;
+        while(getline(infile, line)){
+            if (line == "[header]"){
+                if(!readHeader(infile)){
+                    return false;
+                }
+            } else if (line == "[layer]"){
+                readLayerData(infile);
+            } else if (line == "[object]" || line == "[Object Layer 1]"){
+                readEntityData(infile);
+            }
+        }
+        return true;
+    }
+};
+
+// Mostly empty tiles with runs of ground and the odd three digit id, like the shipped maps
+static size_t writeMap(const char *path, int size) {
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        return 0;
+    }
+    fprintf(file, "[header]\nwidth=%d\nheight=%d\ntilewidth=23\ntileheight=23\norientation=orthogonal\n\n", size, size);
+    fprintf(file, "[tilesets]\ntileset=spritesheet_rgba.png,23,23,0,0\n\n");
+    fprintf(file, "[layer]\ntype=solids\ndata=\n");
+    srand(1);
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            int r = rand() % 16;
+            int id = r < 10 ? 0 : r < 15 ? 124 : 1 + rand() % 900;
+            fprintf(file, y == size - 1 && x == size - 1 ? "%d\n" : "%d,", id);
+        }
+        if (y != size - 1) {
+            fprintf(file, "\n");
+        }
+    }
+    fprintf(file, "\n[Object Layer 1]\n# player\ntype=player\nlocation=%d,%d,23,23\n", size / 2, size / 3);
+    long bytes = ftell(file);
+    fclose(file);
+    return (size_t)bytes;
+}
+
+static bool same(const OldMap &old, const TiledMap &map) {
+    if (old.mapWidth != map.width || old.mapHeight != map.height || old.tileWidth != map.tileWidth || old.tileHeight != map.tileHeight) {
+        printf("TiledMap reads the header as %dx%d, the old reader %dx%d\n", map.width, map.height, old.mapWidth, old.mapHeight);
+        return false;
+    }
+    if (map.layers.size() != 1 || map.layers[0].data != old.tiles) {
+        printf("TiledMap's tiles aren't the ones the old reader found\n");
+        return false;
+    }
+    if (map.objects.size() != old.objects.size()) {
+        printf("TiledMap found %d objects, the old reader %d\n", (int)map.objects.size(), (int)old.objects.size());
+        return false;
+    }
+    for (size_t i = 0; i < old.objects.size(); i++) {
+        if (map.objects[i].type != old.objects[i].type || map.objects[i].x != old.objects[i].x || map.objects[i].y != old.objects[i].y) {
+            printf("Object %d is %s at %d,%d, the old reader has %s at %d,%d\n", (int)i, map.objects[i].type.c_str(), map.objects[i].x,
+                   map.objects[i].y, old.objects[i].type.c_str(), old.objects[i].x, old.objects[i].y);
+            return false;
+        }
+    }
+    return true;
+}
+
+static double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[]) {
+    int size = argc > 1 ? atoi(argv[1]) : 4096;
+    if (size < 1) {
+        printf("usage: mapParseBench [size]\n");
+        return 1;
+    }
+    size_t bytes = writeMap(MAP_FILE, size);
+    if (!bytes) {
+        printf("Couldn't write %s\n", MAP_FILE);
+        return 1;
+    }
+    
+    // the file was just written, so both start from the same warm cache
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    OldMap old;
+    bool oldLoaded = old.load(MAP_FILE);
+    double oldTime = seconds(start);
+    
+    start = std::chrono::steady_clock::now();
+    TiledMap map;
+    bool loaded = map.load(MAP_FILE);
+    double loadTime = seconds(start);
+    
+    // and once more from a buffer that's already in memory, just the parsing
+    string text;
+    {
+        ifstream infile(MAP_FILE, ios::binary);
+        text.assign(istreambuf_iterator<char>(infile), istreambuf_iterator<char>());
+    }
+    start = std::chrono::steady_clock::now();
+    TiledMap parsed;
+    bool parsedOk = parsed.parse(text.data(), text.size());
+    double parseTime = seconds(start);
+    remove(MAP_FILE);
+    
+    if (!oldLoaded || !loaded || !parsedOk) {
+        printf("The map didn't load (old reader %d, TiledMap::load %d, TiledMap::parse %d)\n", oldLoaded, loaded, parsedOk);
+        return 1;
+    }
+    if (!same(old, map) || !same(old, parsed)) {
+        return 1;
+    }
+    double megabytes = bytes / (1024.0 * 1024.0);
+    printf("%dx%d map, %.1f MB\n", size, size, megabytes);
+    printf("    old reader      %8.1f ms %8.1f MB/s\n", oldTime * 1e3, megabytes / oldTime);
+    printf("    TiledMap::load  %8.1f ms %8.1f MB/s\n", loadTime * 1e3, megabytes / loadTime);
+    printf("    TiledMap::parse %8.1f ms %8.1f MB/s (already in memory)\n", parseTime * 1e3, megabytes / parseTime);
+    return 0;
+}
@@ -0,0 +1,181 @@
+/*
+    tmxParseBench [size]
+
+    Builds a size x size map (1024 if no size is given) as the text export and as a .tmx with its layer in csv,
+    base64, base64 around zlib and base64 around gzip, parses each one with TiledMap and reports how long it took
+    and how many MB of map text and million tiles a second that is.
+    Every one has to come out with exactly the tiles that went in. A zlib or gzip layer with its checksum damaged
+    or its end cut off has to fail to load (TiledMap says so as it rejects them). Anything else is printed and
+    the exit code is 1.
+    Builds on its own, from this folder:
+        c++ -O2 -I../NYUCodebase tmxParseBench.cpp ../NYUCodebase/TiledMap.cpp ../NYUCodebase/TileDataDecoder.cpp -o tmxParseBench -lz
+*/
+
+#include "TiledMap.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <zlib.h>
+
+#define REPEATS 5
+
+// Mostly empty tiles with runs of ground and the odd three digit id, like the shipped maps
+static std::vector<int> randomTiles(int size) {
+    std::vector<int> tiles((size_t)size * size);
+    srand(1);
+    for (size_t i = 0; i < tiles.size(); i++) {
+        int r = rand() % 16;
+        tiles[i] = r < 10 ? 0 : r < 15 ? 124 : 1 + rand() % 900;
+    }
+    return tiles;
+}
+
+static std::string textMap(const std::vector<int> &tiles, int size) {
+    char line[256];
+    snprintf(line, sizeof(line), "[header]\nwidth=%d\nheight=%d\ntilewidth=23\ntileheight=23\n\n[layer]\ntype=solids\ndata=\n", size, size);
+    std::string text = line;
+    for (size_t i = 0; i < tiles.size(); i++) {
+        snprintf(line, sizeof(line), i + 1 == tiles.size() ? "%d\n" : (i + 1) % size == 0 ? "%d,\n" : "%d,", tiles[i]);
+        text += line;
+    }
+    return text;
+}
+
+static std::string base64(const unsigned char *data, size_t length) {
+    const char *alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string text;
+    text.reserve((length + 2) / 3 * 4);
+    for (size_t i = 0; i < length; i += 3) {
+        unsigned int group = (unsigned int)data[i] << 16;
+        if (i + 1 < length) {
+            group |= (unsigned int)data[i + 1] << 8;
+        }
+        if (i + 2 < length) {
+            group |= data[i + 2];
+        }
+        text += alphabet[group >> 18 & 63];
+        text += alphabet[group >> 12 & 63];
+        text += i + 1 < length ? alphabet[group >> 6 & 63] : '=';
+        text += i + 2 < length ? alphabet[group & 63] : '=';
+    }
+    return text;
+}
+
+// windowBits 15 writes a zlib header and adler32, 15 + 16 a gzip header and crc32
+static std::vector<unsigned char> compress(const std::vector<unsigned char> &bytes, int windowBits) {
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY);
+    std::vector<unsigned char> packed(deflateBound(&stream, bytes.size()));
+    stream.next_in = (Bytef *)bytes.data();
+    stream.avail_in = (uInt)bytes.size();
+    stream.next_out = packed.data();
+    stream.avail_out = (uInt)packed.size();
+    deflate(&stream, Z_FINISH);
+    packed.resize(stream.total_out);
+    deflateEnd(&stream);
+    return packed;
+}
+
+// A .tmx with one layer of the tiles, data is what goes between <data> and </data>
+static std::string tmxMap(int size, const char *dataAttributes, const std::string &data) {
+    char header[512];
+    snprintf(header, sizeof(header), "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+             "<map version=\"1.0\" orientation=\"orthogonal\" width=\"%d\" height=\"%d\" tilewidth=\"23\" tileheight=\"23\">\n"
+             " <layer name=\"solids\" width=\"%d\" height=\"%d\">\n  <data %s>\n", size, size, size, size, dataAttributes);
+    return header + data + "\n  </data>\n </layer>\n</map>\n";
+}
+
+static std::string csvData(const std::vector<int> &tiles, int size) {
+    std::string data;
+    char number[16];
+    for (size_t i = 0; i < tiles.size(); i++) {
+        snprintf(number, sizeof(number), i + 1 == tiles.size() ? "%d" : (i + 1) % size == 0 ? "%d,\n" : "%d,", tiles[i]);
+        data += number;
+    }
+    return data;
+}
+
+static double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Parses it REPEATS times and reports the best, false if it doesn't load or the tiles come out different
+static bool timeParse(const char *what, const std::string &text, const std::vector<int> &tiles) {
+    double best = 0.0;
+    for (int r = 0; r < REPEATS; r++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        TiledMap map;
+        bool loaded = map.parse(text.data(), text.size());
+        double time = seconds(start);
+        if (!loaded || map.layers.size() != 1) {
+            printf("%s didn't load\n", what);
+            return false;
+        }
+        if (map.layers[0].data != tiles) {
+            printf("%s came out with different tiles\n", what);
+            return false;
+        }
+        if (r == 0 || time < best) {
+            best = time;
+        }
+    }
+    double megabytes = text.size() / (1024.0 * 1024.0);
+    printf("    %-14s %7.1f MB %8.2f ms %8.1f MB/s %8.1f M tiles/s\n", what, megabytes, best * 1e3, megabytes / best, tiles.size() / best / 1e6);
+    return true;
+}
+
+static bool rejected(const char *what, const std::string &text) {
+    TiledMap map;
+    if (map.parse(text.data(), text.size())) {
+        printf("%s loaded anyway\n", what);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    int size = argc > 1 ? atoi(argv[1]) : 1024;
+    if (size < 1) {
+        printf("usage: tmxParseBench [size]\n");
+        return 1;
+    }
+    std::vector<int> tiles = randomTiles(size);
+    // the tile ids as a .tmx stores them, 32 bit little endian
+    std::vector<unsigned char> bytes(tiles.size() * 4);
+    for (size_t i = 0; i < tiles.size(); i++) {
+        for (int b = 0; b < 4; b++) {
+            bytes[i * 4 + b] = (unsigned char)((unsigned int)tiles[i] >> (8 * b));
+        }
+    }
+    std::vector<unsigned char> zlibBytes = compress(bytes, 15);
+    std::vector<unsigned char> gzipBytes = compress(bytes, 15 + 16);
+    
+    std::string text = textMap(tiles, size);
+    std::string csv = tmxMap(size, "encoding=\"csv\"", csvData(tiles, size));
+    std::string plain = tmxMap(size, "encoding=\"base64\"", base64(bytes.data(), bytes.size()));
+    std::string zlib = tmxMap(size, "encoding=\"base64\" compression=\"zlib\"", base64(zlibBytes.data(), zlibBytes.size()));
+    std::string gzip = tmxMap(size, "encoding=\"base64\" compression=\"gzip\"", base64(gzipBytes.data(), gzipBytes.size()));
+    
+    printf("%dx%d map, best of %d\n", size, size, REPEATS);
+    if (!timeParse("text export", text, tiles) || !timeParse("tmx csv", csv, tiles) || !timeParse("tmx base64", plain, tiles)
+        || !timeParse("tmx zlib", zlib, tiles) || !timeParse("tmx gzip", gzip, tiles)) {
+        return 1;
+    }
+    
+    // adler32 is the last 4 bytes of a zlib stream, a gzip stream ends in its crc32 and then the length
+    std::vector<unsigned char> damaged = zlibBytes;
+    damaged[damaged.size() - 1] ^= 1;
+    bool ok = rejected("zlib with a bad adler32", tmxMap(size, "encoding=\"base64\" compression=\"zlib\"", base64(damaged.data(), damaged.size())));
+    damaged = gzipBytes;
+    damaged[damaged.size() - 8] ^= 1;
+    ok = rejected("gzip with a bad crc32", tmxMap(size, "encoding=\"base64\" compression=\"gzip\"", base64(damaged.data(), damaged.size()))) && ok;
+    ok = rejected("zlib cut short", tmxMap(size, "encoding=\"base64\" compression=\"zlib\"", base64(zlibBytes.data(), zlibBytes.size() / 2))) && ok;
+    ok = rejected("gzip cut short", tmxMap(size, "encoding=\"base64\" compression=\"gzip\"", base64(gzipBytes.data(), gzipBytes.size() - 4))) && ok;
+    if (!ok) {
+        return 1;
+    }
+    printf("damaged and cut short zlib and gzip layers are all rejected\n");
+    return 0;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#ifdef _WINDOWS
+	#include <GL/glew.h>
+#endif
+#include <SDL_opengl.h>
+#include <vector>
+#include "ShaderProgram.h"
+
+// How a QuadMesh stores its vertices. Every format is 4 interleaved vertices per quad
+// drawn through the shared 16 bit index list, instead of 6 vertices split over two float arrays
+enum QuadFormat {
+    // float x, y, u, v, 16 bytes a vertex
+    QUAD_FLOAT,
+    // float x, y and u, v as unsigned shorts normalized to 0..1, 12 bytes a vertex
+    QUAD_PACKED_UV,
+    // x, y rounded to shorts plus the normalized u, v, 8 bytes a vertex. For grids where every
+    // corner is on a whole number, the model matrix scales them back up (by the tile size for tiles)
+    QUAD_PACKED
+};
+
+// What the quads used to cost, 6 vertices of 2 position and 2 texture floats
+#define UNINDEXED_BYTES_PER_QUAD 96
+
+// Quads for tiles, sprites and text in one compact vertex format
+class QuadMesh {
+    public:
+        QuadMesh(QuadFormat format = QUAD_FLOAT);
+    
+        // Drops the quads but keeps the memory, for meshes that get rebuilt every frame
+        void reset();
+    
+        // Corners counter clockwise from the bottom left, as x, y pairs in positions and u, v pairs in texCoords
+        void addQuad(const float *positions, const float *texCoords);
+        // An axis aligned quad with u, v at its top left and u + uvWidth, v + uvHeight at its bottom right,
+        // v going down the texture like SpriteSheet
+        void addRect(float left, float top, float right, float bottom, float u, float v, float uvWidth, float uvHeight);
+    
+        // Moves the quads into a buffer object, for meshes that get drawn for many frames
+        void upload();
+        // Draws count quads starting at firstQuad with program's position and texCoord attributes,
+        // from the buffer object after upload() and straight out of memory otherwise
+        void draw(ShaderProgram *program, int firstQuad, int count);
+        void draw(ShaderProgram *program);
+    
+        // Frees the buffer object, call it while the GL context is still around
+        void clear();
+    
+        int quadCount() const;
+        QuadFormat format() const;
+        // Bytes of vertices in the mesh right now
+        int vertexBytes() const;
+        // What one quad costs in a format, its 4 vertices and its 6 indices
+        static int bytesPerQuad(QuadFormat format);
+    
+    private:
+        struct FloatVertex { GLfloat x, y, u, v; };
+        struct PackedUVVertex { GLfloat x, y; GLushort u, v; };
+        struct PackedVertex { GLshort x, y; GLushort u, v; };
+    
+        static int vertexSize(QuadFormat format);
+        void pointAttributes(ShaderProgram *program, const char *base);
+    
+        QuadFormat vertexFormat;
+        int quads;
+        std::vector<unsigned char> vertices;
+        GLuint buffer;
+        bool uploaded;
+    
+        // One index list shared by every mesh, made the first time something draws. The buffer object
+        // copy lives as long as some mesh has uploaded
+        static std::vector<GLushort> indices;
+        static GLuint indexBuffer;
+        static int indexBufferUsers;
+};
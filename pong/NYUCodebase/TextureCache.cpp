@@ -0,0 +1,74 @@
+#include "TextureCache.h"
+#include <SDL_image.h>
+
+TextureCache::TextureCache() : hits(0), misses(0), totalBytes(0) {}
+
+GLuint TextureCache::acquire(const std::string &imagePath) {
+    std::map<std::string, Entry>::iterator found = textures.find(imagePath);
+    if(found != textures.end()) {
+        hits++;
+        found->second.references++;
+        return found->second.textureID;
+    }
+    
+    misses++;
+    SDL_Surface *surface = IMG_Load(imagePath.c_str());
+    
+    if(surface == NULL){
+        printf("bad image\n");
+        exit(1);
+    }
+    
+    GLuint textureID;
+    glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, surface->w, surface->h, 0, GL_BGRA, GL_UNSIGNED_BYTE, surface->pixels);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    
+    Entry entry;
+    entry.textureID = textureID;
+    entry.references = 1;
+    entry.bytes = (size_t)surface->w * surface->h * 4;
+    textures[imagePath] = entry;
+    paths[textureID] = imagePath;
+    totalBytes += entry.bytes;
+    
+    SDL_FreeSurface(surface);
+    return textureID;
+}
+
+void TextureCache::release(GLuint textureID) {
+    std::map<GLuint, std::string>::iterator path = paths.find(textureID);
+    if(path == paths.end()) {
+        return;
+    }
+    std::map<std::string, Entry>::iterator it = textures.find(path->second);
+    it->second.references--;
+    if(it->second.references <= 0) {
+        glDeleteTextures(1, &it->second.textureID);
+        totalBytes -= it->second.bytes;
+        textures.erase(it);
+        paths.erase(path);
+    }
+}
+
+void TextureCache::clear() {
+    if(!textures.empty()) {
+        printf("%d textures were still acquired when the cache was cleared\n", (int)textures.size());
+    }
+    for(std::map<std::string, Entry>::iterator it = textures.begin(); it != textures.end(); ++it) {
+        glDeleteTextures(1, &it->second.textureID);
+    }
+    textures.clear();
+    paths.clear();
+    totalBytes = 0;
+}
+
+void TextureCache::report() const {
+    printf("texture cache: %d hits, %d misses, %d textures using %d KB on the GPU\n", hits, misses, (int)textures.size(), (int)(totalBytes / 1024));
+}
+
+size_t TextureCache::gpuBytes() const {
+    return totalBytes;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#ifdef _WINDOWS
+	#include <GL/glew.h>
+#endif
+#include <SDL_opengl.h>
+#include <string>
+#include <map>
+
+// Loads every image once and hands the same texture back to anyone else asking for that path
+class TextureCache {
+    public:
+        TextureCache();
+    
+        // Returns the texture for this image, decoding and uploading it only the first time
+        GLuint acquire(const std::string &imagePath);
+    
+        // Give back one reference, the texture is deleted once nobody holds it anymore
+        void release(GLuint textureID);
+    
+        // Deletes every texture regardless of references, call before the GL context goes away.
+        // Says so if some were never released
+        void clear();
+    
+        // Prints hits, misses and gpuBytes, once loading is done rather than on every acquire
+        void report() const;
+    
+        // Size of all the textures we're holding on the GPU
+        size_t gpuBytes() const;
+    
+        int hits;
+        int misses;
+    
+    private:
+        struct Entry {
+            GLuint textureID;
+            int references;
+            size_t bytes;
+        };
+    
+        std::map<std::string, Entry> textures;
+        // which image each texture came from, so release doesn't have to search
+        std::map<GLuint, std::string> paths;
+        size_t totalBytes;
+};
@@ -6,6 +6,8 @@
 #include <SDL_image.h>
 #include "Matrix.h"
 #include "ShaderProgram.h"
+#include "TextureCache.h"
+#include "TextRenderer.h"
 #include <vector>
 
 #ifdef _WINDOWS
@@ -16,26 +18,18 @@
 
 SDL_Window* displayWindow;
 
+// The camera always shows the same slice of the world, so its projection is worked out at compile time
+constexpr Matrix screenProjection = Matrix::orthoProjection(-3.55f, 3.55f, -2.0f, 2.0f, -1.0f, 1.0f);
+
 float radianConverter(float degree){
     return (degree * (3.1415926 / 180.0));
 }
 
-GLuint LoadTexture(const char *image_path) {
-    SDL_Surface *surface = IMG_Load(image_path);
-    
-    if(surface == NULL){
-        printf("bad image\n");
-        exit(1);
-    }
+// Every texture goes through the cache, so an image is only decoded and uploaded once
+TextureCache textureCache;
 
-    GLuint textureID;
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, surface->w, surface->h, 0, GL_BGRA, GL_UNSIGNED_BYTE, surface->pixels);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    SDL_FreeSurface(surface);
-    return textureID;
+GLuint LoadTexture(const char *image_path) {
+    return textureCache.acquire(image_path);
 }
 
 // Let's try using Entities
@@ -100,48 +94,15 @@ void setup(){
 #endif
 }
 
-void DrawText(ShaderProgram *program, Matrix &modelMatrix, int fontTexture, std::string text, float size, float spacing) {
-    float texture_size = 1.0/16.0f;
-    std::vector<float> vertexData;
-    std::vector<float> texCoordData;
-    for(int i=0; i < text.size(); i++) {
-        float texture_x = (float)(((int)text[i]) % 16) / 16.0f;
-        float texture_y = (float)(((int)text[i]) / 16) / 16.0f;
-        vertexData.insert(vertexData.end(), {
-            ((size+spacing) * i) + (-0.5f * size), 0.5f * size,
-            ((size+spacing) * i) + (-0.5f * size), -0.5f * size,
-            ((size+spacing) * i) + (0.5f * size), 0.5f * size,
-            ((size+spacing) * i) + (0.5f * size), -0.5f * size,
-            ((size+spacing) * i) + (0.5f * size), 0.5f * size,
-            ((size+spacing) * i) + (-0.5f * size), -0.5f * size,
-        });
-        texCoordData.insert(texCoordData.end(), {
-            texture_x, texture_y,
-            texture_x, texture_y + texture_size,
-            texture_x + texture_size, texture_y,
-            texture_x + texture_size, texture_y + texture_size,
-            texture_x + texture_size, texture_y,
-            texture_x, texture_y + texture_size,
-        }); }
-    modelMatrix.identity();
-    modelMatrix.Translate(-2.5f, 1.5f, 0.0f);
-    program->setModelMatrix(modelMatrix);
-    
-    glUseProgram(program->programID);
-    glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, 0, vertexData.data());
-    glEnableVertexAttribArray(program->positionAttribute);
-    glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, 0, texCoordData.data());
-    glEnableVertexAttribArray(program->texCoordAttribute);
-    glBindTexture(GL_TEXTURE_2D, fontTexture);
-    
-    glDrawArrays(GL_TRIANGLES, 0, (float)(text.size() * 6));
-}
+// The score text only changes when someone wins, so it's laid out once and reused
+TextRenderer textRenderer;
 
 // cleans up anything the program was using
 void cleanUp(ShaderProgram &program)
 {
     glDisableVertexAttribArray(program.positionAttribute);
     glDisableVertexAttribArray(program.texCoordAttribute);
+    textureCache.clear();
     SDL_Quit();
 }
 
@@ -228,13 +189,12 @@ void update(std::string &textToDraw, float &lastFrameTicks, float &elapsed, floa
 }
 
 // draws declared objects onto the display screen
-void render(ShaderProgram &program, std::string &textToDraw, Matrix &modelMatrix, Entity &paddle, Entity &paddle2, Entity &ball, Matrix &viewMatrix, Matrix &projectionMatrix)
+void render(ShaderProgram &program, std::string &textToDraw, Entity &paddle, Entity &paddle2, Entity &ball, Matrix &viewMatrix, GLuint fontTexture)
 {
     glClear(GL_COLOR_BUFFER_BIT);
     
-    projectionMatrix.setOrthoProjection(-3.55, 3.55, -2.0f, 2.0f, -1.0f, 1.0f);
-    glUseProgram(program.programID);
-    program.setProjectionMatrix(projectionMatrix);
+    program.use();
+    program.setProjectionMatrix(screenProjection);
     program.setViewMatrix(viewMatrix);
     
     paddle.draw(program);
@@ -242,8 +202,9 @@ void render(ShaderProgram &program, std::string &textToDraw, Matrix &modelMatrix
     ball.draw(program);
     
     if (textToDraw != ""){
-        DrawText(&program, modelMatrix, LoadTexture("font1.png"), textToDraw, 0.3f, 0.05f);
+        textRenderer.draw(textToDraw, 0.3f, 0.05f, -2.5f, 1.5f);
     }
+    textRenderer.flush(&program, fontTexture);
     
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -278,7 +239,6 @@ int main(int argc, char *argv[])
 {
     setup();
     ShaderProgram program(RESOURCE_FOLDER"vertex_textured.glsl", RESOURCE_FOLDER"fragment_textured.glsl");
-    Matrix projectionMatrix;
     Matrix viewMatrix;
     Matrix modelMatrix;
     Entity paddle = Entity(modelMatrix, 1.0f, 1.0f, 4.0f, "white.jpg", 3.0f, 0.5f, 0.3f, 1.0f);
@@ -287,6 +247,11 @@ int main(int argc, char *argv[])
     
     Entity ball = Entity(modelMatrix, 45.0, 45.0, 2.0f, "ball.png", 0.0f, 0.5f, 0.2f, 0.2f);
     
+    // Load the font up front instead of every frame the text shows up
+    GLuint fontTexture = LoadTexture("font1.png");
+    // everything is loaded, the paddles share white.jpg
+    textureCache.report();
+    
     // Variables can, for now, be global
     SDL_Event event;
     bool done = false;
@@ -300,10 +265,15 @@ int main(int argc, char *argv[])
     while (!done) {
         processEvents(event, done, elapsed, paddle, paddle2, ball);
         update(textToDraw, lastFrameTicks, elapsed, angle, ball, paddle, paddle2);
-        render(program, textToDraw, modelMatrix, paddle, paddle2, ball, viewMatrix, projectionMatrix);
+        render(program, textToDraw, paddle, paddle2, ball, viewMatrix, fontTexture);
         
     }
     
+    // hand back every texture acquired above, clear() complains about any that are left
+    textureCache.release(fontTexture);
+    textureCache.release(ball.textureID);
+    textureCache.release(paddle2.textureID);
+    textureCache.release(paddle.textureID);
     cleanUp(program);
     return 0;
 }
@@ -0,0 +1,132 @@
+/*
+    textLayoutCheck
+
+    Checks TextRenderer without a GL context. layout() of a known string has to put every letter's 4 corners
+    where DrawText used to (size + spacing apart, the first one centered on the origin) and pick its cell out of
+    the 16 x 16 font grid, also after setFontRegion() moves the grid. Asking again has to hand back the same run
+    without laying it out, and a changed string, size or spacing has to be laid out afresh. A string nobody
+    draws for TEXT_CACHE_FRAMES flushes has to be dropped, and the strings queued in a frame have to go out in
+    one glDrawElements. GL is stubbed (glStubs.h) for the flushes. Anything else is printed and the exit code is 1.
+    Builds on its own, from this folder (only the GL headers are needed, no context):
+        c++ -O2 -I../NYUCodebase -I/Library/Frameworks/SDL2.framework/Headers textLayoutCheck.cpp ../NYUCodebase/TextRenderer.cpp ../NYUCodebase/QuadMesh.cpp ../NYUCodebase/Matrix.cpp -o textLayoutCheck
+*/
+
+#include "glStubs.h"
+#include "TextRenderer.h"
+#include <stdio.h>
+#include <math.h>
+
+// what TextRenderer.cpp keeps unused strings for
+#define TEXT_CACHE_FRAMES 120
+#define SLACK 1e-6f
+
+static bool near(float a, float b) {
+    return fabsf(a - b) <= SLACK;
+}
+
+// Every corner of run against text laid out at size and spacing, with the font grid at u, v, width x height
+static bool checkRun(const char *what, const GlyphRun &run, const std::string &text, float size, float spacing,
+                     float u, float v, float width, float height) {
+    if (run.vertices.size() != text.size() * 8 || run.texCoords.size() != text.size() * 8) {
+        printf("%s: %d position and %d texture floats for %d letters\n", what, (int)run.vertices.size(), (int)run.texCoords.size(), (int)text.size());
+        return false;
+    }
+    for (size_t i = 0; i < text.size(); i++) {
+        float left = (size + spacing) * i - 0.5f * size;
+        float cellU = u + (text[i] % 16) * width / 16.0f;
+        float cellV = v + (text[i] / 16) * height / 16.0f;
+        // counter clockwise from the bottom left, v going down the texture
+        const float positions[8] = {left, -0.5f * size, left + size, -0.5f * size, left + size, 0.5f * size, left, 0.5f * size};
+        const float texCoords[8] = {cellU, cellV + height / 16.0f, cellU + width / 16.0f, cellV + height / 16.0f,
+                                    cellU + width / 16.0f, cellV, cellU, cellV};
+        for (int j = 0; j < 8; j++) {
+            if (!near(run.vertices[i * 8 + j], positions[j]) || !near(run.texCoords[i * 8 + j], texCoords[j])) {
+                printf("%s: letter %d '%c' float %d is %g uv %g, should be %g uv %g\n", what, (int)i, text[i], j,
+                       run.vertices[i * 8 + j], run.texCoords[i * 8 + j], positions[j], texCoords[j]);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool checkRebuilds(const char *what, const TextRenderer &text, int rebuilds, int cachedRuns) {
+    if (text.rebuilds != rebuilds || text.cachedRuns() != cachedRuns) {
+        printf("%s: %d rebuilds and %d cached runs, should be %d and %d\n", what, text.rebuilds, text.cachedRuns(), rebuilds, cachedRuns);
+        return false;
+    }
+    return true;
+}
+
+int main() {
+    ShaderProgram program("vertex_textured.glsl", "fragment_textured.glsl");
+    TextRenderer text;
+    
+    // 'P' is row 5 column 0 of the font, '1' row 3 column 1, ' ' and '-' row 2
+    std::string score = "P1 - 0";
+    const GlyphRun &run = text.layout(score, 0.3f, 0.05f);
+    if (!checkRun("layout", run, score, 0.3f, 0.05f, 0.0f, 0.0f, 1.0f, 1.0f) || !checkRebuilds("layout", text, 1, 1)) {
+        return 1;
+    }
+    
+    // the same string again is a cache hit, the very same run
+    const GlyphRun &again = text.layout(score, 0.3f, 0.05f);
+    if (&again != &run || !checkRebuilds("the same string again", text, 1, 1)) {
+        printf("the same string again: %s run\n", &again == &run ? "the same" : "a different");
+        return 1;
+    }
+    
+    // the score changes, and the same text at another size or spacing is its own run
+    std::string nextScore = "P1 - 1";
+    const GlyphRun &changed = text.layout(nextScore, 0.3f, 0.05f);
+    if (!checkRun("changed string", changed, nextScore, 0.3f, 0.05f, 0.0f, 0.0f, 1.0f, 1.0f) || !checkRebuilds("changed string", text, 2, 2)) {
+        return 1;
+    }
+    const GlyphRun &bigger = text.layout(score, 0.5f, 0.05f);
+    const GlyphRun &wider = text.layout(score, 0.3f, 0.1f);
+    if (!checkRun("another size", bigger, score, 0.5f, 0.05f, 0.0f, 0.0f, 1.0f, 1.0f) ||
+        !checkRun("another spacing", wider, score, 0.3f, 0.1f, 0.0f, 0.0f, 1.0f, 1.0f) || !checkRebuilds("another size and spacing", text, 4, 4)) {
+        return 1;
+    }
+    
+    // a font packed into a corner of an atlas, the cached runs get the new cells in place
+    text.setFontRegion(0.5f, 0.25f, 0.5f, 0.5f);
+    if (!checkRun("moved font", run, score, 0.3f, 0.05f, 0.5f, 0.25f, 0.5f, 0.5f) || !checkRebuilds("moved font", text, 4, 4)) {
+        return 1;
+    }
+    text.setFontRegion(0.0f, 0.0f, 1.0f, 1.0f);
+    
+    // two strings in a frame are one draw, each moved to where it was asked for
+    gl.reset();
+    text.draw(score, 0.3f, 0.05f, -2.5f, 1.5f);
+    text.draw("PONG", 0.2f, 0.0f, 1.0f, -1.0f);
+    text.flush(&program, 9);
+    if (gl.draws.size() != 1 || gl.draws[0].textureID != 9 || gl.draws[0].indices.size() != (score.size() + 4) * 6) {
+        printf("flushing two strings: %d draws, should be 1 of %d indices\n", (int)gl.draws.size(), (int)(score.size() + 4) * 6);
+        return 1;
+    }
+    const StubVertex &first = gl.draws[0].vertices[0];
+    const StubVertex &pong = gl.draws[0].vertices[score.size() * 4];
+    if (!near(first.x, -2.5f - 0.15f) || !near(first.y, 1.5f - 0.15f) || !near(pong.x, 1.0f - 0.1f) || !near(pong.y, -1.0f - 0.1f)) {
+        printf("flushing two strings: they start at %g,%g and %g,%g\n", first.x, first.y, pong.x, pong.y);
+        return 1;
+    }
+    if (!checkRebuilds("flushing two strings", text, 5, 5)) {
+        return 1;
+    }
+    
+    // only the score keeps being drawn, everything else ages out of the cache
+    for (int frame = 0; frame <= TEXT_CACHE_FRAMES; frame++) {
+        text.draw(score, 0.3f, 0.05f, -2.5f, 1.5f);
+        text.flush(&program, 9);
+    }
+    if (!checkRebuilds("after the other strings went unused", text, 5, 1)) {
+        return 1;
+    }
+    text.layout(nextScore, 0.3f, 0.05f);
+    if (!checkRebuilds("a dropped string again", text, 6, 2)) {
+        return 1;
+    }
+    printf("layout, cache hits, rebuilds, font regions, one draw a frame and dropping unused strings all check out\n");
+    return 0;
+}
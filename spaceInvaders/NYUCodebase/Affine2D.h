@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Matrix.h"
+
+/*
+    A 2D transform, the only part of a 4x4 Matrix our sprites ever use
+    | a c tx |
+    | b d ty |
+    Translate, Scale and Rotate compose the same way the Matrix ones do (the new one is applied to the
+    object first), they just change the six numbers in place instead of multiplying two 4x4s
+*/
+class Affine2D {
+    public:
+        Affine2D();
+    
+        float a, b, c, d;
+        float tx, ty;
+    
+        void identity();
+    
+        void Translate(float x, float y);
+        void Scale(float x, float y);
+        void Rotate(float rotation);
+    
+        // Writes the transform into a 4x4 for ShaderProgram, z and w are left alone
+        void toMatrix(Matrix &matrix) const;
+        Matrix toMatrix() const;
+    
+        void transformPoint(float x, float y, float &outX, float &outY) const;
+        // count (x, y) pairs from in to out, in and out can be the same array
+        void transformPoints(const float *in, float *out, int count) const;
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+
+// Uniform grid over a fixed area, answers "which boxes overlap this box" without testing every box
+// Anything outside the area gets clamped into the edge cells, so it still works, just slower out there
+class BroadPhase {
+    public:
+        BroadPhase(float minX, float minY, float maxX, float maxY, float cellSize);
+    
+        // Throw away everything that was inserted, keeps the memory around for next frame
+        void clear();
+    
+        // Add a box, id is whatever the caller uses to find the object again. The game passes the invader's
+        // index into its CollisionView, so the hit is entity firstInvader + id in the EntityStore
+        void insert(int id, float left, float bot, float right, float top);
+    
+        // Sort the inserted boxes into their cells, call once after the inserts and before any query
+        void build();
+    
+        // Fills results with the ids of every box touching this one, each id only once
+        void query(float left, float bot, float right, float top, std::vector<int> &results);
+    
+        int boxCount() const;
+    
+        // Boxes looked at vs boxes that actually overlapped, since the last clear()
+        int candidatesTested;
+        int overlapsFound;
+    
+    private:
+        struct Box {
+            int id;
+            float left, bot, right, top;
+        };
+    
+        int cellX(float x) const;
+        int cellY(float y) const;
+    
+        float minX, minY;
+        float cellSize;
+        int columns, rows;
+    
+        std::vector<Box> boxes;
+        // cellStart[c] to cellStart[c + 1] is where cell c's entries sit in cellEntries
+        std::vector<int> cellStart;
+        std::vector<int> cellEntries;
+        // last query that saw each box, so a box spanning several cells is only reported once
+        std::vector<int> lastQuery;
+        int queryCount;
+};
@@ -0,0 +1,58 @@
+#include "EntityStore.h"
+
+int EntityStore::add(int sprite, float x, float y, float width, float height, float velocity_x, float velocity_y, bool alive)
+{
+    this->sprite.push_back(sprite);
+    this->x.push_back(x);
+    this->y.push_back(y);
+    this->width.push_back(width);
+    this->height.push_back(height);
+    this->velocity_x.push_back(velocity_x);
+    this->velocity_y.push_back(velocity_y);
+    this->alive.push_back(alive ? 1 : 0);
+    return (int)this->x.size() - 1;
+}
+
+void EntityStore::clear()
+{
+    sprite.clear();
+    x.clear();
+    y.clear();
+    width.clear();
+    height.clear();
+    velocity_x.clear();
+    velocity_y.clear();
+    alive.clear();
+}
+
+int EntityStore::size() const
+{
+    return (int)x.size();
+}
+
+MovementView movementView(EntityStore &store, int first, int count)
+{
+    MovementView view = {store.x.data() + first, store.y.data() + first, store.velocity_x.data() + first, store.velocity_y.data() + first, store.alive.data() + first, count};
+    return view;
+}
+
+CollisionView collisionView(EntityStore &store, int first, int count)
+{
+    CollisionView view = {store.x.data() + first, store.y.data() + first, store.width.data() + first, store.height.data() + first, store.alive.data() + first, count};
+    return view;
+}
+
+RenderView renderView(EntityStore &store, int first, int count)
+{
+    RenderView view = {store.sprite.data() + first, store.x.data() + first, store.y.data() + first, store.width.data() + first, store.height.data() + first, store.alive.data() + first, count};
+    return view;
+}
+
+void integrate(MovementView view, float elapsed)
+{
+    for (int i = 0; i < view.count; i++){
+        float step = elapsed * (float)view.alive[i];
+        view.x[i] += view.velocity_x[i] * step;
+        view.y[i] += view.velocity_y[i] * step;
+    }
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#ifdef _WINDOWS
+	#include <GL/glew.h>
+#endif
+#include <SDL_opengl.h>
+#include <vector>
+#include "Matrix.h"
+#include "ShaderProgram.h"
+#include "TypedShaderProgram.h"
+#include "SpriteBatch.h"
+
+// Attributes of vertex_instanced.glsl, the corner comes from the unit quad and the rest change once per sprite
+struct Corner { static const char *name() { return "corner"; } };
+struct InstanceTransform { static const char *name() { return "instanceTransform"; } };
+struct InstanceRotation { static const char *name() { return "instanceRotation"; } };
+struct InstanceUV { static const char *name() { return "instanceUV"; } };
+
+typedef ShaderLayout<Uniforms<ViewMatrix, ProjectionMatrix>,
+                     Attributes<Corner, InstanceTransform, InstanceRotation, InstanceUV> > InstancedLayout;
+
+// Sprites described by where they are instead of by their vertices. With instancing every sprite on a
+// texture is one glDrawArraysInstanced of a unit quad, otherwise they get turned into quads and drawn
+// through a plain SpriteBatch like before.
+class InstancedSpriteBatch {
+    public:
+        InstancedSpriteBatch();
+    
+        // Needs a GL context. Builds the instancing shader when the driver can do it, otherwise
+        // everything goes through the fallback
+        void init(const char *vertexShaderFile, const char *fragmentShaderFile);
+        // Frees the shader and buffers, call it while the GL context is still around
+        void clear();
+    
+        // Switch to the fallback to compare, it can't be switched on if the driver doesn't have it
+        void setInstancing(bool enabled);
+        bool instancing() const;
+        static bool instancingSupported();
+    
+        // Start a new frame, clears the sprites and the counters
+        void begin();
+    
+        // A width x height sprite centered on x, y turned by rotation radians, showing the u, v, uvWidth, uvHeight
+        // part of the texture with v going down the texture like SpriteSheet
+        void draw(GLuint textureID, float x, float y, float width, float height, float rotation,
+                  float u, float v, float uvWidth, float uvHeight);
+    
+        // Draw everything since begin(). program is the regular textured shader, the fallback draws with it
+        // and the instanced shader gets the same view and projection
+        void end(ShaderProgram *program, const Matrix &viewMatrix, const Matrix &projectionMatrix);
+    
+        int spriteCount() const;
+    
+        // How much work the last end() sent to GL
+        int drawCalls;
+        int instancesDrawn;
+        int bytesUploaded;
+    
+    private:
+        // What the shader reads per instance, in the order the attributes sit in the buffer
+        struct InstanceData {
+            float x, y, width, height;
+            float rotation;
+            float u, v, uvWidth, uvHeight;
+        };
+        struct Sprite {
+            GLuint textureID;
+            InstanceData data;
+        };
+    
+        InstancedSpriteBatch(const InstancedSpriteBatch &);
+        InstancedSpriteBatch &operator=(const InstancedSpriteBatch &);
+    
+        void endInstanced(const Matrix &viewMatrix, const Matrix &projectionMatrix);
+        void endFallback(ShaderProgram *program);
+        void pointInstanceAttributes(size_t firstInstance);
+    
+        std::vector<Sprite> sprites;
+        std::vector<InstanceData> uploadData;
+    
+        TypedShaderProgram<InstancedLayout> *instancedProgram;
+        GLuint quadBuffer;
+        GLuint instanceBuffer;
+        bool useInstancing;
+    
+        SpriteBatch fallback;
+};
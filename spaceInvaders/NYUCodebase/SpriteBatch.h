@@ -0,0 +1,48 @@
+#pragma once
+
+#ifdef _WINDOWS
+	#include <GL/glew.h>
+#endif
+#include <SDL_opengl.h>
+#include <vector>
+#include "Matrix.h"
+#include "Affine2D.h"
+#include "ShaderProgram.h"
+#include "QuadMesh.h"
+
+// Collects textured quads for a frame and draws them with one glDrawElements per texture
+class SpriteBatch {
+    public:
+        SpriteBatch();
+    
+        // Start a new frame, clears the quads and the counters
+        void begin();
+    
+        // Add one 6 vertex quad in SpriteSheet's corner order (bottom left, top right, top left, top right,
+        // bottom left, bottom right), the model matrix is applied here on the CPU. Only the 4 corners are kept
+        void draw(GLuint textureID, const Matrix &modelMatrix, const float *vertices, const float *texCoords);
+        void draw(GLuint textureID, const Affine2D &transform, const float *vertices, const float *texCoords);
+    
+        // Sort by texture and draw everything that was added since begin()
+        void end(ShaderProgram *program);
+    
+        int quadCount() const;
+    
+        // How much work the last end() sent to GL
+        int drawCalls;
+        int verticesDrawn;
+        int bytesUploaded;
+    
+    private:
+        struct Quad {
+            GLuint textureID;
+            float vertices[8];
+            float texCoords[8];
+        };
+    
+        void addQuad(GLuint textureID, const float *corners, const float *texCoords);
+    
+        std::vector<Quad> quads;
+        // floats for the positions since sprites can be anywhere, the texture coordinates are packed
+        QuadMesh mesh;
+};
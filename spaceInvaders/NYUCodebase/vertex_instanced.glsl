@@ -0,0 +1,22 @@
+// One unit quad drawn once per sprite, everything else about the sprite comes in per instance
+attribute vec2 corner;
+attribute vec4 instanceTransform;
+attribute float instanceRotation;
+attribute vec4 instanceUV;
+
+uniform mat4 viewMatrix;
+uniform mat4 projectionMatrix;
+
+varying vec2 texCoordVar;
+
+void main()
+{
+	// instanceTransform is the x, y offset then the width and height
+	vec2 scaled = corner * instanceTransform.zw;
+	float c = cos(instanceRotation);
+	float s = sin(instanceRotation);
+	vec2 world = vec2(c * scaled.x - s * scaled.y, s * scaled.x + c * scaled.y) + instanceTransform.xy;
+	// instanceUV is u, v, width, height with v pointing down the texture like the sprite sheets
+	texCoordVar = instanceUV.xy + vec2(corner.x + 0.5, 0.5 - corner.y) * instanceUV.zw;
+	gl_Position = projectionMatrix * viewMatrix * vec4(world, 0.0, 1.0);
+}
@@ -0,0 +1,114 @@
+/*
+    broadPhaseBench [invaders bullets]
+
+    Finds every bullet/invader overlap the way GameState::update does, through a BroadPhase grid, and the way it
+    used to, every bullet against every invader. Checks both find the same pairs, then times a step of each as the
+    counts go up. Anything that doesn't agree is printed and the exit code is 1.
+    Builds on its own, from this folder:
+        c++ -O2 -I../NYUCodebase broadPhaseBench.cpp ../NYUCodebase/BroadPhase.cpp -o broadPhaseBench
+*/
+
+#include "BroadPhase.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+
+struct Box {
+    float left, bot, right, top;
+};
+
+// Somewhere in the play area, the same size as the game's invaders or bullets
+static std::vector<Box> randomBoxes(int count, float width, float height) {
+    std::vector<Box> boxes(count);
+    for (int i = 0; i < count; i++) {
+        float x = -3.5f + 7.0f * rand() / RAND_MAX;
+        float y = -2.0f + 4.0f * rand() / RAND_MAX;
+        boxes[i].left = x - width / 2.0f;
+        boxes[i].right = x + width / 2.0f;
+        boxes[i].bot = y - height / 2.0f;
+        boxes[i].top = y + height / 2.0f;
+    }
+    return boxes;
+}
+
+// The test the game has always used, touching edges count as a hit
+static bool overlaps(const Box &a, const Box &b) {
+    return !(a.bot > b.top) && !(a.top < b.bot) && !(a.left > b.right) && !(a.right < b.left);
+}
+
+static double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Every bullet, invader pair that overlaps, bullet * invaders + invader
+static void nestedLoops(const std::vector<Box> &bullets, const std::vector<Box> &invaders, std::vector<long long> &pairs) {
+    pairs.clear();
+    for (size_t b = 0; b < bullets.size(); b++) {
+        for (size_t i = 0; i < invaders.size(); i++) {
+            if (overlaps(bullets[b], invaders[i])) {
+                pairs.push_back((long long)b * invaders.size() + i);
+            }
+        }
+    }
+}
+
+// Same as a game step: fill the grid with the invaders, then ask it about each bullet
+static void gridQueries(BroadPhase &grid, const std::vector<Box> &bullets, const std::vector<Box> &invaders, std::vector<int> &hits, std::vector<long long> &pairs) {
+    pairs.clear();
+    grid.clear();
+    for (size_t i = 0; i < invaders.size(); i++) {
+        grid.insert((int)i, invaders[i].left, invaders[i].bot, invaders[i].right, invaders[i].top);
+    }
+    grid.build();
+    for (size_t b = 0; b < bullets.size(); b++) {
+        grid.query(bullets[b].left, bullets[b].bot, bullets[b].right, bullets[b].top, hits);
+        for (size_t h = 0; h < hits.size(); h++) {
+            pairs.push_back((long long)b * invaders.size() + hits[h]);
+        }
+    }
+}
+
+static bool run(int invaderCount, int bulletCount) {
+    // the game's invader and bullet sizes, and its grid
+    std::vector<Box> invaders = randomBoxes(invaderCount, 0.5f, 0.5f);
+    std::vector<Box> bullets = randomBoxes(bulletCount, 0.1f, 0.2f);
+    BroadPhase grid(-4.0f, -2.5f, 4.0f, 2.5f, 0.5f);
+    std::vector<int> hits;
+    std::vector<long long> expected, found;
+    
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    nestedLoops(bullets, invaders, expected);
+    double loopTime = seconds(start);
+    
+    int repeats = 10;
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; r++) {
+        gridQueries(grid, bullets, invaders, hits, found);
+    }
+    double gridTime = seconds(start) / repeats;
+    
+    // the grid hands pairs back in cell order, not invader order
+    std::sort(found.begin(), found.end());
+    if (found != expected) {
+        printf("%d invaders, %d bullets: the grid found %d pairs, the loops found %d\n", invaderCount, bulletCount, (int)found.size(), (int)expected.size());
+        return false;
+    }
+    printf("%6d invaders %6d bullets: nested loops %9.3f ms, grid %7.3f ms a step (%d overlaps, %d candidates)\n",
+           invaderCount, bulletCount, loopTime * 1e3, gridTime * 1e3, (int)found.size(), grid.candidatesTested);
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    srand(1);
+    if (argc == 3) {
+        return run(atoi(argv[1]), atoi(argv[2])) ? 0 : 1;
+    }
+    if (argc != 1) {
+        printf("usage: broadPhaseBench [invaders bullets]\n");
+        return 1;
+    }
+    // the game's own 2 bullets and a screen of invaders, then on up
+    bool ok = run(55, 2) && run(55, 30) && run(1000, 100) && run(5000, 1000) && run(20000, 5000);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,176 @@
+/*
+    entityStoreBench [invaders]
+
+    Times the invader part of a game step, filling the broad phase and then moving and bouncing every invader, over the
+    EntityStore arrays the game uses now and over a copy of the Entity objects it used to keep in a vector.
+    Both run the same steps from the same start and have to end up with every invader in the same place,
+    anything that doesn't is printed and the exit code is 1.
+    Builds on its own, from this folder:
+        c++ -O2 -I../NYUCodebase entityStoreBench.cpp ../NYUCodebase/EntityStore.cpp ../NYUCodebase/BroadPhase.cpp -o entityStoreBench
+*/
+
+#include "EntityStore.h"
+#include "BroadPhase.h"
+#include "Matrix.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+#define INVADER_SPEED 1.0f
+#define STEP (1.0f / 60.0f)
+
+// What Entity used to hold, laid out the same way, and the parts of it a step used
+struct OldEntity {
+    // SpriteSheet
+    unsigned int textureID;
+    float u, v, spriteWidth, spriteHeight, size, aspect;
+    
+    Matrix matrix;
+    float x;
+    float y;
+    float width;
+    float height;
+    float rotation;
+    
+    float max_vel;
+    float velocity_x;
+    float velocity_y;
+    float max_accel;
+    float acceleration_x;
+    float acceleration_y;
+    float friction_x;
+    float friction_y;
+    
+    bool affectedByPlayer;
+    bool alive;
+    std::vector<OldEntity> bullets;
+    bool bullet;
+    bool usable;
+    int direction;
+    
+    void move(float timePerFrame)
+    {
+        velocity_x = max_vel;
+        x+= (float) direction * velocity_x * timePerFrame;
+        y+= velocity_y * timePerFrame;
+        velocity_x = 0;
+        velocity_y = 0;
+    }
+};
+
+// The old GameState::update, just the invaders: into the broad phase, then moving
+static void oldFill(std::vector<OldEntity> &stateObjects, BroadPhase &grid) {
+    grid.clear();
+    for (int i = 0; i < (int)stateObjects.size(); i++) {
+        if (!stateObjects[i].affectedByPlayer && !stateObjects[i].bullet && stateObjects[i].alive){
+            grid.insert(i, stateObjects[i].x - stateObjects[i].width / 2.0f, stateObjects[i].y - stateObjects[i].height / 2.0f,
+                        stateObjects[i].x + stateObjects[i].width / 2.0f, stateObjects[i].y + stateObjects[i].height / 2.0f);
+        }
+    }
+    grid.build();
+}
+
+static void oldMove(std::vector<OldEntity> &stateObjects) {
+    for (int i = 0; i < (int)stateObjects.size(); i++) {
+        if (!stateObjects[i].affectedByPlayer && !stateObjects[i].bullet && stateObjects[i].alive){
+            stateObjects[i].move(STEP);
+            if (stateObjects[i].x >= 3.50 || stateObjects[i].x < -3.50){
+                stateObjects[i].direction *= -1;
+                stateObjects[i].move(STEP);
+                stateObjects[i].y -=0.3f;
+            }
+        }
+    }
+}
+
+// GameState::update as it is now, the same two parts
+static void storeFill(EntityStore &entities, BroadPhase &grid) {
+    CollisionView invaders = collisionView(entities, 0, entities.size());
+    grid.clear();
+    for (int i = 0; i < invaders.count; i++) {
+        if (invaders.alive[i]){
+            grid.insert(i, invaders.x[i] - invaders.width[i] / 2.0f, invaders.y[i] - invaders.height[i] / 2.0f,
+                        invaders.x[i] + invaders.width[i] / 2.0f, invaders.y[i] + invaders.height[i] / 2.0f);
+        }
+    }
+    grid.build();
+}
+
+static void storeMove(EntityStore &entities) {
+    MovementView invaderMovement = movementView(entities, 0, entities.size());
+    integrate(invaderMovement, STEP);
+    for (int i = 0; i < invaderMovement.count; i++) {
+        if (invaderMovement.alive[i] && (invaderMovement.x[i] >= 3.50 || invaderMovement.x[i] < -3.50)){
+            invaderMovement.velocity_x[i] *= -1;
+            invaderMovement.x[i] += invaderMovement.velocity_x[i] * STEP;
+            invaderMovement.y[i] -= 0.3f;
+        }
+    }
+}
+
+static double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[]) {
+    int count = argc > 1 ? atoi(argv[1]) : 10000;
+    if (count < 1) {
+        printf("usage: entityStoreBench [invaders]\n");
+        return 1;
+    }
+    
+    // invaders scattered over the screen going either way, each one the same in both layouts
+    std::vector<OldEntity> stateObjects(count);
+    EntityStore entities;
+    srand(1);
+    for (int i = 0; i < count; i++) {
+        float x = -3.4f + 6.8f * rand() / RAND_MAX;
+        float y = -2.0f + 4.0f * rand() / RAND_MAX;
+        int direction = rand() % 2 ? 1 : -1;
+        OldEntity &old = stateObjects[i];
+        old.x = x;
+        old.y = y;
+        old.width = 0.5f;
+        old.height = 0.5f;
+        old.max_vel = INVADER_SPEED;
+        old.velocity_x = 0.0f;
+        old.velocity_y = 0.0f;
+        old.affectedByPlayer = false;
+        old.bullet = false;
+        old.alive = true;
+        old.usable = true;
+        old.direction = direction;
+        entities.add(2, x, y, 0.5f, 0.5f, direction * INVADER_SPEED, 0.0f, true);
+    }
+    BroadPhase oldGrid(-4.0f, -2.5f, 4.0f, 2.5f, 0.5f);
+    BroadPhase storeGrid(-4.0f, -2.5f, 4.0f, 2.5f, 0.5f);
+    
+    // steps alternate the two parts the way the game does, each part's time is added up on its own
+    int steps = 600;
+    double oldFillTime = 0.0, oldMoveTime = 0.0, storeFillTime = 0.0, storeMoveTime = 0.0;
+    for (int s = 0; s < steps; s++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        oldFill(stateObjects, oldGrid);
+        oldFillTime += seconds(start);
+        start = std::chrono::steady_clock::now();
+        oldMove(stateObjects);
+        oldMoveTime += seconds(start);
+        start = std::chrono::steady_clock::now();
+        storeFill(entities, storeGrid);
+        storeFillTime += seconds(start);
+        start = std::chrono::steady_clock::now();
+        storeMove(entities);
+        storeMoveTime += seconds(start);
+    }
+    
+    for (int i = 0; i < count; i++) {
+        if (stateObjects[i].x != entities.x[i] || stateObjects[i].y != entities.y[i]) {
+            printf("Invader %d ended up at %g,%g, the old entities put it at %g,%g\n", i, entities.x[i], entities.y[i], stateObjects[i].x, stateObjects[i].y);
+            return 1;
+        }
+    }
+    printf("%d invaders, %d bytes each as an Entity, a step takes\n", count, (int)sizeof(OldEntity));
+    printf("    Entity vector: %8.1f us filling the broad phase, %8.1f us moving\n", oldFillTime / steps * 1e6, oldMoveTime / steps * 1e6);
+    printf("    EntityStore:   %8.1f us filling the broad phase, %8.1f us moving\n", storeFillTime / steps * 1e6, storeMoveTime / steps * 1e6);
+    return 0;
+}
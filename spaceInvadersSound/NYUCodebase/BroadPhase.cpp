@@ -0,0 +1,116 @@
+#include "BroadPhase.h"
+#include <algorithm>
+#include <math.h>
+
+BroadPhase::BroadPhase(float minX, float minY, float maxX, float maxY, float cellSize)
+: candidatesTested(0), overlapsFound(0), minX(minX), minY(minY), cellSize(cellSize), queryCount(0) {
+    columns = (int)ceilf((maxX - minX) / cellSize);
+    rows = (int)ceilf((maxY - minY) / cellSize);
+    if (columns < 1) {
+        columns = 1;
+    }
+    if (rows < 1) {
+        rows = 1;
+    }
+    cellStart.resize(columns * rows + 1, 0);
+}
+
+void BroadPhase::clear() {
+    boxes.clear();
+    cellEntries.clear();
+    candidatesTested = 0;
+    overlapsFound = 0;
+}
+
+void BroadPhase::insert(int id, float left, float bot, float right, float top) {
+    Box box;
+    box.id = id;
+    box.left = left;
+    box.bot = bot;
+    box.right = right;
+    box.top = top;
+    boxes.push_back(box);
+}
+
+int BroadPhase::cellX(float x) const {
+    int cell = (int)floorf((x - minX) / cellSize);
+    if (cell < 0) {
+        return 0;
+    }
+    if (cell >= columns) {
+        return columns - 1;
+    }
+    return cell;
+}
+
+int BroadPhase::cellY(float y) const {
+    int cell = (int)floorf((y - minY) / cellSize);
+    if (cell < 0) {
+        return 0;
+    }
+    if (cell >= rows) {
+        return rows - 1;
+    }
+    return cell;
+}
+
+void BroadPhase::build() {
+    // Counting sort: count boxes per cell, turn the counts into offsets, then drop the boxes in
+    std::fill(cellStart.begin(), cellStart.end(), 0);
+    for (size_t i = 0; i < boxes.size(); i++) {
+        for (int y = cellY(boxes[i].bot); y <= cellY(boxes[i].top); y++) {
+            for (int x = cellX(boxes[i].left); x <= cellX(boxes[i].right); x++) {
+                cellStart[y * columns + x + 1]++;
+            }
+        }
+    }
+    for (int c = 0; c < columns * rows; c++) {
+        cellStart[c + 1] += cellStart[c];
+    }
+    cellEntries.resize(cellStart[columns * rows]);
+    
+    // cellStart[c] gets bumped as cell c fills, then shifted back afterwards
+    for (size_t i = 0; i < boxes.size(); i++) {
+        for (int y = cellY(boxes[i].bot); y <= cellY(boxes[i].top); y++) {
+            for (int x = cellX(boxes[i].left); x <= cellX(boxes[i].right); x++) {
+                cellEntries[cellStart[y * columns + x]++] = (int)i;
+            }
+        }
+    }
+    for (int c = columns * rows; c > 0; c--) {
+        cellStart[c] = cellStart[c - 1];
+    }
+    cellStart[0] = 0;
+    
+    lastQuery.assign(boxes.size(), -1);
+    queryCount = 0;
+}
+
+void BroadPhase::query(float left, float bot, float right, float top, std::vector<int> &results) {
+    results.clear();
+    queryCount++;
+    for (int y = cellY(bot); y <= cellY(top); y++) {
+        for (int x = cellX(left); x <= cellX(right); x++) {
+            int cell = y * columns + x;
+            for (int e = cellStart[cell]; e < cellStart[cell + 1]; e++) {
+                int boxIdx = cellEntries[e];
+                if (lastQuery[boxIdx] == queryCount) {
+                    continue;
+                }
+                lastQuery[boxIdx] = queryCount;
+                candidatesTested++;
+                
+                // Same test the game always used, touching edges count as a hit
+                const Box &box = boxes[boxIdx];
+                if (!(bot > box.top) && !(top < box.bot) && !(left > box.right) && !(right < box.left)) {
+                    results.push_back(box.id);
+                    overlapsFound++;
+                }
+            }
+        }
+    }
+}
+
+int BroadPhase::boxCount() const {
+    return (int)boxes.size();
+}
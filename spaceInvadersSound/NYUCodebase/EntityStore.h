@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vector>
+
+// Structure of arrays for every object in the game, entity i is x[i], y[i], width[i] and so on
+// The game keeps them grouped: the player, then its bullets, then the invaders
+class EntityStore
+{
+public:
+    int add(int sprite, float x, float y, float width, float height, float velocity_x, float velocity_y, bool alive);
+    void clear();
+    int size() const;
+    
+    // Which SpriteSheet in GameState::sprites to draw it with
+    std::vector<int> sprite;
+    // Position is the center, width and height are the scale (and the collision box)
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> width;
+    std::vector<float> height;
+    // Units per second
+    std::vector<float> velocity_x;
+    std::vector<float> velocity_y;
+    // Invaders and the player: still in the game. Bullets: flying, not waiting to be shot
+    std::vector<unsigned char> alive;
+};
+
+/*
+    Views hand a pass just the arrays it needs for a range of entities
+    so each loop walks a few tightly packed arrays instead of whole objects
+*/
+struct MovementView
+{
+    float *x;
+    float *y;
+    float *velocity_x;
+    float *velocity_y;
+    const unsigned char *alive;
+    int count;
+};
+
+struct CollisionView
+{
+    const float *x;
+    const float *y;
+    const float *width;
+    const float *height;
+    unsigned char *alive;
+    int count;
+};
+
+struct RenderView
+{
+    const int *sprite;
+    const float *x;
+    const float *y;
+    const float *width;
+    const float *height;
+    const unsigned char *alive;
+    int count;
+};
+
+MovementView movementView(EntityStore &store, int first, int count);
+CollisionView collisionView(EntityStore &store, int first, int count);
+RenderView renderView(EntityStore &store, int first, int count);
+
+// Move everything that's alive, no branches so the compiler can vectorize it
+void integrate(MovementView view, float elapsed);
@@ -0,0 +1,205 @@
+#include "InstancedSpriteBatch.h"
+#include "Affine2D.h"
+#include <string.h>
+#include <stddef.h>
+#include <algorithm>
+
+// glew declares the ARB calls itself, everywhere else glext.h only does with GL_GLEXT_PROTOTYPES.
+// The mac's OpenGL framework has them too, the Xcode projects define GL_GLEXT_PROTOTYPES so they get used there
+#if defined(GL_ARB_instanced_arrays) && defined(GL_ARB_draw_instanced) && (defined(_WINDOWS) || defined(GL_GLEXT_PROTOTYPES))
+#define SPRITE_INSTANCING
+#endif
+
+// Two triangles in the same corner order SpriteSheet uses
+static const float unitQuad[12] = {
+    -0.5f, -0.5f,
+    0.5f, 0.5f,
+    -0.5f, 0.5f,
+    0.5f, 0.5f,
+    -0.5f, -0.5f,
+    0.5f, -0.5f
+};
+
+InstancedSpriteBatch::InstancedSpriteBatch()
+: drawCalls(0), instancesDrawn(0), bytesUploaded(0), instancedProgram(NULL), quadBuffer(0), instanceBuffer(0), useInstancing(false) {}
+
+void InstancedSpriteBatch::clear() {
+    delete instancedProgram;
+    instancedProgram = NULL;
+    if (quadBuffer) {
+        glDeleteBuffers(1, &quadBuffer);
+        glDeleteBuffers(1, &instanceBuffer);
+        quadBuffer = 0;
+        instanceBuffer = 0;
+    }
+    useInstancing = false;
+}
+
+bool InstancedSpriteBatch::instancingSupported() {
+#ifdef SPRITE_INSTANCING
+#ifdef _WINDOWS
+    if (!glVertexAttribDivisorARB || !glDrawArraysInstancedARB) {
+        return false;
+    }
+#endif
+    const char *extensions = (const char *)glGetString(GL_EXTENSIONS);
+    return extensions && strstr(extensions, "GL_ARB_instanced_arrays") && strstr(extensions, "GL_ARB_draw_instanced");
+#else
+    return false;
+#endif
+}
+
+void InstancedSpriteBatch::init(const char *vertexShaderFile, const char *fragmentShaderFile) {
+    if (instancedProgram || !instancingSupported()) {
+        return;
+    }
+    instancedProgram = new TypedShaderProgram<InstancedLayout>(vertexShaderFile, fragmentShaderFile);
+    if (instancedProgram->attribute<Corner>() == -1 || instancedProgram->attribute<InstanceTransform>() == -1 ||
+        instancedProgram->attribute<InstanceRotation>() == -1 || instancedProgram->attribute<InstanceUV>() == -1) {
+        printf("Instanced sprite shader is missing attributes, using the regular sprite batch\n");
+        delete instancedProgram;
+        instancedProgram = NULL;
+        return;
+    }
+    
+    glGenBuffers(1, &quadBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, quadBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(unitQuad), unitQuad, GL_STATIC_DRAW);
+    glGenBuffers(1, &instanceBuffer);
+    // everything else in the game draws from client side arrays, which only works with no buffer bound
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    useInstancing = true;
+}
+
+void InstancedSpriteBatch::setInstancing(bool enabled) {
+    useInstancing = enabled && instancedProgram != NULL;
+}
+
+bool InstancedSpriteBatch::instancing() const {
+    return useInstancing;
+}
+
+void InstancedSpriteBatch::begin() {
+    sprites.clear();
+    drawCalls = 0;
+    instancesDrawn = 0;
+    bytesUploaded = 0;
+}
+
+void InstancedSpriteBatch::draw(GLuint textureID, float x, float y, float width, float height, float rotation,
+                                float u, float v, float uvWidth, float uvHeight) {
+    Sprite sprite = {textureID, {x, y, width, height, rotation, u, v, uvWidth, uvHeight}};
+    sprites.push_back(sprite);
+}
+
+void InstancedSpriteBatch::end(ShaderProgram *program, const Matrix &viewMatrix, const Matrix &projectionMatrix) {
+    if (sprites.empty()) {
+        return;
+    }
+    // Stable so sprites sharing a texture keep the order they were drawn in
+    std::stable_sort(sprites.begin(), sprites.end(), [](const Sprite &a, const Sprite &b) {
+        return a.textureID < b.textureID;
+    });
+    if (useInstancing) {
+        endInstanced(viewMatrix, projectionMatrix);
+    } else {
+        endFallback(program);
+    }
+}
+
+void InstancedSpriteBatch::pointInstanceAttributes(size_t firstInstance) {
+    // no base instance in GL 2.1, so each texture's run gets the attributes pointed at where it starts
+    const char *base = (const char *)(firstInstance * sizeof(InstanceData));
+    GLsizei stride = sizeof(InstanceData);
+    glVertexAttribPointer(instancedProgram->attribute<InstanceTransform>(), 4, GL_FLOAT, false, stride, base + offsetof(InstanceData, x));
+    glVertexAttribPointer(instancedProgram->attribute<InstanceRotation>(), 1, GL_FLOAT, false, stride, base + offsetof(InstanceData, rotation));
+    glVertexAttribPointer(instancedProgram->attribute<InstanceUV>(), 4, GL_FLOAT, false, stride, base + offsetof(InstanceData, u));
+}
+
+#ifdef SPRITE_INSTANCING
+void InstancedSpriteBatch::endInstanced(const Matrix &viewMatrix, const Matrix &projectionMatrix) {
+    instancedProgram->use();
+    instancedProgram->set<ViewMatrix>(viewMatrix);
+    instancedProgram->set<ProjectionMatrix>(projectionMatrix);
+    
+    // The whole frame's instances go up in one buffer
+    uploadData.clear();
+    for (size_t i = 0; i < sprites.size(); i++) {
+        uploadData.push_back(sprites[i].data);
+    }
+    GLsizeiptr uploadSize = (GLsizeiptr)(uploadData.size() * sizeof(InstanceData));
+    
+    glBindBuffer(GL_ARRAY_BUFFER, quadBuffer);
+    glVertexAttribPointer(instancedProgram->attribute<Corner>(), 2, GL_FLOAT, false, 0, 0);
+    glEnableVertexAttribArray(instancedProgram->attribute<Corner>());
+    
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    // a fresh buffer every frame so the driver doesn't wait on last frame's draws
+    glBufferData(GL_ARRAY_BUFFER, uploadSize, uploadData.data(), GL_STREAM_DRAW);
+    bytesUploaded += (int)uploadSize;
+    
+    const GLint instanceAttributes[3] = {
+        instancedProgram->attribute<InstanceTransform>(), instancedProgram->attribute<InstanceRotation>(), instancedProgram->attribute<InstanceUV>()
+    };
+    for (int i = 0; i < 3; i++) {
+        glEnableVertexAttribArray(instanceAttributes[i]);
+        glVertexAttribDivisorARB(instanceAttributes[i], 1);
+    }
+    
+    size_t start = 0;
+    while (start < sprites.size()) {
+        GLuint textureID = sprites[start].textureID;
+        size_t end = start;
+        while (end < sprites.size() && sprites[end].textureID == textureID) {
+            end++;
+        }
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        pointInstanceAttributes(start);
+        glDrawArraysInstancedARB(GL_TRIANGLES, 0, 6, (GLsizei)(end - start));
+        drawCalls++;
+        instancesDrawn += (int)(end - start);
+        start = end;
+    }
+    
+    // attribute slots are shared with every other program, leave them how the non-instanced draws expect
+    for (int i = 0; i < 3; i++) {
+        glVertexAttribDivisorARB(instanceAttributes[i], 0);
+        glDisableVertexAttribArray(instanceAttributes[i]);
+    }
+    glDisableVertexAttribArray(instancedProgram->attribute<Corner>());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+#else
+// useInstancing never gets set without the calls, so this never runs
+void InstancedSpriteBatch::endInstanced(const Matrix &, const Matrix &) {
+}
+#endif
+
+void InstancedSpriteBatch::endFallback(ShaderProgram *program) {
+    fallback.begin();
+    for (size_t i = 0; i < sprites.size(); i++) {
+        const InstanceData &data = sprites[i].data;
+        Affine2D transform;
+        transform.Translate(data.x, data.y);
+        transform.Rotate(data.rotation);
+        transform.Scale(data.width, data.height);
+        float u = data.u, v = data.v, width = data.uvWidth, height = data.uvHeight;
+        float texCoords[] = {
+            u, v+height,
+            u+width, v,
+            u, v,
+            u+width, v,
+            u, v+height,
+            u+width, v+height
+        };
+        fallback.draw(sprites[i].textureID, transform, unitQuad, texCoords);
+    }
+    fallback.end(program);
+    drawCalls = fallback.drawCalls;
+    instancesDrawn = (int)sprites.size();
+    bytesUploaded = fallback.bytesUploaded;
+}
+
+int InstancedSpriteBatch::spriteCount() const {
+    return (int)sprites.size();
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <tuple>
+#include <string.h>
+#include "ShaderProgram.h"
+
+// A shader program whose uniforms and attributes are part of its type. The locations get looked
+// up once when it's built and kept in a plain array, set<Uniform>() picks the slot at compile time
+// so there's no string lookup per frame, and asking for something the layout doesn't have won't compile.
+//
+//     typedef ShaderLayout<Uniforms<ModelMatrix, ViewMatrix, ProjectionMatrix, Tint>,
+//                          Attributes<Position, TexCoord>> TintedLayout;
+//     TypedShaderProgram<TintedLayout> tinted(RESOURCE_FOLDER"vertex_textured.glsl", RESOURCE_FOLDER"fragment_tinted.glsl");
+//     tinted.set<Tint>(Color(1.0f, 0.5f, 0.5f, 1.0f));
+//     glVertexAttribPointer(tinted.attribute<Position>(), 2, GL_FLOAT, false, 0, vertices);
+
+struct Color {
+    Color() : r(1.0f), g(1.0f), b(1.0f), a(1.0f) {}
+    Color(float r, float g, float b, float a) : r(r), g(g), b(b), a(a) {}
+    float r, g, b, a;
+};
+
+// The uniforms and attributes our shaders use. A new one is just another struct like these,
+// type is what set() takes for it and name is what it's called in the glsl.
+struct ModelMatrix { typedef Matrix type; static const char *name() { return "modelMatrix"; } };
+struct ViewMatrix { typedef Matrix type; static const char *name() { return "viewMatrix"; } };
+struct ProjectionMatrix { typedef Matrix type; static const char *name() { return "projectionMatrix"; } };
+struct Tint { typedef Color type; static const char *name() { return "tint"; } };
+struct Diffuse { typedef GLint type; static const char *name() { return "diffuse"; } };
+
+struct Position { static const char *name() { return "position"; } };
+struct TexCoord { static const char *name() { return "texCoord"; } };
+
+template<class... Names> struct Uniforms {};
+template<class... Names> struct Attributes {};
+template<class UniformList, class AttributeList> struct ShaderLayout;
+
+// Where Name sits in List, it's a compile error if it isn't in there at all
+template<class Name, class... List> struct IndexOf;
+template<class Name, class... Rest> struct IndexOf<Name, Name, Rest...> {
+    static const int value = 0;
+};
+template<class Name, class First, class... Rest> struct IndexOf<Name, First, Rest...> {
+    static const int value = 1 + IndexOf<Name, Rest...>::value;
+};
+
+inline void uploadUniform(GLint location, const Matrix &value) { glUniformMatrix4fv(location, 1, GL_FALSE, value.ml); }
+inline void uploadUniform(GLint location, const Color &value) { glUniform4f(location, value.r, value.g, value.b, value.a); }
+inline void uploadUniform(GLint location, float value) { glUniform1f(location, value); }
+inline void uploadUniform(GLint location, GLint value) { glUniform1i(location, value); }
+
+// What vertex_textured.glsl has, the same set ShaderProgram looks up
+typedef ShaderLayout<Uniforms<ModelMatrix, ViewMatrix, ProjectionMatrix>, Attributes<Position, TexCoord> > TexturedLayout;
+
+template<class Layout> class TypedShaderProgram;
+
+template<class... UniformNames, class... AttributeNames>
+class TypedShaderProgram<ShaderLayout<Uniforms<UniformNames...>, Attributes<AttributeNames...> > > {
+    public:
+        TypedShaderProgram(const char *vertexShaderFile, const char *fragmentShaderFile) {
+            programID = ShaderProgram::buildProgram(vertexShaderFile, fragmentShaderFile, vertexShader, fragmentShader);
+    
+            const char *uniformNames[] = { UniformNames::name()... };
+            for (int i = 0; i < UNIFORM_COUNT; i++) {
+                uniformLocations[i] = glGetUniformLocation(programID, uniformNames[i]);
+                uploaded[i] = false;
+            }
+            const char *attributeNames[] = { AttributeNames::name()... };
+            for (int i = 0; i < ATTRIBUTE_COUNT; i++) {
+                attributeLocations[i] = glGetAttribLocation(programID, attributeNames[i]);
+            }
+        }
+    
+        ~TypedShaderProgram() {
+            ShaderProgram::release(programID, vertexShader, fragmentShader);
+        }
+    
+        void use() {
+            ShaderProgram::bind(programID);
+        }
+    
+        // uploads the uniform unless it already holds this value, or the glsl compiled it out
+        template<class Name> void set(const typename Name::type &value) {
+            const int index = IndexOf<Name, UniformNames...>::value;
+            if (uniformLocations[index] == -1) {
+                return;
+            }
+            typename Name::type &last = std::get<IndexOf<Name, UniformNames...>::value>(values);
+            if (uploaded[index] && memcmp(&last, &value, sizeof(value)) == 0) {
+                ShaderProgram::uniformUploadsElided++;
+                return;
+            }
+            use();
+            uploadUniform(uniformLocations[index], value);
+            last = value;
+            uploaded[index] = true;
+            ShaderProgram::uniformUploadsIssued++;
+        }
+    
+        template<class Name> GLint uniform() const {
+            return uniformLocations[IndexOf<Name, UniformNames...>::value];
+        }
+    
+        template<class Name> GLint attribute() const {
+            return attributeLocations[IndexOf<Name, AttributeNames...>::value];
+        }
+    
+        GLuint programID;
+        GLuint vertexShader;
+        GLuint fragmentShader;
+    
+    private:
+        static const int UNIFORM_COUNT = sizeof...(UniformNames);
+        static const int ATTRIBUTE_COUNT = sizeof...(AttributeNames);
+    
+        TypedShaderProgram(const TypedShaderProgram &);
+        TypedShaderProgram &operator=(const TypedShaderProgram &);
+    
+        GLint uniformLocations[UNIFORM_COUNT];
+        GLint attributeLocations[ATTRIBUTE_COUNT];
+        bool uploaded[UNIFORM_COUNT];
+        std::tuple<typename UniformNames::type...> values;
+};
@@ -6,6 +6,11 @@
 #include <SDL_image.h>
 #include "Matrix.h"
 #include "ShaderProgram.h"
+#include "TextureAtlas.h"
+#include "TextRenderer.h"
+#include "InstancedSpriteBatch.h"
+#include "BroadPhase.h"
+#include "EntityStore.h"
 #include <vector>
 #include <SDL_mixer.h>
 
@@ -24,67 +29,17 @@
 
 SDL_Window* displayWindow;
 
-// Load desired texture into the program
-GLuint LoadTexture(const char *image_path) {
-    SDL_Surface *surface = IMG_Load(image_path);
-    
-    if(surface == NULL){
-        printf("bad image\n");
-        exit(1);
-    }
+// The camera always shows the same slice of the world, so its projection is worked out at compile time
+constexpr Matrix screenProjection = Matrix::orthoProjection(-3.55f, 3.55f, -2.0f, 2.0f, -1.0f, 1.0f);
 
-    GLuint textureID;
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, surface->w, surface->h, 0, GL_BGRA, GL_UNSIGNED_BYTE, surface->pixels);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    SDL_FreeSurface(surface);
-    return textureID;
-}
+// sheet.png and font1.png packed together, so ships, bullets and text all share one texture
+TextureAtlas gameAtlas;
 
-void DrawText(ShaderProgram *program, GLuint &fontTexture, std::string text, float size, float spacing, float xCord, float yCord, Matrix &matrix) {
-    float texture_size = 1.0/16.0f;
-    std::vector<float> vertexData;
-    std::vector<float> texCoordData;
-    for(int i=0; i < text.size(); i++) {
-        float texture_x = (float)(((int)text[i]) % 16) / 16.0f;
-        float texture_y = (float)(((int)text[i]) / 16) / 16.0f;
-        vertexData.insert(vertexData.end(), {
-            ((size+spacing) * i) + (-0.5f * size), 0.5f * size,
-            ((size+spacing) * i) + (-0.5f * size), -0.5f * size,
-            ((size+spacing) * i) + (0.5f * size), 0.5f * size,
-            ((size+spacing) * i) + (0.5f * size), -0.5f * size,
-            ((size+spacing) * i) + (0.5f * size), 0.5f * size,
-            ((size+spacing) * i) + (-0.5f * size), -0.5f * size,
-        });
-        texCoordData.insert(texCoordData.end(), {
-            texture_x, texture_y,
-            texture_x, texture_y + texture_size,
-            texture_x + texture_size, texture_y,
-            texture_x + texture_size, texture_y + texture_size,
-            texture_x + texture_size, texture_y,
-            texture_x, texture_y + texture_size,
-        }); }
-    matrix.identity();
-    matrix.Translate(xCord, yCord, 0.0f);
-    program->setModelMatrix(matrix);
-    
-    
-    glUseProgram(program->programID);
-    glBindTexture(GL_TEXTURE_2D, fontTexture);
-    
-    glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, 0, vertexData.data());
-    glEnableVertexAttribArray(program->positionAttribute);
-    
-    glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, 0, texCoordData.data());
-    glEnableVertexAttribArray(program->texCoordAttribute);
-    
-    glDrawArrays(GL_TRIANGLES, 0, (float)(text.size() * 6));
-    
-    glDisableVertexAttribArray(program->positionAttribute);
-    glDisableVertexAttribArray(program->texCoordAttribute);
-}
+// Every string on screen comes from here, laid out once and drawn together with one call
+TextRenderer textRenderer;
+
+// All the ships and bullets go through here, one instanced draw per texture when the driver can do it
+InstancedSpriteBatch spriteBatch;
 
 // Map the object's vertices to where they belong on the spritesheet and draw the object
 class SpriteSheet
@@ -92,7 +47,12 @@ class SpriteSheet
 public:
     SpriteSheet();
     SpriteSheet(GLuint texID, float uCoord, float vCoord, float wid, float hei, float sze)
-    : textureID(texID), u(uCoord), v(vCoord), width(wid), height(hei), size(sze)
+    : textureID(texID), u(uCoord), v(vCoord), width(wid), height(hei), size(sze), aspect(wid / hei)
+    {}
+    // A sprite out of the atlas, the atlas isn't square so the aspect comes from the pixel size
+    SpriteSheet(GLuint texID, const AtlasRegion &region, float sze)
+    : textureID(texID), u(region.u), v(region.v), width(region.width), height(region.height), size(sze),
+      aspect((float)region.pixelWidth / (float)region.pixelHeight)
     {}
     // left-x: (x position / image width), right-x: (x-position / image width)+(width/image width)
     // top-y: (y position / image height), bottom-y: (y-position / image height)+(height of image / image width)
@@ -102,136 +62,21 @@ public:
     float width;
     float height;
     float size;
+    // The size of the image related to the aspect of the UV map
+    float aspect;
     
-    void draw(ShaderProgram *program)
+    // Hand the sprite to the batch, it gets drawn along with every other sprite on this texture
+    // The quad is size * aspect by size before the entity's own width and height scale it
+    void draw(InstancedSpriteBatch &batch, float x, float y, float scaleX, float scaleY)
     {
-        // Bind the texture to be used
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        
-        // Texture Array
-        GLfloat texCoords[] = {
-            u, v+height,
-            u+width, v,
-            u, v,
-            u+width, v,
-            u, v+height,
-            u+width, v+height
-        };
-        // The size of the image related to the aspect of the UV map
-        float aspect = width / height;
-        // Vertices Array
-        float vertices[] = {
-        -0.5f * size * aspect, -0.5f * size,
-        0.5f * size * aspect, 0.5f * size,
-        -0.5f * size * aspect, 0.5f * size,
-        0.5f * size * aspect, 0.5f * size,
-        -0.5f * size * aspect, -0.5f * size ,
-        0.5f * size * aspect, -0.5f * size
-        };
-        // Map the vertex array to position attribute
-        glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, 0, vertices);
-        glEnableVertexAttribArray(program->positionAttribute);
-        
-        // Map the texture array to the texture coordinate reader
-        glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, 0, texCoords);
-        glEnableVertexAttribArray(program->texCoordAttribute);
-        
-        // Then actually draw it
-        glDrawArrays(GL_TRIANGLES, 0, ( (sizeof(vertices) / sizeof(float)) / 2));
-        
-        glDisableVertexAttribArray(program->positionAttribute);
-        glDisableVertexAttribArray(program->texCoordAttribute);
+        batch.draw(textureID, x, y, size * aspect * scaleX, size * scaleY, 0.0f, u, v, width, height);
     }
 };
 
-// The Entity class, for each object we plan to draw into our program
-class Entity
-{
-public:
-    // Time to create them!
-    Entity(SpriteSheet sprite, Matrix matrix, float x, float y, float width, float height, float rotation, float max_vel, bool affectedByPlayer, bool bullet, int direction, Mix_Chunk *shot)
-    :sprite(sprite), matrix(matrix), x(x), y(y), width(width), height(height), rotation(rotation), max_vel(max_vel), affectedByPlayer(affectedByPlayer), bullet(bullet), direction(direction){
-        alive = true;
-        usable = true;
-        if (affectedByPlayer == true && !bullet){
-            GLuint bullet_texture = LoadTexture(RESOURCE_FOLDER"sheet.png");
-            SpriteSheet bullet_sprite = SpriteSheet(bullet_texture, 809.0f/1024.0f, 437.0f/1024.0f, 19.0f/1024.0f, 30.0f/1024.0f, 0.5f);
-            Matrix new_matrix;
-            for (int i = 0; i < 2; i++){
-                Entity newBullet = Entity(bullet_sprite, new_matrix, -5.0f, -5.0f, 0.1, 0.2, 90.0f, 1.0f, true, true, 1.0, shot);
-                newBullet.shot = shot;
-                bullets.push_back(newBullet);
-            }
-        }
-    }
-    // Let the spritesheet class handle the drawing
-    SpriteSheet sprite;
-    
-    // the matrix to modify the object's position
-    Matrix matrix;
-    float x;
-    float y;
-    // width and height (scalex and scaley)
-    float width;
-    float height;
-    float rotation;
-    
-    // Physics
-    float max_vel;
-    float velocity_x;
-    float velocity_y;
-    
-    float max_accel;
-    float acceleration_x;
-    float acceleration_y;
-    
-    float friction_x;
-    float friction_y;
-    
-    // Tells if object is affected by player input
-    bool affectedByPlayer;
-    bool alive;
-    
-    // Gotta store the bullets somewhere
-    std::vector<Entity> bullets;
-    bool bullet;
-    bool usable;
-    
-    // For shooting the bullet sound
-    Mix_Chunk *shot;
-    
-    // Position the object
-    void position(ShaderProgram *program)
-    {
-        program->setModelMatrix(matrix);
-        matrix.identity();
-        matrix.Translate(x, y, 0);
-        matrix.Scale(width, height, 1.0f);
-    }
-   
-    /*
-        Called when the player makes a command to move the player object
-        store the direction for spaceships
-    */
-    int direction;
-    void move(float timePerFrame)
-    {
-        if (!bullet){
-            velocity_x = max_vel;
-            x+= (float) direction * velocity_x * timePerFrame;
-            y+= velocity_y * timePerFrame;
-            velocity_x = 0;
-            velocity_y = 0;
-        }
-        else{
-            velocity_y = max_vel;
-            y+= (float)direction * velocity_y * timePerFrame;
-            x+= velocity_x *timePerFrame;
-            velocity_x = 0;
-            velocity_y = 0;
-        }
-    }
-};
+#define PLAYER_SPEED 5.0f
+#define INVADER_SPEED 1.0f
+#define BULLET_SPEED 1.0f
+#define BULLET_COUNT 2
 
 /*
     We'll use objects as our game states
@@ -244,12 +89,21 @@ class GameState
 {
 public:
     GameState(int gameState, bool active)
-    :gameState(gameState), active(active)
+    :player(0), firstBullet(0), firstInvader(0), invaderCount(0), gameState(gameState), active(active), invaderGrid(-4.0f, -2.5f, 4.0f, 2.5f, 0.5f), amountOfAliveInvaders(0)
     {}
 
-    std::vector<Entity> stateObjects;
+    // Everything on screen, see EntityStore for how it's laid out
+    EntityStore entities;
+    std::vector<SpriteSheet> sprites;
+    int player;
+    int firstBullet;
+    int firstInvader;
+    int invaderCount;
     int gameState;
     bool active;
+    // Broad phase for bullets and the player against the invaders, rebuilt every update
+    BroadPhase invaderGrid;
+    std::vector<int> collisionHits;
     // What if you win?
     int amountOfAliveInvaders;
     /* 
@@ -260,30 +114,22 @@ public:
     void render(ShaderProgram *program, GLuint &fontTexture)
     {
         glClear(GL_COLOR_BUFFER_BIT);
-        Matrix projectionMatrix;
         Matrix viewMatrix;
-        Matrix modelMatrix;
-        projectionMatrix.setOrthoProjection(-3.55, 3.55, -2.0f, 2.0f, -1.0f, 1.0f);
         
-        glUseProgram(program->programID);
+        program->use();
         program->setViewMatrix(viewMatrix);
-        program->setProjectionMatrix(projectionMatrix);
+        program->setProjectionMatrix(screenProjection);
         
         if (gameState==1 && active){
-            for(int i=0; i< stateObjects.size(); i++)
+            spriteBatch.begin();
+            RenderView view = renderView(entities, 0, entities.size());
+            for(int i=0; i< view.count; i++)
             {
-                if (stateObjects[i].alive){
-                    stateObjects[i].position(program);
-                    stateObjects[i].sprite.draw(program);
-                   
-                    if (stateObjects[i].affectedByPlayer && !stateObjects[i].bullet){
-                        for (int j=0; j<stateObjects[i].bullets.size(); j++) {
-                            stateObjects[i].bullets[j].position(program);
-                            stateObjects[i].bullets[j].sprite.draw(program);
-                        }
-                    }
+                if (view.alive[i]){
+                    sprites[view.sprite[i]].draw(spriteBatch, view.x[i], view.y[i], view.width[i], view.height[i]);
                 }
             }
+            spriteBatch.end(program, viewMatrix, screenProjection);
         }
         
         glEnable(GL_BLEND);
@@ -296,24 +142,25 @@ public:
         /*
             Draw the text: Welcome! then, To get started press p, good luck
         */
-            DrawText(program, fontTexture, "Welcome!", 0.3f, 0.05f, -2.0f, 1.0f, modelMatrix);
-            DrawText(program, fontTexture, "To Get Started", 0.3f, 0.05f, -2.0f, 0.5f, modelMatrix);
-            DrawText(program, fontTexture, "Press P", 0.3f, 0.05f, -2.0f, 0.0f, modelMatrix);
-            DrawText(program, fontTexture, "Good Luck", 0.3f, 0.05f, -2.0f, -0.5f, modelMatrix);
+            textRenderer.draw("Welcome!", 0.3f, 0.05f, -2.0f, 1.0f);
+            textRenderer.draw("To Get Started", 0.3f, 0.05f, -2.0f, 0.5f);
+            textRenderer.draw("Press P", 0.3f, 0.05f, -2.0f, 0.0f);
+            textRenderer.draw("Good Luck", 0.3f, 0.05f, -2.0f, -0.5f);
         }
         if (gameState == 1 && !active){
             // Draw The Phrase "Game over, play again? (press p)
             if (amountOfAliveInvaders > 0){
-                DrawText(program, fontTexture, "Game Over.", 0.3f, 0.05f, -2.0f, 1.0f, modelMatrix);
-                DrawText(program, fontTexture, "Play Again?", 0.3f, 0.05f, -2.0f, 0.5f, modelMatrix);
-                DrawText(program, fontTexture, "(press p)", 0.3f, 0.05f, -2.0f, 0.0f, modelMatrix);
+                textRenderer.draw("Game Over.", 0.3f, 0.05f, -2.0f, 1.0f);
+                textRenderer.draw("Play Again?", 0.3f, 0.05f, -2.0f, 0.5f);
+                textRenderer.draw("(press p)", 0.3f, 0.05f, -2.0f, 0.0f);
             }
             else if (amountOfAliveInvaders <= 0){
-                DrawText(program, fontTexture, "You Won!", 0.3f, 0.05f, -2.0f, 1.0f, modelMatrix);
-                DrawText(program, fontTexture, "Play Again?", 0.3f, 0.05f, -2.0f, 0.5f, modelMatrix);
-                DrawText(program, fontTexture, "(press p)", 0.3f, 0.05f, -2.0f, 0.0f, modelMatrix);
+                textRenderer.draw("You Won!", 0.3f, 0.05f, -2.0f, 1.0f);
+                textRenderer.draw("Play Again?", 0.3f, 0.05f, -2.0f, 0.5f);
+                textRenderer.draw("(press p)", 0.3f, 0.05f, -2.0f, 0.0f);
             }
         }
+        textRenderer.flush(program, fontTexture);
         
     
         SDL_GL_SwapWindow(displayWindow);
@@ -348,24 +195,28 @@ void setup()
 /*
     Recreate the objects arrays
 */
-void reset(GameState &state, GLuint &gameTexture, Mix_Chunk *shot){
+void reset(GameState &state, GLuint &gameTexture){
     if (state.gameState == 1){
-        state.stateObjects.clear();
-        // Create the player and his bullets
-        SpriteSheet playerSprite = SpriteSheet(gameTexture, 211.0f/1024.0f, 941.0f/1024.0f, 99.0f/1024.0f, 75.0f/1024.0f, 0.3f);
-        Matrix matrix;
-        Entity player = Entity(playerSprite, matrix, 0.0f, -1.5f, 0.5f, 0.5f, 90.0f, 5.0f, true, false, 1, shot);
-        state.stateObjects.push_back(player);
+        state.entities.clear();
+        state.sprites.clear();
+        state.sprites.push_back(SpriteSheet(gameTexture, gameAtlas.region("player"), 0.3f));
+        state.sprites.push_back(SpriteSheet(gameTexture, gameAtlas.region("laser"), 0.5f));
+        state.sprites.push_back(SpriteSheet(gameTexture, gameAtlas.region("invader"), 0.2f));
+        
+        // Create the player and his bullets, the bullets wait off screen until they're shot
+        state.player = state.entities.add(0, 0.0f, -1.5f, 0.5f, 0.5f, 0.0f, 0.0f, true);
+        state.firstBullet = state.entities.size();
+        for (int i = 0; i < BULLET_COUNT; i++){
+            state.entities.add(1, -5.0f, -5.0f, 0.1f, 0.2f, 0.0f, BULLET_SPEED, false);
+        }
         
         // Create the 30 invaders
-        SpriteSheet invader = SpriteSheet(gameTexture, 423.0f/1024.0f, 728.0f/1024.0f, 93.0f/1024.0f, 84.0f/1024.0f, 0.2f);
+        state.firstInvader = state.entities.size();
         float x_pos = -3.3f;
         float y_pos = 1.8f;
         float current_dir = 1;
         for (int i = 0; i < 30; i++){
-            Matrix new_matrix;
-            Entity new_invader = Entity(invader, new_matrix, x_pos, y_pos, 0.5f, 0.5f, -90.0f, 1.0f, false, false, current_dir, shot);
-            state.stateObjects.push_back(new_invader);
+            state.entities.add(2, x_pos, y_pos, 0.5f, 0.5f, current_dir * INVADER_SPEED, 0.0f, true);
             x_pos+=0.5;
             if (i % 10 == 0){
                 x_pos = -3.3;
@@ -374,7 +225,8 @@ void reset(GameState &state, GLuint &gameTexture, Mix_Chunk *shot){
             }
             
         }
-        state.amountOfAliveInvaders = (int)state.stateObjects.size() - 1;
+        state.invaderCount = state.entities.size() - state.firstInvader;
+        state.amountOfAliveInvaders = state.invaderCount;
     }
 }
 
@@ -388,19 +240,13 @@ void processEvents(SDL_Event &event, bool &done, float &timePerFrame, GameState&
         }
         // Shoot the bullets. Was happening to fast, so needed to "poll" it down
         if (event.type == SDL_KEYDOWN && state.gameState == 1 && state.active && keys[SDL_SCANCODE_SPACE]){
-            for (int i = 0; i<state.stateObjects.size(); i++){
-                if (state.stateObjects[i].affectedByPlayer && !state.stateObjects[i].bullet){
-                    bool foundEmptyBullet =false;
-                    for (int j=0;j<state.stateObjects[i].bullets.size();j++){
-                        if (state.stateObjects[i].bullets[j].usable && !foundEmptyBullet){
-                            state.stateObjects[i].bullets[j].usable = false;
-                            state.stateObjects[i].bullets[j].x = state.stateObjects[i].x;
-                            state.stateObjects[i].bullets[j].y = state.stateObjects[i].y+0.5;
-                            Mix_PlayChannel(-1, state.stateObjects[i].bullets[j].shot, 0);
-                            foundEmptyBullet = true;
-                            break;
-                        }
-                    }
+            EntityStore &entities = state.entities;
+            for (int j = state.firstBullet; j < state.firstBullet + BULLET_COUNT; j++){
+                if (!entities.alive[j]){
+                    entities.alive[j] = 1;
+                    entities.x[j] = entities.x[state.player];
+                    entities.y[j] = entities.y[state.player]+0.5;
+                    Mix_PlayChannel(-1, shot, 0);
                     break;
                 }
             }
@@ -408,26 +254,17 @@ void processEvents(SDL_Event &event, bool &done, float &timePerFrame, GameState&
     }
     // Handle player interaction with the game
     if (state.gameState == 1 && state.active){
+        float &playerX = state.entities.x[state.player];
         if (keys[SDL_SCANCODE_RIGHT] || keys[SDL_SCANCODE_D]){
-            for (int i = 0; i<state.stateObjects.size(); i++) {
-                if (state.stateObjects[i].affectedByPlayer && !state.stateObjects[i].bullet) {
-                    state.stateObjects[i].direction = 1;
-                    state.stateObjects[i].move(timePerFrame);
-                    if(state.stateObjects[i].x >= 3.4){
-                        state.stateObjects[i].x = 3.4;
-                    }
-                }
+            playerX += PLAYER_SPEED * timePerFrame;
+            if(playerX >= 3.4){
+                playerX = 3.4;
             }
         }
         if (keys[SDL_SCANCODE_LEFT] || keys[SDL_SCANCODE_A]) {
-            for (int i = 0; i<state.stateObjects.size(); i++) {
-                if (state.stateObjects[i].affectedByPlayer && !state.stateObjects[i].bullet) {
-                    state.stateObjects[i].direction = -1;
-                    state.stateObjects[i].move(timePerFrame);
-                    if(state.stateObjects[i].x <= -3.4){
-                        state.stateObjects[i].x = -3.4;
-                    }
-                }
+            playerX -= PLAYER_SPEED * timePerFrame;
+            if(playerX <= -3.4){
+                playerX = -3.4;
             }
         }
     }
@@ -437,7 +274,7 @@ void processEvents(SDL_Event &event, bool &done, float &timePerFrame, GameState&
             state.active = true;
             currentState = state.gameState;
             // Need to reset the game state
-            reset(state, game_texture, shot);
+            reset(state, game_texture);
          }
     }
     // Handle player interaction with menu
@@ -453,93 +290,85 @@ void processEvents(SDL_Event &event, bool &done, float &timePerFrame, GameState&
 inline void GameState::update(ShaderProgram *program, GLuint &fontTexture, SDL_Event &event, bool &done, float fixedElapsed, GameState &innactiveState, GLuint &game_texture, int &currentState, Mix_Chunk *shot){
     processEvents(event, done, fixedElapsed, *this, innactiveState, currentState, game_texture, shot);
     if (gameState == 1 && active){
-        for (int i = 0; i < stateObjects.size(); i++) {
-            if (!stateObjects[i].affectedByPlayer){
-                // Handle movement of space ships
-                if (!stateObjects[i].bullet && stateObjects[i].alive){
-                    stateObjects[i].move(fixedElapsed);
-                    if (stateObjects[i].x >= 3.50 || stateObjects[i].x < -3.50){
-                        stateObjects[i].direction *= -1;
-                        stateObjects[i].move(fixedElapsed);
-                        stateObjects[i].y -=0.3f;
-                    }
-                }
-                else if (!stateObjects[i].bullet && !stateObjects[i].alive){
-                    stateObjects[i].x = -10.0f;
-                    stateObjects[i].y=-10.0f;
-                }
+        CollisionView invaders = collisionView(entities, firstInvader, invaderCount);
+        CollisionView bullets = collisionView(entities, firstBullet, BULLET_COUNT);
+        
+        /*
+            Every live invader goes into the grid once, then bullets and the player only look at nearby cells
+            Collisions use where the invaders were before they move this step
+        */
+        invaderGrid.clear();
+        for (int i = 0; i < invaders.count; i++) {
+            if (invaders.alive[i]){
+                invaderGrid.insert(i, invaders.x[i] - invaders.width[i] / 2.0f, invaders.y[i] - invaders.height[i] / 2.0f,
+                                   invaders.x[i] + invaders.width[i] / 2.0f, invaders.y[i] + invaders.height[i] / 2.0f);
             }
-            // Handle bullet colliding with space invader when bullet is shot
-            if (stateObjects[i].affectedByPlayer && !stateObjects[i].bullet){
-                for (int bulletIdx = 0; bulletIdx < stateObjects[i].bullets.size(); bulletIdx++){
-                    if (!stateObjects[i].bullets[bulletIdx].usable){
-                        float bulletTop, bulletBot, bulletLeft, bulletRight;
-                        float invaderTop, invaderBot, invaderLeft, invaderRight;
-                    
-                        bulletTop = stateObjects[i].bullets[bulletIdx].y + stateObjects[i].bullets[bulletIdx].height / 2.0f;
-                        bulletBot = stateObjects[i].bullets[bulletIdx].y - stateObjects[i].bullets[bulletIdx].height / 2.0f;
-                        bulletLeft = stateObjects[i].bullets[bulletIdx].x - stateObjects[i].bullets[bulletIdx].width / 2.0f;
-                        bulletRight = stateObjects[i].bullets[bulletIdx].x + stateObjects[i].bullets[bulletIdx].width / 2.0f;
-                    
-                        for (int invaderIdx = 0; invaderIdx < stateObjects.size(); invaderIdx++){
-                           if (!stateObjects[invaderIdx].affectedByPlayer && !stateObjects[invaderIdx].bullet){
-                                invaderTop = stateObjects[invaderIdx].y + stateObjects[invaderIdx].height / 2.0f;
-                                invaderBot = stateObjects[invaderIdx].y - stateObjects[invaderIdx].height / 2.0f;
-                                invaderLeft = stateObjects[invaderIdx].x - stateObjects[invaderIdx].width / 2.0f;
-                                invaderRight = stateObjects[invaderIdx].x + stateObjects[invaderIdx].width / 2.0f;
-                               
-                                // Now finally check collision
-                                if (!(bulletBot > invaderTop) && !(bulletTop < invaderBot) && !(bulletLeft > invaderRight) && !(bulletRight < invaderLeft)){
-                                    amountOfAliveInvaders--;
-                                    stateObjects[i].bullets[bulletIdx].usable = true;
-                                    stateObjects[i].bullets[bulletIdx].x = -5;
-                                    stateObjects[i].bullets[bulletIdx].y = -5;
-                                    stateObjects[invaderIdx].alive = false;
-                                }
-                            }
-                        }
-                        // Move the bullet after checking if where it is was colliding
-                        if (!stateObjects[i].bullets[bulletIdx].usable){
-                            stateObjects[i].bullets[bulletIdx].move(fixedElapsed);
-                            if (stateObjects[i].bullets[bulletIdx].y > 2.0){
-                                stateObjects[i].bullets[bulletIdx].y = -5;
-                                stateObjects[i].bullets[bulletIdx].x = -5;
-                                stateObjects[i].bullets[bulletIdx].usable = true;
-                            }
-                        }
+        }
+        invaderGrid.build();
+        
+        // Handle bullet colliding with space invader when bullet is shot
+        for (int bulletIdx = 0; bulletIdx < bullets.count; bulletIdx++){
+            if (bullets.alive[bulletIdx]){
+                float bulletTop, bulletBot, bulletLeft, bulletRight;
+                
+                bulletTop = bullets.y[bulletIdx] + bullets.height[bulletIdx] / 2.0f;
+                bulletBot = bullets.y[bulletIdx] - bullets.height[bulletIdx] / 2.0f;
+                bulletLeft = bullets.x[bulletIdx] - bullets.width[bulletIdx] / 2.0f;
+                bulletRight = bullets.x[bulletIdx] + bullets.width[bulletIdx] / 2.0f;
+                
+                // Only the invaders in the cells around the bullet come back, and they already overlap it
+                invaderGrid.query(bulletLeft, bulletBot, bulletRight, bulletTop, collisionHits);
+                for (int hitIdx = 0; hitIdx < collisionHits.size(); hitIdx++){
+                    int invaderIdx = collisionHits[hitIdx];
+                    // another bullet might have got it earlier this step
+                    if (invaders.alive[invaderIdx]){
+                        amountOfAliveInvaders--;
+                        bullets.alive[bulletIdx] = 0;
+                        invaders.alive[invaderIdx] = 0;
                     }
                 }
             }
-            /*
-                Handle game over state (player collision with space ship)
-                First, Check if the player is colliding with any of the alive invaders
-                Then, render the game over screen
-            */
-            if (stateObjects[i].affectedByPlayer && !stateObjects[i].bullet){
-                Entity player = stateObjects[i];
-                float playerTop, playerBot, playerLeft, playerRight;
-                float invaderTop, invaderBot, invaderLeft, invaderRight;
-                
-                playerTop = player.y + player.height / 2.0f;
-                playerBot = player.y - player.height / 2.0f;
-                playerLeft = player.x - player.width / 2.0f;
-                playerRight = player.x + player.width / 2.0f;
-                 for (int invaderIdx = 0; invaderIdx < stateObjects.size(); invaderIdx++){
-                    if (!stateObjects[invaderIdx].affectedByPlayer && !stateObjects[invaderIdx].bullet && stateObjects[invaderIdx].alive){
-                        invaderTop = stateObjects[invaderIdx].y + stateObjects[invaderIdx].height / 2.0f;
-                        invaderBot = stateObjects[invaderIdx].y - stateObjects[invaderIdx].height / 2.0f;
-                        invaderLeft = stateObjects[invaderIdx].x - stateObjects[invaderIdx].width / 2.0f;
-                        invaderRight = stateObjects[invaderIdx].x + stateObjects[invaderIdx].width / 2.0f;
-                        
-                         if (!(playerBot > invaderTop) && !(playerTop < invaderBot) && !(playerLeft > invaderRight) && !(playerRight < invaderLeft)){
-                                    active = false;
-                                    player.alive = false;
-                                }
-                    }
-                    if (amountOfAliveInvaders <=0){
-                        active = false;
-                    }
-                 }
+        }
+        
+        // Move the bullets after checking if where they are was colliding
+        integrate(movementView(entities, firstBullet, BULLET_COUNT), fixedElapsed);
+        for (int bulletIdx = 0; bulletIdx < bullets.count; bulletIdx++){
+            if (!bullets.alive[bulletIdx] || bullets.y[bulletIdx] > 2.0){
+                entities.alive[firstBullet + bulletIdx] = 0;
+                entities.x[firstBullet + bulletIdx] = -5;
+                entities.y[firstBullet + bulletIdx] = -5;
+            }
+        }
+        
+        /*
+            Handle game over state (player collision with space ship)
+            First, Check if the player is colliding with any of the alive invaders
+            Then, render the game over screen
+        */
+        float playerTop, playerBot, playerLeft, playerRight;
+        playerTop = entities.y[player] + entities.height[player] / 2.0f;
+        playerBot = entities.y[player] - entities.height[player] / 2.0f;
+        playerLeft = entities.x[player] - entities.width[player] / 2.0f;
+        playerRight = entities.x[player] + entities.width[player] / 2.0f;
+        invaderGrid.query(playerLeft, playerBot, playerRight, playerTop, collisionHits);
+        for (int hitIdx = 0; hitIdx < collisionHits.size(); hitIdx++){
+            if (invaders.alive[collisionHits[hitIdx]]){
+                active = false;
+                entities.alive[player] = 0;
+            }
+        }
+        if (amountOfAliveInvaders <=0){
+            active = false;
+        }
+        
+        // Handle movement of space ships, they turn around and drop down when they hit the side
+        MovementView invaderMovement = movementView(entities, firstInvader, invaderCount);
+        integrate(invaderMovement, fixedElapsed);
+        for (int i = 0; i < invaderMovement.count; i++) {
+            if (invaderMovement.alive[i] && (invaderMovement.x[i] >= 3.50 || invaderMovement.x[i] < -3.50)){
+                invaderMovement.velocity_x[i] *= -1;
+                invaderMovement.x[i] += invaderMovement.velocity_x[i] * fixedElapsed;
+                invaderMovement.y[i] -= 0.3f;
             }
         }
     }
@@ -550,16 +379,10 @@ inline void GameState::update(ShaderProgram *program, GLuint &fontTexture, SDL_E
             Ask the player if they want to play again, and if so tell them to press p
             Once they play again, set everyone to be alive again and to their original positions
         */
-        for (int playerIdx = 0; playerIdx < stateObjects.size(); playerIdx++){
-            if (stateObjects[playerIdx].affectedByPlayer && !stateObjects[playerIdx].bullet){
-                Entity player = stateObjects[playerIdx];
-                for (int playerBulletsIdx = 0; playerBulletsIdx<player.bullets.size(); playerBulletsIdx++){
-                    player.bullets[playerBulletsIdx].usable = true;
-                    player.bullets[playerBulletsIdx].x = -5;
-                    player.bullets[playerBulletsIdx].y = -5;
-                }
-                break;
-            }
+        for (int bulletIdx = firstBullet; bulletIdx < firstBullet + BULLET_COUNT; bulletIdx++){
+            entities.alive[bulletIdx] = 0;
+            entities.x[bulletIdx] = -5;
+            entities.y[bulletIdx] = -5;
         }
     }
 }
@@ -567,6 +390,7 @@ inline void GameState::update(ShaderProgram *program, GLuint &fontTexture, SDL_E
 // cleans up anything the program was using
 void cleanUp(ShaderProgram *program)
 {
+    spriteBatch.clear();
     SDL_Quit();
 }
 
@@ -574,6 +398,7 @@ int main(int argc, char *argv[])
 {
     setup();
     ShaderProgram program(RESOURCE_FOLDER"vertex_textured.glsl", RESOURCE_FOLDER"fragment_textured.glsl");
+    spriteBatch.init(RESOURCE_FOLDER"vertex_instanced.glsl", RESOURCE_FOLDER"fragment_textured.glsl");
     
     #define FIXED_TIMESTEP 0.0166666f
     #define MAX_TIMESTEPS 6
@@ -584,8 +409,16 @@ int main(int argc, char *argv[])
     float fixedElapsed = 0.0f;
     float ticks;
     float elapsed = 0.0f;
-    GLuint font_texture = LoadTexture(RESOURCE_FOLDER"font1.png");
-    GLuint game_texture = LoadTexture(RESOURCE_FOLDER"sheet.png");
+    // Pack the sprite sheet and the font into one texture, sprites are looked up by name from here on
+    gameAtlas.addImage("sheet", RESOURCE_FOLDER"sheet.png");
+    gameAtlas.addImage("font", RESOURCE_FOLDER"font1.png");
+    gameAtlas.addSprite("player", "sheet", 211, 941, 99, 75);
+    gameAtlas.addSprite("invader", "sheet", 423, 728, 93, 84);
+    gameAtlas.addSprite("laser", "sheet", 809, 437, 19, 30);
+    GLuint game_texture = gameAtlas.build(2048);
+    GLuint font_texture = game_texture;
+    const AtlasRegion &font = gameAtlas.region("font");
+    textRenderer.setFontRegion(font.u, font.v, font.width, font.height);
     GameState mainMenu = GameState(0, true);
     GameState gameItself = GameState(1, false);
     // Testing Music
@@ -596,7 +429,7 @@ int main(int argc, char *argv[])
     bullet = Mix_LoadWAV("laser_shot.wav");
     
     
-    reset(gameItself, game_texture, bullet);
+    reset(gameItself, game_texture);
     
     // Grand Finale!
     while (!done){
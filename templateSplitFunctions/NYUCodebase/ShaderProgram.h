@@ -15,12 +15,45 @@ class ShaderProgram {
         ShaderProgram(const char *vertexShaderFile, const char *fragmentShaderFile);
         ~ShaderProgram();
     
+        // binds the program, skipped if it's already the bound one
+        void use();
+    
         void setModelMatrix(const Matrix &matrix);
         void setProjectionMatrix(const Matrix &matrix);
         void setViewMatrix(const Matrix &matrix);
     
-        GLuint loadShaderFromString(const std::string &shaderContents, GLenum type);
-        GLuint loadShaderFromFile(const std::string &shaderFile, GLenum type);
+        // forget which program is bound, for when something else calls glUseProgram
+        static void invalidateState();
+        static void resetCounters();
+    
+        // GL calls made vs skipped because nothing changed, read these from a profiler
+        static int useProgramIssued;
+        static int useProgramElided;
+        static int uniformUploadsIssued;
+        static int uniformUploadsElided;
+    
+        // Linked programs get saved to binaryCacheFolder when the driver can hand them back (glGetProgramBinary),
+        // keyed on the shader sources and the driver strings. Next launch loads that instead of compiling, and
+        // anything that doesn't match or won't load just compiles from source like before. Left empty it
+        // becomes SDL_GetPrefPath's folder when the first shader is built.
+        static std::string binaryCacheFolder;
+        static int binaryCacheHits;
+        static int binaryCacheMisses;
+    
+        // reads both files and builds the program, from the binary cache if it can. vertexShader and
+        // fragmentShader come back 0 when it was loaded from the cache
+        static GLuint buildProgram(const char *vertexShaderFile, const char *fragmentShaderFile, GLuint &vertexShader, GLuint &fragmentShader);
+    
+        static std::string readShaderFile(const std::string &shaderFile);
+        static GLuint loadShaderFromString(const std::string &shaderContents, GLenum type);
+        static GLuint loadShaderFromFile(const std::string &shaderFile, GLenum type);
+        // links the two shaders into a program, shared with TypedShaderProgram
+        static GLuint linkProgram(GLuint vertexShader, GLuint fragmentShader);
+    
+        // glUseProgram unless it's already bound, every program type goes through here so the skip stays right
+        static void bind(GLuint programID);
+        // deletes the program and its shaders and forgets it if it was bound
+        static void release(GLuint programID, GLuint vertexShader, GLuint fragmentShader);
     
         GLuint programID;
     
@@ -33,4 +66,25 @@ class ShaderProgram {
     
         GLuint vertexShader;
         GLuint fragmentShader;
+    
+    private:
+        // last value sent to one of the matrix uniforms
+        struct UniformCache {
+            UniformCache() : valid(false) {}
+            bool valid;
+            float value[16];
+        };
+    
+        void setMatrixUniform(GLuint uniform, UniformCache &cache, const Matrix &matrix);
+    
+        UniformCache modelMatrixCache;
+        UniformCache projectionMatrixCache;
+        UniformCache viewMatrixCache;
+    
+        static GLuint boundProgram;
+    
+        static bool binaryCacheSupported();
+        static std::string binaryCachePath(unsigned long long key);
+        static GLuint loadProgramBinary(const std::string &path, unsigned long long key);
+        static void saveProgramBinary(GLuint programID, const std::string &path, unsigned long long key);
 };
\ No newline at end of file
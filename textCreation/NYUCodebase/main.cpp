@@ -109,7 +109,7 @@ void render(ShaderProgram *program, std::vector<float> &vertexData, std::vector<
     
     drawText(vertexData, textureCoordData, text, 0.5f, 0.1f);
     
-    glUseProgram(program->programID);
+    program->use();
     
     program->setModelMatrix(modelMatrix);
     program->setProjectionMatrix(projectionMatrix);